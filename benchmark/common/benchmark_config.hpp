@@ -14,7 +14,8 @@
 #include "cereal/archives/extendable_binary.hpp"
 
 #if THREADED_BENCHMARK
-#define THREADED_GBENCHMARK ->Threads(6)
+// thread range shows scaling of saving and loading across cores
+#define THREADED_GBENCHMARK ->ThreadRange(1, 8)
 #else
 #define THREADED_GBENCHMARK
 #endif
@@ -0,0 +1,142 @@
+//
+// Loading archives saved by newer version of application with older reader.
+// Reports how fast unknown data is skipped and how much of it is kept for skipped shared pointers.
+//
+
+#include <benchmark/benchmark.h>
+
+#include "benchmark_config.hpp"
+#include "benchmark_forward_compat.hpp"
+#include "utils.hpp"
+
+#include "cereal/types/polymorphic.hpp"
+
+CEREAL_REGISTER_TYPE(Circle)
+CEREAL_REGISTER_TYPE_WITH_NAME(Spline, "forward_compat.Spline")
+
+static void ElementsArguments(benchmark::internal::Benchmark *b)
+{
+  for (int elements = 8; elements <= (8 << 10); elements *= 8) {
+    b->Args({elements, 64});
+    b->Args({elements, 4096});
+  }
+}
+
+static void WindowArguments(benchmark::internal::Benchmark *b)
+{
+  for (int window = 1; window <= 256; window *= 4) {
+    b->Args({1024, window});
+  }
+}
+
+#define PARAMS_BENCH_FORWARD GBENCHMARK_ITERATIONS->Repetitions(10)->ReportAggregatesOnly(true)THREADED_GBENCHMARK
+
+//! Saves data with ExtendableBinary archive, objects are optionally length prefixed
+template<class T>
+std::string SaveForwardCompat(T const & t, bool lengthPrefixed)
+{
+  std::ostringstream os(std::ios::binary);
+  {
+    c::ExtendableBinaryOutputArchive ar(os, c::ExtendableBinaryOutputArchive::Options().lengthPrefixedObjects(lengthPrefixed));
+    ar << t;
+  }
+  return os.str();
+}
+
+//! Statistics of loading reported by archive
+struct LoadStats
+{
+  std::size_t peakShared; //!< peak size of data kept for skipped shared pointers
+  std::size_t skipped; //!< bytes of unknown data skipped or copied for skipped shared pointers
+};
+
+//! Loads data from memory buffer or stream, objects of unknown polymorphic types are skipped
+template<class T>
+LoadStats LoadForwardCompat(std::string const & data, std::istringstream & is, bool memoryInput, T & t)
+{
+  auto const options = c::ExtendableBinaryInputArchive::Options().ignoreUnknownPolymorphicTypes(true);
+  if (memoryInput) {
+    c::ExtendableBinaryInputArchive ar(data.data(), data.size(), options);
+    ar >> t;
+    return {ar.peakSharedBufferSize(), ar.skippedDataSize()};
+  }
+  is.clear();
+  is.seekg(0, is.beg);
+  c::ExtendableBinaryInputArchive ar(is, options);
+  ar >> t;
+  return {ar.peakSharedBufferSize(), ar.skippedDataSize()};
+}
+
+////////////////
+// benchmark
+////////////////
+
+/* Data is saved by v2 and loaded by v1 reader.
+ * Skipped bytes are counted by archive: data of unknown fields and objects, including
+ * data copied for skipped shared pointers, without type tags. */
+template<class Case, bool lengthPrefixed, bool memoryInput>
+void LoadNewerVersion(benchmark::State & st)
+{
+  std::string data;
+  {
+    typename Case::Writer written;
+    Case::init(static_cast<std::size_t>(st.range(0)), st.range(1), written);
+    data = SaveForwardCompat(written, lengthPrefixed);
+    Case::hide(data);
+  }
+  std::istringstream is(data, std::ios::binary);
+
+  LoadStats stats{0, 0};
+  while (st.KeepRunning()) {
+    typename Case::Reader loaded;
+    stats = LoadForwardCompat(data, is, memoryInput, loaded);
+    benchmark::DoNotOptimize(loaded);
+  }
+
+  st.counters["bytesLoaded"] = benchmark::Counter(static_cast<double>(data.size()) * st.iterations(),
+                                                  benchmark::Counter::kIsRate);
+  st.counters["bytesSkipped"] = benchmark::Counter(static_cast<double>(stats.skipped) * st.iterations(),
+                                                   benchmark::Counter::kIsRate);
+  st.counters["peakSharedBuffer"] = benchmark::Counter(stats.peakShared, benchmark::Counter::kAvgThreads);
+}
+
+/* Reference for LoadNewerVersion - data saved and loaded by v1 */
+template<class Case, bool lengthPrefixed, bool memoryInput>
+void LoadSameVersion(benchmark::State & st)
+{
+  std::string data;
+  {
+    typename Case::Writer written;
+    Case::init(static_cast<std::size_t>(st.range(0)), st.range(1), written);
+    std::string newer = SaveForwardCompat(written, lengthPrefixed);
+    Case::hide(newer);
+    std::istringstream is(newer, std::ios::binary);
+    typename Case::Reader loaded;
+    LoadForwardCompat(newer, is, true, loaded);
+    data = SaveForwardCompat(loaded, lengthPrefixed);
+  }
+  std::istringstream is(data, std::ios::binary);
+
+  while (st.KeepRunning()) {
+    typename Case::Reader loaded;
+    LoadForwardCompat(data, is, memoryInput, loaded);
+    benchmark::DoNotOptimize(loaded);
+  }
+  st.counters["bytesLoaded"] = benchmark::Counter(static_cast<double>(data.size()) * st.iterations(),
+                                                  benchmark::Counter::kIsRate);
+}
+
+#define BENCHMARK_FORWARD_COMPAT(Case, Arguments) \
+  BENCHMARK_TEMPLATE(LoadNewerVersion, Case, false, false)PARAMS_BENCH_FORWARD->Apply(Arguments); \
+  BENCHMARK_TEMPLATE(LoadNewerVersion, Case, false, true)PARAMS_BENCH_FORWARD->Apply(Arguments); \
+  BENCHMARK_TEMPLATE(LoadNewerVersion, Case, true, false)PARAMS_BENCH_FORWARD->Apply(Arguments); \
+  BENCHMARK_TEMPLATE(LoadNewerVersion, Case, true, true)PARAMS_BENCH_FORWARD->Apply(Arguments); \
+  BENCHMARK_TEMPLATE(LoadSameVersion, Case, false, true)PARAMS_BENCH_FORWARD->Apply(Arguments); \
+  BENCHMARK_TEMPLATE(LoadSameVersion, Case, true, true)PARAMS_BENCH_FORWARD->Apply(Arguments)
+
+BENCHMARK_FORWARD_COMPAT(TrailingFields, ElementsArguments);
+BENCHMARK_FORWARD_COMPAT(OmittedSubobject, ElementsArguments);
+BENCHMARK_FORWARD_COMPAT(SkippedShared, WindowArguments);
+BENCHMARK_FORWARD_COMPAT(UnknownPolymorphic, ElementsArguments);
+
+BENCHMARK_MAIN()
@@ -0,0 +1,300 @@
+//
+// Schemas for loading archives saved by newer version of application (v2)
+// with reader of older version (v1).
+//
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "cereal/cereal.hpp"
+#include "cereal/types/base_class.hpp"
+#include "cereal/types/memory.hpp"
+#include "cereal/types/string.hpp"
+#include "cereal/types/vector.hpp"
+
+////////////////
+// trailing unknown fields
+////////////////
+
+struct RecordV1
+{
+  std::int32_t id = 0;
+  float value = 0;
+
+  template<class Archive>
+  void serialize(Archive & ar, std::uint32_t /*version*/)
+  {
+    ar(id, value);
+  }
+};
+
+//! v2 appended fields which v1 skips at the end of each record
+struct RecordV2
+{
+  std::int32_t id = 0;
+  float value = 0;
+  std::string comment;
+  std::vector<std::int32_t> history;
+  double score = 0;
+
+  template<class Archive>
+  void serialize(Archive & ar, std::uint32_t /*version*/)
+  {
+    ar(id, value, comment, history, score);
+  }
+};
+
+////////////////
+// large subobject omitted by reader
+////////////////
+
+struct Attachment
+{
+  std::string name;
+  std::vector<std::int32_t> samples;
+
+  template<class Archive>
+  void serialize(Archive & ar, std::uint32_t /*version*/)
+  {
+    ar(name, samples);
+  }
+};
+
+struct DocumentV2
+{
+  std::int32_t id = 0;
+  Attachment attachment;
+  std::int32_t checksum = 0;
+
+  template<class Archive>
+  void serialize(Archive & ar, std::uint32_t /*version*/)
+  {
+    ar(id, attachment, checksum);
+  }
+};
+
+//! v1 reserved place for attachment but never loads it
+struct DocumentV1
+{
+  std::int32_t id = 0;
+  std::int32_t checksum = 0;
+
+  template<class Archive>
+  void serialize(Archive & ar, std::uint32_t /*version*/)
+  {
+    ar(id, cereal::OmittedFieldTag(), checksum);
+  }
+};
+
+////////////////
+// skipped shared pointers replayed later
+////////////////
+
+struct Blob
+{
+  std::vector<std::uint8_t> data;
+
+  template<class Archive>
+  void serialize(Archive & ar, std::uint32_t /*version*/)
+  {
+    ar(data);
+  }
+};
+
+//! Thumbnail points to image of later frame, so it's saved in full where v1 skips it
+struct FrameV2
+{
+  std::shared_ptr<Blob> thumbnail;
+  std::shared_ptr<Blob> image;
+
+  template<class Archive>
+  void serialize(Archive & ar, std::uint32_t /*version*/)
+  {
+    ar(thumbnail, image);
+  }
+};
+
+//! Skipped thumbnail is kept in shared buffer until image of later frame is loaded
+struct FrameV1
+{
+  std::shared_ptr<Blob> image;
+
+  template<class Archive>
+  void serialize(Archive & ar, std::uint32_t /*version*/)
+  {
+    ar(cereal::OmittedFieldTag(), image);
+  }
+};
+
+////////////////
+// unknown polymorphic types
+////////////////
+
+struct Shape
+{
+  virtual ~Shape() = default;
+
+  std::int32_t id = 0;
+
+  template<class Archive>
+  void serialize(Archive & ar, std::uint32_t /*version*/)
+  {
+    ar(id);
+  }
+};
+
+struct Circle : Shape
+{
+  float radius = 0;
+
+  template<class Archive>
+  void serialize(Archive & ar, std::uint32_t /*version*/)
+  {
+    ar(cereal::base_class<Shape>(this), radius);
+  }
+};
+
+//! Type added in v2, its name is hidden in saved data so reader doesn't know it
+struct Spline : Shape
+{
+  std::vector<float> points;
+
+  template<class Archive>
+  void serialize(Archive & ar, std::uint32_t /*version*/)
+  {
+    ar(cereal::base_class<Shape>(this), points);
+  }
+};
+
+////////////////
+// benchmark cases
+////////////////
+
+/* Every case defines:
+ * - Writer - data saved by v2
+ * - Reader - data loaded by v1
+ * - init() - fills Writer with n elements, extra is second benchmark argument
+ * - hide() - changes saved data so it looks like saved by application which v1 doesn't know */
+
+struct TrailingFields
+{
+  using Writer = std::vector<RecordV2>;
+  using Reader = std::vector<RecordV1>;
+
+  //! @param history number of integers in history of each record
+  static void init(std::size_t n, std::int64_t history, Writer & w)
+  {
+    std::mt19937 gen(n);
+    w.resize(n);
+    for (auto & r : w) {
+      r.id = static_cast<std::int32_t>(gen());
+      r.value = static_cast<float>(gen());
+      r.comment.assign(16 + gen() % 48, 'c');
+      r.history.resize(static_cast<std::size_t>(history));
+      for (auto & h : r.history)
+        h = static_cast<std::int32_t>(gen());
+      r.score = static_cast<double>(gen());
+    }
+  }
+
+  static void hide(std::string & /*data*/)
+  {}
+};
+
+struct OmittedSubobject
+{
+  using Writer = std::vector<DocumentV2>;
+  using Reader = std::vector<DocumentV1>;
+
+  //! @param samples number of integers in each attachment
+  static void init(std::size_t n, std::int64_t samples, Writer & w)
+  {
+    std::mt19937 gen(n);
+    w.resize(n);
+    for (auto & d : w) {
+      d.id = static_cast<std::int32_t>(gen());
+      d.attachment.name = "attachment";
+      d.attachment.samples.resize(static_cast<std::size_t>(samples));
+      for (auto & s : d.attachment.samples)
+        s = static_cast<std::int32_t>(gen());
+      d.checksum = static_cast<std::int32_t>(gen());
+    }
+  }
+
+  static void hide(std::string & /*data*/)
+  {}
+};
+
+struct SkippedShared
+{
+  using Writer = std::vector<FrameV2>;
+  using Reader = std::vector<FrameV1>;
+
+  static const std::size_t blobSize = 4096;
+
+  //! @param window distance to frame which thumbnail points to, number of blobs kept in shared buffer
+  static void init(std::size_t n, std::int64_t window, Writer & w)
+  {
+    std::mt19937 gen(n);
+    std::vector<std::shared_ptr<Blob>> blobs(n);
+    for (auto & b : blobs) {
+      b = std::make_shared<Blob>();
+      b->data.resize(blobSize);
+      for (auto & byte : b->data)
+        byte = static_cast<std::uint8_t>(gen());
+    }
+    w.resize(n);
+    for (std::size_t ii = 0; ii < n; ++ii) {
+      w[ii].image = blobs[ii];
+      const std::size_t later = ii + static_cast<std::size_t>(window);
+      if (later < n)
+        w[ii].thumbnail = blobs[later];
+    }
+  }
+
+  static void hide(std::string & /*data*/)
+  {}
+};
+
+struct UnknownPolymorphic
+{
+  using Writer = std::vector<std::unique_ptr<Shape>>;
+  using Reader = std::vector<std::unique_ptr<Shape>>;
+
+  static const char * splineName() { return "forward_compat.Spline"; }
+
+  //! @param points number of points in each spline
+  static void init(std::size_t n, std::int64_t points, Writer & w)
+  {
+    std::mt19937 gen(n);
+    w.clear();
+    for (std::size_t ii = 0; ii < n; ++ii) {
+      if (ii % 2 == 0) {
+        std::unique_ptr<Circle> circle(new Circle);
+        circle->radius = static_cast<float>(gen());
+        w.push_back(std::move(circle));
+      } else {
+        std::unique_ptr<Spline> spline(new Spline);
+        spline->points.resize(static_cast<std::size_t>(points));
+        for (auto & p : spline->points)
+          p = static_cast<float>(gen());
+        w.push_back(std::move(spline));
+      }
+      w.back()->id = static_cast<std::int32_t>(ii);
+    }
+  }
+
+  //! Name is saved only with first object of type, so that one place has to be changed
+  static void hide(std::string & data)
+  {
+    const std::string name = splineName();
+    const auto found = data.find(name);
+    if (found != std::string::npos)
+      data[found] = 'F';
+  }
+};
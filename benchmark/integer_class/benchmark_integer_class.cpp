@@ -14,6 +14,9 @@
 #include "IntegerClass.pb.h"
 #include "benchmark_integer_class_protobuf.hpp"
 
+// fields of IntegerClass are encoded at once in ExtendableBinary archive, saved data doesn't change
+CEREAL_EXTENDABLE_BINARY_FUSED_STRUCT(IntegerClass)
+
 
 
 template<class BenchArchive, class param = void, param...flags>
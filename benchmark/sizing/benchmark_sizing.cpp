@@ -0,0 +1,83 @@
+//
+// Computing size of ExtendableBinary archive with encoded_size compared to saving it to null stream.
+//
+
+#include <benchmark/benchmark.h>
+
+#include "benchmark_config.hpp"
+#include "utils.hpp"
+
+#include "cereal/types/string.hpp"
+#include "cereal/types/vector.hpp"
+
+struct SizingRecord
+{
+  std::int32_t id = 0;
+  std::uint64_t timestamp = 0;
+  float value = 0;
+  double score = 0;
+  std::string name;
+  std::vector<std::int32_t> history;
+
+  template<class Archive>
+  void serialize(Archive & ar, std::uint32_t /*version*/)
+  {
+    ar(id, timestamp, value, score, name, history);
+  }
+};
+
+static std::vector<SizingRecord> RandomRecords(std::size_t elements)
+{
+  auto & gen = Random::getInstance().generator();
+  std::vector<SizingRecord> records(elements);
+  for (auto & r : records) {
+    r.id = static_cast<std::int32_t>(gen() % 100000);
+    r.timestamp = gen();
+    r.value = static_cast<float>(gen() % 1000) / 10;
+    r.score = static_cast<double>(gen()) / 3;
+    r.name.assign(gen() % 32, 'a' + static_cast<char>(gen() % 26));
+    r.history.resize(gen() % 8);
+    for (auto & h : r.history)
+      h = static_cast<std::int32_t>(gen() % 1000);
+  }
+  return records;
+}
+
+////////////////
+// benchmark
+////////////////
+
+//! Size computed by saving whole archive to stream which drops data
+void SizeNullStream(benchmark::State & st)
+{
+  auto const records = RandomRecords(st.range(0));
+  std::uint64_t last_size = 0;
+  while (st.KeepRunning()) {
+    NullStream nullstream;
+    {
+      c::ExtendableBinaryOutputArchive ar(nullstream);
+      ar(records);
+    }
+    last_size = nullstream.bytesSaved();
+    benchmark::DoNotOptimize(last_size);
+  }
+  st.counters["bytesSaved"] = benchmark::Counter(last_size, benchmark::Counter::kAvgThreads);
+}
+
+BENCHMARK(SizeNullStream)PARAMS_BENCH_NO_REPEAT_VECT;
+
+//! Size computed by sizing archive which only counts bytes of tags and scalars
+void SizeEncodedSize(benchmark::State & st)
+{
+  auto const records = RandomRecords(st.range(0));
+  std::uint64_t last_size = 0;
+  while (st.KeepRunning()) {
+    last_size = c::encoded_size<c::ExtendableBinaryOutputArchive>(records);
+    benchmark::DoNotOptimize(last_size);
+  }
+  st.counters["bytesSaved"] = benchmark::Counter(last_size, benchmark::Counter::kAvgThreads);
+}
+
+BENCHMARK(SizeEncodedSize)PARAMS_BENCH_NO_REPEAT_VECT;
+
+BENCHMARK_MAIN()
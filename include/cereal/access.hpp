@@ -33,6 +33,7 @@
 #include <iostream>
 #include <cstdint>
 #include <functional>
+#include <new>
 
 #include <cereal/macros.hpp>
 #include <cereal/details/helpers.hpp>
@@ -314,6 +315,13 @@ namespace cereal
         return new T();
       }
 
+      // for placement new with a default constructor
+      template <class T> inline
+      static T * construct( void * storage )
+      {
+        return ::new( storage ) T();
+      }
+
       template <class T> inline
       static std::false_type load_and_construct(...)
       { return std::false_type(); }
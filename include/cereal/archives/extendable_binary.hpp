@@ -31,12 +31,14 @@
 
 #include <cereal/cereal.hpp>
 #include <cereal/types/memory.hpp>
+#include <cereal/types/array_view.hpp>
 #include <array>
+#include <bitset>
+#include <chrono>
 #include <cstring>
 #include <limits>
 #include <map>
 #include <set>
-#include <sstream>
 
 #include <cereal/details/extendable_binary_details.hpp>
 
@@ -70,15 +72,68 @@ namespace cereal
           static Options Default(){ return Options(); }
 
           //! Specify specific options for the ExtendableBinaryOutputArchive
-          /*! @param outputEndian_ The desired endianness of saved (output) data */
-          explicit Options( Endianness outputEndian_ = getEndianness() ) :
-            itsOutputEndianness( outputEndian_ ) { }
+          /*! @param outputEndian_ The desired endianness of saved (output) data
+              @param lengthPrefixedObjects_ Save length of data of every object, @see lengthPrefixedObjects()
+              @param compressIntegerArrays_ Save arrays of integers in compressed form, @see compressIntegerArrays()
+              @param deltaEncodedKeys_ Save integer keys of ordered containers as deltas, @see deltaEncodedKeys()
+              @param packedBits_ Save std::vector<bool> and std::bitset as packed bits, @see packedBits() */
+          explicit Options( Endianness outputEndian_ = getEndianness(),
+                            bool lengthPrefixedObjects_ = false,
+                            bool compressIntegerArrays_ = false,
+                            bool deltaEncodedKeys_ = false,
+                            bool packedBits_ = false ) :
+            itsOutputEndianness( outputEndian_ ),
+            itsLengthPrefixedObjects( lengthPrefixedObjects_ ),
+            itsCompressIntegerArrays( compressIntegerArrays_ ),
+            itsDeltaEncodedKeys( deltaEncodedKeys_ ),
+            itsPackedBits( packedBits_ ) { }
 
           //! Save with little endian order
           Options& littleEndian(){ itsOutputEndianness = Endianness::little; return *this; }
           //! Save with big endian order
           Options& bigEndian(){ itsOutputEndianness = Endianness::big; return *this; }
 
+          //! Save length of data of every object before its fields
+          /*! Reader can skip unknown fields of object and whole skipped objects without reading
+              them field by field. Data of object is kept in memory until object is saved.
+              Option is saved in archive header.
+              @param lengthPrefixedObjects_ if true save length */
+          Options& lengthPrefixedObjects(bool lengthPrefixedObjects_)
+          {
+            itsLengthPrefixedObjects = lengthPrefixedObjects_;
+            return *this;
+          }
+
+          //! Save arrays of integers (e.g. std::vector<std::uint64_t>) in compressed form
+          /*! Every array is saved as varints or with bit packing, whichever is smaller,
+              or as raw memory if compression doesn't reduce size.
+              @param compressIntegerArrays_ if true compress arrays */
+          Options& compressIntegerArrays(bool compressIntegerArrays_)
+          {
+            itsCompressIntegerArrays = compressIntegerArrays_;
+            return *this;
+          }
+
+          //! Save integer keys of ordered containers as one array of differences between consecutive keys
+          /*! Applies to std::set, std::multiset, std::map and std::multimap with integer keys and
+              std::vector of std::chrono::time_point with integer representation.
+              Keys are saved together before values of map. Option is saved in archive header.
+              @param deltaEncodedKeys_ if true save keys as deltas */
+          Options& deltaEncodedKeys(bool deltaEncodedKeys_)
+          {
+            itsDeltaEncodedKeys = deltaEncodedKeys_;
+            return *this;
+          }
+
+          //! Save std::vector<bool> and std::bitset as one field with bits packed into bytes
+          /*! Option is saved in archive header.
+              @param packedBits_ if true save packed bits */
+          Options& packedBits(bool packedBits_)
+          {
+            itsPackedBits = packedBits_;
+            return *this;
+          }
+
         private:
           //! Gets the endianness of the system
           inline static Endianness getEndianness()
@@ -90,54 +145,142 @@ namespace cereal
 
           friend class ExtendableBinaryOutputArchive;
           Endianness itsOutputEndianness;
+          bool itsLengthPrefixedObjects;
+          bool itsCompressIntegerArrays;
+          bool itsDeltaEncodedKeys;
+          bool itsPackedBits;
       };
 
       //! Construct, outputting to the provided stream
-      /*! @param stream The stream to output to. Should be opened with std::ios::binary flag.
+      /*! Data is buffered internally and written to stream in bigger chunks.
+          All data is written to stream when archive is destroyed or flush() is called.
+          @param stream The stream to output to. Should be opened with std::ios::binary flag.
           @param options The ExtendableBinary specific options to use.  See the Options struct
                          for the values of default parameters */
       ExtendableBinaryOutputArchive(std::ostream & stream, Options const & options = Options::Default()) :
+        ExtendableBinaryOutputArchive(&stream, options)
+      { }
+
+      //! Writes buffered data to stream
+      /*! Errors are not reported here, flush() has to be used to check if all data was written */
+      ~ExtendableBinaryOutputArchive() CEREAL_NOEXCEPT = default;
+
+      //! Writes all buffered data to the output stream
+      /*! Data of objects which are being saved with length prefixed objects is written when
+          outermost object is saved.
+          Throws Exception if data cannot be written to stream. */
+      void flush()
+      {
+        itsWriteBuffer.flush();
+      }
+
+      //! Gets number of bytes saved so far, including archive header and data not yet written to stream
+      /*! Space reserved for length of objects which are being saved with length prefixed objects
+          is counted in full until object is saved. */
+      std::uint64_t savedSize() const
+      {
+        return itsWriteBuffer.size();
+      }
+
+      //! Gets number of bytes already written to stream, data kept in buffer is not counted
+      std::uint64_t writtenSize() const
+      {
+        return itsWriteBuffer.written();
+      }
+
+      //! Gets options with which archive was constructed
+      Options getOptions() const
+      {
+        const bool littleEndian = (extendable_binary_detail::is_little_endian() ^ itsConvertEndianness) != 0;
+        return Options(littleEndian ? Options::Endianness::little : Options::Endianness::big,
+                       itsLengthPrefixedObjects, itsCompressIntegerArrays, itsDeltaEncodedKeys, itsPackedBits);
+      }
+
+      //! Starts new archive with the same options, outputting to the provided stream
+      /*! Works as if archive was constructed again, but memory allocated for buffer and tracking
+          of shared pointers, polymorphic types and class versions is kept. Header is saved again,
+          so data can be loaded by new or reset input archive.
+          Data which was not written to previous stream is discarded, flush() has to be called
+          before reset() to write it. Archive can be reset after saving failed with exception.
+          @param stream The stream to output to. Should be opened with std::ios::binary flag. */
+      void reset(std::ostream & stream)
+      {
+        reset(&stream);
+      }
+
+    protected:
+      //! Construct, outputting to the provided stream or only counting saved bytes
+      /*! @param stream The stream to output to, nullptr if data is not written anywhere
+          @param options The ExtendableBinary specific options to use */
+      ExtendableBinaryOutputArchive(std::ostream * stream, Options const & options) :
         OutputArchive<ExtendableBinaryOutputArchive, Flags::ForwardSupport>(this),
-        itsStream(stream),
-        itsConvertEndianness( extendable_binary_detail::is_little_endian() ^ options.is_little_endian() )
+        itsWriteBuffer(stream),
+        itsConvertEndianness( extendable_binary_detail::is_little_endian() ^ options.is_little_endian() ),
+        itsLengthPrefixedObjects( options.itsLengthPrefixedObjects ),
+        itsCompressIntegerArrays( options.itsCompressIntegerArrays ),
+        itsDeltaEncodedKeys( options.itsDeltaEncodedKeys ),
+        itsPackedBits( options.itsPackedBits )
       {
-        const auto littleEndian = options.is_little_endian();
-        this->saveBinary<sizeof(std::uint8_t)>( &littleEndian, sizeof(std::uint8_t) );
+        saveHeader();
       }
 
-      ~ExtendableBinaryOutputArchive() CEREAL_NOEXCEPT = default;
+      //! Starts new archive with the same options, outputting to the provided stream or only counting saved bytes
+      /*! @param stream The stream to output to, nullptr if data is not written anywhere
+          @see reset(std::ostream &) */
+      void reset(std::ostream * stream)
+      {
+        itsWriteBuffer.reset(stream);
+        itsObjects.clear();
+        objectDataNeedsSaving = false;
+        classVersion = 0;
+        isPointer = false;
+        objectId = 0;
+        polymorphicId = 0;
+        polymorphicName = nullptr;
+        resetTracking();
+        saveHeader();
+      }
+
+    private:
+      //! Writes archive header with endianness and options which change format of data
+      void saveHeader()
+      {
+        using namespace extendable_binary_detail;
+        std::uint8_t header = 0;
+        if(is_little_endian() ^ itsConvertEndianness)
+          header |= static_cast<std::uint8_t>(HeaderFlags::LittleEndian);
+        if(itsLengthPrefixedObjects)
+          header |= static_cast<std::uint8_t>(HeaderFlags::LengthPrefixedObjects);
+        if(itsDeltaEncodedKeys)
+          header |= static_cast<std::uint8_t>(HeaderFlags::DeltaEncodedKeys);
+        if(itsPackedBits)
+          header |= static_cast<std::uint8_t>(HeaderFlags::PackedBits);
+        this->saveBinary<sizeof(std::uint8_t)>( &header, sizeof(std::uint8_t) );
+      }
 
+    public:
       //! Writes size bytes of data to the output stream
       /*! Swaps byte order in DataSize chunks if needed.
        * Throws Exception if size bytes cannot be writen to stream. */
       template <std::size_t DataSize> inline
       void saveBinary( const void * data, std::size_t size )
       {
-        std::size_t writtenSize = 0;
-
-        if( itsConvertEndianness )
-        {
-          for( std::size_t i = 0; i < size; i += DataSize )
-            for( std::size_t j = 0; j < DataSize; ++j )
-              writtenSize += static_cast<std::size_t>( itsStream.rdbuf()->sputn( reinterpret_cast<const char*>( data ) + DataSize - j - 1 + i, 1 ) );
-        }
+        if( itsWriteBuffer.countsOnly() )
+          itsWriteBuffer.count( size );
+        else if( DataSize > 1 && itsConvertEndianness )
+          itsWriteBuffer.writeSwapped<DataSize>( data, size / DataSize );
         else
-          writtenSize = static_cast<std::size_t>( itsStream.rdbuf()->sputn( reinterpret_cast<const char*>( data ), size ) );
-
-        if(writtenSize != size)
-          throw Exception("Failed to write " + std::to_string(size) + " bytes to output stream! Wrote " + std::to_string(writtenSize));
+          itsWriteBuffer.write( data, size );
       }
 
       //! Writes size bytes of data to the output stream without any byte order swapping
       /*! Throws Exception if size bytes cannot be writen to stream. */
       void saveBinaryNoSwap( const void * data, std::size_t size )
       {
-        std::size_t writtenSize = 0;
-
-        writtenSize = static_cast<std::size_t>( itsStream.rdbuf()->sputn( reinterpret_cast<const char*>( data ), size ) );
-
-        if(writtenSize != size)
-          throw Exception("Failed to write " + std::to_string(size) + " bytes to output stream! Wrote " + std::to_string(writtenSize));
+        if( itsWriteBuffer.countsOnly() )
+          itsWriteBuffer.count( size );
+        else
+          itsWriteBuffer.write( data, size );
       }
 
       //! Writes size bytes of data to the output stream
@@ -148,19 +291,33 @@ namespace cereal
       template<std::size_t DataSize> inline
       void saveBinarySingle( const void * data, std::size_t size )
       {
-        std::size_t writtenSize = 0;
+        if( itsWriteBuffer.countsOnly() )
+        {
+          itsWriteBuffer.count( size );
+          return;
+        }
         const std::uint8_t * dataEndian = reinterpret_cast<const std::uint8_t*>(data) + (extendable_binary_detail::is_little_endian() ? 0 : DataSize - size);
+        std::uint8_t * dest = itsWriteBuffer.reserve( size );
 
         if( itsConvertEndianness )
         {
           for( std::size_t j = 0; j < size; ++j )
-            writtenSize += static_cast<std::size_t>( itsStream.rdbuf()->sputn( reinterpret_cast<const char*>( dataEndian ) + size - j - 1, 1 ) );
+            dest[j] = dataEndian[size - j - 1];
         }
         else
-          writtenSize = static_cast<std::size_t>( itsStream.rdbuf()->sputn( reinterpret_cast<const char*>( dataEndian ), size ) );
+          std::memcpy( dest, dataEndian, size );
+        itsWriteBuffer.commit( size );
+      }
 
-        if(writtenSize != size)
-          throw Exception("Failed to write " + std::to_string(size) + " bytes to output stream! Wrote " + std::to_string(writtenSize));
+      //! Writes type tag to the output stream
+      /*! @param fieldType type of field
+          @param other field specific data stored on four least significant bits */
+      inline void saveTypeTag( extendable_binary_detail::FieldType fieldType, std::uint8_t other )
+      {
+        if( itsWriteBuffer.countsOnly() )
+          itsWriteBuffer.count( 1 );
+        else
+          itsWriteBuffer.writeByte( extendable_binary_detail::writeType( fieldType, other ) );
       }
 
       //! Writes varint to the stream
@@ -173,16 +330,172 @@ namespace cereal
       {
         static_assert(sizeof(T) <= (extendable_binary_detail::maxVarintSize*7)/8, "value is to big to be saved as varint");
         static_assert(std::is_unsigned<T>::value, "only unsigned varints are supported");
-        std::array<std::uint8_t, extendable_binary_detail::maxVarintSize> buffer;
-        std::size_t size = 0;
-        while (v > 0x7F) {
-          buffer[size] = (static_cast<std::uint8_t>(v) & 0x7f) | 0x80;
-          v >>= 7;
-          ++size;
+        if( itsWriteBuffer.countsOnly() )
+        {
+          itsWriteBuffer.count( extendable_binary_detail::encodedVarintSize( v ) );
+          return;
         }
-        buffer[size] = static_cast<std::uint8_t>(v) & 0x7f;
-        // we don't want bit swap here
-        saveBinaryNoSwap(buffer.data(), size + 1);
+        // varint is encoded directly into write buffer, we don't want bit swap here
+        std::uint8_t * buffer = itsWriteBuffer.reserve( extendable_binary_detail::maxVarintSize );
+        itsWriteBuffer.commit( extendable_binary_detail::encodeVarint( v, buffer ) );
+      }
+
+      //! Checks if arrays of integers are saved in compressed form
+      bool compressesIntegerArrays() const
+      {
+        return itsCompressIntegerArrays;
+      }
+
+      //! Checks if keys of ordered containers are saved as one delta encoded array
+      bool savesDeltaEncodedKeys() const
+      {
+        return itsDeltaEncodedKeys;
+      }
+
+      //! Writes array of integers as FieldType::integer_array
+      /*! Encoding is chosen from sizes of varint, delta and bit packed representations.
+          @param first iterator to first element
+          @param count number of elements
+          @param get gets integer of type T from element
+          @param allowRaw if nothing should be written when compressed array wouldn't be smaller than raw memory
+          @return if array was written */
+      template <class T, class It, class Get>
+      bool saveIntegerArray(It first, std::size_t count, Get get, bool allowRaw)
+      {
+        using namespace extendable_binary_detail;
+        if(count == 0 && allowRaw)
+          return false;
+        const IntegerArrayStats stats = count == 0 ? IntegerArrayStats{0, 0, 0, 0} : getIntegerArrayStats<T>(first, count, get);
+        const unsigned width = bitWidth(stats.range);
+        const std::uint64_t min = std::is_signed<T>::value ? encodeZigZag(static_cast<std::int64_t>(stats.min)) : stats.min;
+        const std::uint64_t bitPackedBytes = varintLength(min) + 1 + bitPackedSize(count, width);
+        auto encoding = IntegerArrayEncoding::varint;
+        std::uint64_t size = stats.varintBytes;
+        if(stats.deltaBytes < size) {
+          encoding = IntegerArrayEncoding::delta;
+          size = stats.deltaBytes;
+        }
+        if(bitPackedBytes < size) {
+          encoding = IntegerArrayEncoding::bit_packed;
+          size = bitPackedBytes;
+        }
+        if(allowRaw && varintLength(size) + size >= count * sizeof(T))
+          return false;
+
+        const auto markers = std::is_signed<T>::value ? IntegerArrayMarkers::IsSigned : IntegerArrayMarkers{};
+        saveTypeTag(FieldType::integer_array, static_cast<std::uint8_t>(static_cast<std::uint8_t>(encoding) | static_cast<std::uint8_t>(markers)));
+        saveVarint(count);
+        saveVarint(size);
+        if(encoding != IntegerArrayEncoding::bit_packed) {
+          std::uint64_t previous = 0;
+          for(std::size_t i = 0; i < count; ++i, ++first) {
+            const T value = get(*first);
+            const std::uint64_t bits = toArrayInteger(value);
+            const bool isDelta = encoding == IntegerArrayEncoding::delta && i > 0;
+            std::uint8_t * dest = itsWriteBuffer.reserve( maxVarintSize );
+            itsWriteBuffer.commit( encodeVarint( isDelta ? toArrayDelta(bits, previous) : toArrayVarint(value), dest ) );
+            previous = bits;
+          }
+          return true;
+        }
+
+        saveVarint(min);
+        itsWriteBuffer.writeByte(static_cast<std::uint8_t>(width));
+        std::uint64_t values[bitPackedBlockSize];
+        for(std::size_t i = 0; i < count; i += bitPackedBlockSize) {
+          const std::size_t blockCount = std::min<std::size_t>(bitPackedBlockSize, count - i);
+          for(std::size_t j = 0; j < blockCount; ++j, ++first)
+            values[j] = toArrayInteger(get(*first)) - stats.min;
+          std::uint8_t * dest = itsWriteBuffer.reserve( bitPackedBufferSize );
+          std::memset(dest, 0, bitPackedBufferSize);
+          packBits(values, blockCount, width, dest);
+          itsWriteBuffer.commit( static_cast<std::size_t>(bitPackedSize(blockCount, width)) );
+        }
+        return true;
+      }
+
+      //! Checks if std::vector<bool> and std::bitset are saved as packed bits
+      bool savesPackedBits() const
+      {
+        return itsPackedBits;
+      }
+
+      //! Writes bits as FieldType::bit_array
+      /*! @param count number of bits
+          @param get gets bit with given index */
+      template <class Get>
+      void saveBits(std::size_t count, Get get)
+      {
+        using namespace extendable_binary_detail;
+        saveTypeTag(FieldType::bit_array, 0);
+        saveVarint(count);
+        const std::size_t chunk = 64 * 64;
+        for(std::size_t i = 0; i < count; i += chunk) {
+          const std::size_t bits = std::min(chunk, count - i);
+          const std::size_t bytes = static_cast<std::size_t>(bitArraySize(bits));
+          packBools(get, i, bits, itsWriteBuffer.reserve( bytes ));
+          itsWriteBuffer.commit( bytes );
+        }
+      }
+
+      //! Writes packed structs to the stream
+      /*! Type tag, layout of struct and, for arrays, number of elements are saved, then raw memory of structs.
+          @param layout layout of struct
+          @param data address of first struct
+          @param count number of structs, has to be 1 if isArray is false
+          @param isArray if structs are saved as array */
+      void savePackedStructs(extendable_binary_detail::PackedLayout const & layout, const void * data,
+                             std::size_t count, bool isArray)
+      {
+        using namespace extendable_binary_detail;
+        const auto markers = isArray ? PackedStructMarkers::IsArray : PackedStructMarkers::None;
+        saveTypeTag(FieldType::packed_struct, static_cast<std::uint8_t>(markers));
+        saveVarint(layout.size);
+        saveVarint(layout.fields.size());
+        std::size_t next = 0;
+        for(auto const & field : layout.fields) {
+          const bool hasOffset = field.offset != next;
+          itsWriteBuffer.writeByte(encodePackedField(field, hasOffset));
+          if(hasOffset) {
+            saveVarint(field.offset);
+          }
+          next = field.offset + field.size;
+        }
+        if(isArray) {
+          saveVarint(count);
+        }
+
+        if(false == itsConvertEndianness) {
+          itsWriteBuffer.write(data, count * layout.size);
+          return;
+        }
+        const std::uint8_t * src = reinterpret_cast<const std::uint8_t *>(data);
+        for(std::size_t i = 0; i < count; ++i, src += layout.size) {
+          std::uint8_t * dest = itsWriteBuffer.reserve(layout.size);
+          std::memcpy(dest, src, layout.size);
+          for(auto const & field : layout.fields) {
+            std::reverse(dest + field.offset, dest + field.offset + field.size);
+          }
+          itsWriteBuffer.commit(layout.size);
+        }
+      }
+
+      //! Saves fields of fused struct encoded at once, @see CEREAL_EXTENDABLE_BINARY_FUSED_STRUCT
+      /*! Metadata of object is saved first, the same way as before the first field saved on its own.
+          @param data type tags and values of all fields
+          @param size size of data in bytes */
+      void saveFusedFields(const std::uint8_t * data, std::size_t size)
+      {
+        if(size == 0)
+          return;
+        savingOtherField();
+        itsWriteBuffer.write(data, size);
+      }
+
+      //! Checks if data is saved in big endian byte order
+      bool savesBigEndian() const
+      {
+        return (extendable_binary_detail::is_little_endian() != 0) == (itsConvertEndianness != 0);
       }
 
       //! Store temporarily class version to be saved later.
@@ -216,10 +529,11 @@ namespace cereal
       }
 
       //! Store temporarily polymorphic name of type to be saved later.
-      /*! Polymorphic name is saved when saveObjectData() is called. */
+      /*! Polymorphic name is saved when saveObjectData() is called.
+          Name is not copied, it has to be valid until then (bindings pass static name). */
       void savePolymorphicName(const std::string& name)
       {
-        polymorphicName = name;
+        polymorphicName = &name;
       }
 
       //! Indicate beginning of new object saving
@@ -252,6 +566,9 @@ namespace cereal
         } else{
           // there were fields in class, have to save end marker
           saveEndMarker();
+          if(itsLengthPrefixedObjects) {
+            saveObjectLength();
+          }
           /* TODO we are saving last_field marker for pointers even if it's not needed
            * Easiest way to solve it wold be to make queue of save object types in archive to know that we don't have to save it.
            * But that would mean that we would have to allocate some memory. We could also make specializations for prologue for pointer types
@@ -279,18 +596,22 @@ namespace cereal
           if(endOfObject) {
             finalMarker |= PointerMarkers::Empty;
           }
-          std::uint8_t t = writeType(FieldType::pointer, static_cast<std::uint8_t>(finalMarker));
-          saveBinary<sizeof(std::uint8_t)>(&t, sizeof(std::uint8_t));
+          saveTypeTag(FieldType::pointer, static_cast<std::uint8_t>(finalMarker));
           if(objectId > 0) {
             saveVarint(objectId);
           }
           if(polymorphicId > 0) {
             saveBinary<sizeof(std::int32_t)>(&polymorphicId, sizeof(std::int32_t));
           }
-          if(false == polymorphicName.empty()) {
-            saveVarint(polymorphicName.size());
-            saveBinary<sizeof(decltype(polymorphicName)::value_type)>( polymorphicName.c_str(),
-                polymorphicName.size() * sizeof(decltype(polymorphicName)::value_type));
+          if(polymorphicName != nullptr) {
+            using char_type = std::string::value_type;
+            saveVarint(polymorphicName->size());
+            saveBinary<sizeof(char_type)>( polymorphicName->c_str(),
+                polymorphicName->size() * sizeof(char_type));
+          }
+          // new shared object or polymorphic name, reader can't skip outer object without reading it
+          if(((objectId & detail::msb_32bit) != 0 || polymorphicName != nullptr) && false == itsObjects.empty()) {
+            itsObjects.back().hasDefinitions = true;
           }
         } else {
           ClassMarkers finalMarker = ClassMarkers::None;
@@ -301,13 +622,15 @@ namespace cereal
           if(endOfObject) {
             finalMarker |= ClassMarkers::EmptyClass;
           }
-          std::uint8_t t = writeType(FieldType::class_t, static_cast<std::uint8_t>(finalMarker));
-          saveBinary<sizeof(std::uint8_t)>(&t, sizeof(std::uint8_t));
+          saveTypeTag(FieldType::class_t, static_cast<std::uint8_t>(finalMarker));
           // save needed data
           if(classVersion > 0) {
             saveVarint(classVersion);
           }
         }
+        if(itsLengthPrefixedObjects && false == endOfObject) {
+          itsObjects.push_back({itsWriteBuffer.beginFrame(), false});
+        }
         // reset variables
         objectDataNeedsSaving = false;
         classVersion = 0;
@@ -315,7 +638,7 @@ namespace cereal
         objectId = 0;
         // version is only saved when method has version argument so we have to reset it
         polymorphicId = 0;
-        polymorphicName.clear();
+        polymorphicName = nullptr;
       }
 
       //! Writes last_field marker to stream
@@ -323,22 +646,96 @@ namespace cereal
       void saveEndMarker()
       {
         using namespace extendable_binary_detail;
-        std::uint8_t t = writeType(FieldType::last_field, 0);
-        saveBinary<sizeof(std::uint8_t)>(&t, sizeof(std::uint8_t));
+        saveTypeTag(FieldType::last_field, 0);
+      }
+
+      //! Writes length of object data before its fields
+      /*! Called after end of object marker is saved. */
+      void saveObjectLength()
+      {
+        using namespace extendable_binary_detail;
+        const ObjectFrame object = itsObjects.back();
+        itsObjects.pop_back();
+        itsWriteBuffer.endFrame(object.frame, encodeObjectLength(itsWriteBuffer.frameLength(object.frame), object.hasDefinitions));
+        if(object.hasDefinitions && false == itsObjects.empty()) {
+          itsObjects.back().hasDefinitions = true;
+        }
       }
 
+      //! Object saved with length for which fields are being saved
+      struct ObjectFrame
+      {
+        std::size_t frame; //!< position of length in write buffer
+        bool hasDefinitions; //!< if new shared object or polymorphic name was saved in object
+      };
+
     private:
       bool objectDataNeedsSaving = false; //!< If object metadata need to be saved
       std::uint32_t classVersion = 0; //!< Last object's class version
       bool isPointer = false; //!< Last object was pointer
       std::uint32_t objectId = 0; //!< Last object's id (for shared pointers)
       std::uint32_t polymorphicId = 0; //!< Last object's polymorphic id
-      std::string polymorphicName; //!< Last object's polymorphic name
+      std::string const * polymorphicName = nullptr; //!< Last object's polymorphic name
 
-      std::ostream & itsStream; //!< Stream to save data
+      extendable_binary_detail::WriteBuffer itsWriteBuffer; //!< Buffer in front of stream to save data
       const uint8_t itsConvertEndianness; //!< If set to true, we will need to swap bytes upon saving
+      const bool itsLengthPrefixedObjects; //!< If length of object data is saved
+      const bool itsCompressIntegerArrays; //!< If arrays of integers are compressed
+      const bool itsDeltaEncodedKeys; //!< If keys of ordered containers are saved as one integer array
+      const bool itsPackedBits; //!< If std::vector<bool> and std::bitset are saved as packed bits
+      std::vector<ObjectFrame> itsObjects; //!< Stack of objects being saved with length
+  };
+
+  // ######################################################################
+  //! An output archive which only computes size of data saved by ExtendableBinaryOutputArchive
+  /*! All encoding decisions are the same as in ExtendableBinaryOutputArchive (sizes of integers,
+      varints, shared pointers saved once, polymorphic names saved on first use, length of objects),
+      but data is not written anywhere. Type tags, integers, varints and arrays of arithmetic types
+      are only counted, without being encoded or copied; compressed integer arrays and packed
+      structs are encoded to scratch space to get their size. Size is available with savedSize()
+      and includes archive header.
+
+      @code{cpp}
+      cereal::ExtendableBinarySizingArchive sizing(options);
+      sizing(message);
+      buffer.reserve(sizing.savedSize());
+      @endcode
+
+      @see encoded_size()
+      \ingroup Archives */
+  class ExtendableBinarySizingArchive : public ExtendableBinaryOutputArchive
+  {
+    public:
+      //! Construct archive computing size of data saved with given options
+      /*! @param options options of ExtendableBinaryOutputArchive for which size is computed */
+      explicit ExtendableBinarySizingArchive(Options const & options = Options::Default()) :
+        ExtendableBinaryOutputArchive(nullptr, options)
+      { }
+
+      //! Starts computing size of new archive with the same options
+      /*! Saved size is counted from zero again, including archive header */
+      void reset()
+      {
+        ExtendableBinaryOutputArchive::reset(nullptr);
+      }
   };
 
+  //! Computes number of bytes saved by ExtendableBinaryOutputArchive for object, without saving it
+  /*! Result is exact size of archive containing only this object (including archive header).
+      @tparam Archive output archive, only ExtendableBinaryOutputArchive is supported
+      @param t object to be measured
+      @param options options of archive
+      @see ExtendableBinarySizingArchive */
+  template <class Archive, class T> inline
+  std::uint64_t encoded_size(T const & t, typename Archive::Options const & options = Archive::Options::Default())
+  {
+    static_assert(std::is_same<Archive, ExtendableBinaryOutputArchive>::value,
+                  "encoded_size is supported only for ExtendableBinaryOutputArchive");
+    ExtendableBinarySizingArchive ar(options);
+    ar(t);
+    return ar.savedSize();
+  }
+
   // ######################################################################
   //! An input archive designed to load data saved using ExtendableBinaryOutputArchive
   /*! This archive outputs data to a stream in an compact binary representation with additional metadata needed to support
@@ -436,18 +833,59 @@ namespace cereal
                          for the values of default parameters */
       ExtendableBinaryInputArchive(std::istream & stream, Options const & options = Options::Default()) :
         InputArchive<ExtendableBinaryInputArchive, Flags::ForwardSupport>(this),
-        sharedObjectStream(std::ios::binary | std::ios::in | std::ios::out),
-        itsStream(stream, sharedObjectStream, options.itsMaxSharedBufferSize),
+        itsStream(stream, options.itsMaxSharedBufferSize),
+        itsOptions(options),
+        itsConvertEndianness( false )
+      {
+        loadHeader();
+      }
+
+      //! Construct, loading from the provided memory buffer
+      /*! Data is read directly from memory without stream indirection. Reading past
+          end of buffer results in Exception, same as for truncated stream.
+          @param data The beginning of data to read from. Has to be valid for whole archive lifetime.
+          @param size The size of data in bytes
+          @param options The ExtendableBinary specific options to use.  See the Options struct
+                         for the values of default parameters */
+      ExtendableBinaryInputArchive(const void * data, std::size_t size, Options const & options = Options::Default()) :
+        InputArchive<ExtendableBinaryInputArchive, Flags::ForwardSupport>(this),
+        itsStream(data, size, options.itsMaxSharedBufferSize),
+        itsOptions(options),
         itsConvertEndianness( false )
       {
-        uint8_t streamLittleEndian;
-        this->loadBinary<sizeof(std::uint8_t)>( &streamLittleEndian, sizeof(std::uint8_t));
-        itsConvertEndianness = options.is_little_endian() ^ streamLittleEndian;
-        itsIgnoreUnknownPolymorphicTypes = options.itsIgnoreUnknownPolymorphicTypes;
+        loadHeader();
       }
 
       ~ExtendableBinaryInputArchive() CEREAL_NOEXCEPT = default;
 
+      //! Gets options with which archive was constructed
+      Options const & getOptions() const
+      {
+        return itsOptions;
+      }
+
+      //! Starts loading new archive with the same options from the provided stream
+      /*! Works as if archive was constructed again, but memory allocated for tracking of shared
+          pointers, polymorphic types and class versions is kept. Header of new archive is loaded.
+          Data of skipped shared objects is released. Archive can be reset after loading failed
+          with exception.
+          @param stream The stream to read from. Should be opened with std::ios::binary flag. */
+      void reset(std::istream & stream)
+      {
+        itsStream.reset(stream);
+        resetState();
+      }
+
+      //! Starts loading new archive with the same options from the provided memory buffer
+      /*! @param data The beginning of data to read from. Has to be valid until archive is reset or destroyed.
+          @param size The size of data in bytes
+          @see reset(std::istream &) */
+      void reset(const void * data, std::size_t size)
+      {
+        itsStream.reset(data, size);
+        resetState();
+      }
+
       //! Reads size bytes of data from the input stream
       /*! @param data The data to save
           @param size The number of bytes in the data
@@ -457,21 +895,15 @@ namespace cereal
       {
         // load data
         auto const readSize = itsStream.readBinary( reinterpret_cast<char*>( data ), size );
-        if(false == savedShared.saving.empty()) {
-          itsStream.checkIfMaxSize(size, sharedObjectStream);
-          sharedObjectStream.write(reinterpret_cast<char*>(data), size);
-        }
-
         if(readSize != size)
           throw Exception("Failed to read " + std::to_string(size) + " bytes from input stream! Read " + std::to_string(readSize));
 
+        if(false == savedShared.saving.empty())
+          itsStream.copyToShared(data, size);
+
         // flip bytes if needed
         if( itsConvertEndianness )
-        {
-          std::uint8_t * ptr = reinterpret_cast<std::uint8_t*>( data );
-          for( std::size_t i = 0; i < size; i += DataSize )
-            extendable_binary_detail::swap_bytes<DataSize>( ptr + i );
-        }
+          detail::swap_bytes_inplace<DataSize>( data, size / DataSize );
       }
 
       //! Load least significant size bytes of type which sizeof is DataSize.
@@ -487,14 +919,12 @@ namespace cereal
         // load data
         std::uint8_t* dataEndian = reinterpret_cast<std::uint8_t*>(data) + (extendable_binary_detail::is_little_endian() ? 0 : DataSize - size);
         auto const readSize = itsStream.readBinary( reinterpret_cast<char*>( dataEndian ), size );
-        if(false == savedShared.saving.empty()) {
-          itsStream.checkIfMaxSize(size, sharedObjectStream);
-          sharedObjectStream.write(reinterpret_cast<char*>(data), size);
-        }
-
         if(readSize != size)
           throw Exception("Failed to read " + std::to_string(size) + " bytes from input stream! Read " + std::to_string(readSize));
 
+        if(false == savedShared.saving.empty())
+          itsStream.copyToShared(dataEndian, size);
+
         // flip bits if needed
         if( itsConvertEndianness ) {
           std::uint8_t * ptr = reinterpret_cast<std::uint8_t*>( dataEndian );
@@ -518,14 +948,155 @@ namespace cereal
       }
 
 
+      //! Gets size bytes of data directly from input memory buffer, without copying
+      /*! Reading position is moved only when address is returned.
+          @param size The number of bytes in the data
+          @tparam DataSize The size of the actual type of the data elements being loaded
+          @tparam Alignment Required alignment of returned address
+          @return address of data in input buffer or nullptr if data has to be loaded with loadBinary():
+                  archive doesn't read from memory buffer, bytes have to be swapped, data has to be saved
+                  for skipped shared object, address is misaligned or buffer is too short */
+      template <std::size_t DataSize, std::size_t Alignment> inline
+      const void * loadBinaryView( std::size_t size )
+      {
+        if( (itsConvertEndianness && DataSize > 1) || false == savedShared.saving.empty() )
+          return nullptr;
+        std::size_t available;
+        const std::uint8_t * data = itsStream.peekMemory(available);
+        if( data == nullptr || available < size || reinterpret_cast<std::uintptr_t>(data) % Alignment != 0 )
+          return nullptr;
+        itsStream.skipMemory(size);
+        return data;
+      }
+
+      //! Gets remaining data of input memory buffer without moving reading position
+      /*! @param available number of bytes available at returned address
+          @return address of data or nullptr if archive doesn't read from memory buffer or data
+                  has to be saved for skipped shared object
+          @see skipDirect() */
+      const std::uint8_t * peekDirect(std::size_t & available) const
+      {
+        if(false == savedShared.saving.empty())
+          return nullptr;
+        return itsStream.peekMemory(available);
+      }
+
+      //! Moves reading position after size bytes returned by peekDirect()
+      void skipDirect(std::size_t size)
+      {
+        itsStream.skipMemory(size);
+      }
+
+      //! Gets max number of bytes copied from skipped shared objects which were kept at once
+      /*! Value can be compared against Options::maxSharedBufferSize() to size the limit
+          for data saved by newer versions of the application */
+      std::size_t peakSharedBufferSize() const
+      {
+        return itsStream.sharedDataPeak();
+      }
+
+      //! Gets number of bytes of data which was skipped since archive was created or reset
+      /*! Counts values of fields and objects unknown to reader, also when they are copied
+          for skipped shared objects, and data of shared objects which were already loaded.
+          Type tags and sizes read while skipping are not counted. */
+      std::size_t skippedDataSize() const
+      {
+        return itsSkippedDataSize;
+      }
+
+      //! Checks if loaded data is in big endian byte order
+      bool loadsBigEndian() const
+      {
+        return (extendable_binary_detail::is_little_endian() != 0) == (itsConvertEndianness != 0);
+      }
+
+      //! Checks if keys of ordered containers are loaded as one delta encoded array
+      /*! @see ExtendableBinaryOutputArchive::Options::deltaEncodedKeys() */
+      bool hasDeltaEncodedKeys() const
+      {
+        return itsDeltaEncodedKeys;
+      }
+
+      //! Checks if std::vector<bool> and std::bitset are loaded as packed bits
+      /*! @see ExtendableBinaryOutputArchive::Options::packedBits() */
+      bool hasPackedBits() const
+      {
+        return itsPackedBits;
+      }
+
+      //! Loads bits of FieldType::bit_array
+      /*! Number of bits has to be already loaded. Bits are read in chunks, chunk is called with
+          address of packed bits, index of first bit in chunk and number of bits in chunk.
+          Throws Exception if not enough bytes can be read.
+          @param count number of bits
+          @param chunk called for every chunk of loaded bits */
+      template <class Chunk>
+      void loadBits(std::uint64_t count, Chunk chunk)
+      {
+        using namespace extendable_binary_detail;
+        std::uint8_t buffer[writeBufferSize];
+        for(std::uint64_t i = 0; i < count; ) {
+          const std::size_t bits = static_cast<std::size_t>(std::min<std::uint64_t>(count - i, 8 * writeBufferSize));
+          const std::size_t bytes = static_cast<std::size_t>(bitArraySize(bits));
+          const void * data = loadBinaryView<1, 1>( bytes );
+          if(data == nullptr) {
+            loadBinary<1>( buffer, bytes );
+            data = buffer;
+          }
+          chunk(reinterpret_cast<const std::uint8_t *>(data), static_cast<std::size_t>(i), bits);
+          i += bits;
+        }
+      }
+
+      //! Loads array saved as FieldType::integer_array
+      /*! Type tag has to be already loaded.
+          Throws Exception if array has more than capacity elements, data is corrupted
+          or value doesn't fit to T.
+          @param typeInfo field specific part of type tag
+          @param capacity maximal number of elements
+          @param sink called with every loaded element of type T
+          @return number of loaded elements */
+      template <class T, class Sink>
+      std::size_t loadIntegerArray(std::uint8_t typeInfo, std::size_t capacity, Sink sink)
+      {
+        using namespace extendable_binary_detail;
+        std::uint64_t count;
+        loadVarint(count);
+        std::uint64_t size;
+        loadVarint(size);
+        if(count > capacity)
+          throw Exception("BinaryData is bigger than dest var");
+        const auto encoding = static_cast<IntegerArrayEncoding>(typeInfo & IntegerArrayMarkers::EncodingMask);
+        const bool isSigned = (typeInfo & IntegerArrayMarkers::IsSigned) != 0;
+        // encoded data can't be bigger than varints of all elements
+        if(static_cast<std::uint8_t>(encoding) > static_cast<std::uint8_t>(IntegerArrayEncoding::delta)
+           || size > (count + 1) * maxVarintSize)
+          throw Exception("Integer array data is corrupted");
+
+        const std::size_t bytes = static_cast<std::size_t>(size);
+        const std::uint8_t * src = reinterpret_cast<const std::uint8_t *>(loadBinaryView<1, 1>( bytes ));
+        std::vector<std::uint8_t> copy;
+        if(src == nullptr) {
+          copy.resize(bytes);
+          loadBinary<1>( copy.data(), bytes );
+          src = copy.data();
+        }
+        if(encoding == IntegerArrayEncoding::bit_packed)
+          decodeBitPackedArray<T>(src, bytes, static_cast<std::size_t>(count), isSigned, sink);
+        else
+          decodeVarintArray<T>(src, bytes, static_cast<std::size_t>(count), isSigned, encoding == IntegerArrayEncoding::delta, sink);
+        return static_cast<std::size_t>(count);
+      }
+
       //! Discards size bytes from the input stream
       /*! @param size The number of bytes to skip
           Throws Exception if not enough bytes are read */
       inline void skipData(std::size_t size) {
+        itsSkippedDataSize += size;
         if(savedShared.saving.empty()) {
           itsStream.skipData(size);
         } else {
-          itsStream.readToOtherStream(size, sharedObjectStream);
+          itsStream.readToShared(size);
         }
       }
 
@@ -538,7 +1109,10 @@ namespace cereal
       {
         using namespace extendable_binary_detail;
         std::uint8_t v;
-        loadBinary<sizeof(std::uint8_t)>(&v, sizeof(std::uint8_t));
+        if(const std::uint8_t * direct = readDirect(sizeof(std::uint8_t)))
+          v = *direct;
+        else
+          loadBinary<sizeof(std::uint8_t)>(&v, sizeof(std::uint8_t));
         lastTypeTag = extendable_binary_detail::readType(v);
         return lastTypeTag.first != FieldType::omitted_field;
       }
@@ -580,95 +1154,123 @@ namespace cereal
         static_assert(sizeof(T) <= (extendable_binary_detail::maxVarintSize*7)/8, "value is to big to be a varint");
         static_assert(std::is_unsigned<T>::value, "only unsigned varints are supported");
 
-        std::uint32_t f = 0, s = 0;
-        auto load = [&]() {
-          std::uint8_t bytes = 1;
-          std::uint32_t f1 = 0, f2 = 0, f3 = 0, f4 = 0, s1 = 0, s2 = 0, s3 = 0, s4 = 0, s5 = 0, s6 = 0;
-          loadBinarySingle<sizeof(std::uint32_t)>(&f1, sizeof(std::uint8_t));
-          if(f1 < 0x80) {
-            f = f1;
-            return bytes;
-          }
-          loadBinarySingle<sizeof(std::uint32_t)>(&f2, sizeof(std::uint8_t));
-          ++bytes;
-          if(f2 < 0x80) {
-            f = (f1 - 0x80) | (f2 << 7);
-            return bytes;
-          }
-          loadBinarySingle<sizeof(std::uint32_t)>(&f3, sizeof(std::uint8_t));
-          ++bytes;
-          if(f3 < 0x80) {
-            f = (f1 - 0x80) | ((f2 - 0x80) << 7) | (f3 << 14);
-            return bytes;
-          }
-          loadBinarySingle<sizeof(std::uint32_t)>(&f4, sizeof(std::uint8_t));
-          ++bytes;
-          if(f4 < 0x80) {
-            f = (f1 - 0x80) | ((f2 - 0x80) << 7) | ((f3 - 0x80) << 14) | (f4 << 21);
-            return bytes;
-          }
-          loadBinarySingle<sizeof(std::uint32_t)>(&s1, sizeof(std::uint8_t));
-          ++bytes;
-          if(s1 < 0x80) {
-            f = (f1 - 0x80) | ((f2 - 0x80) << 7) | ((f3 - 0x80) << 14) | ((f4 - 0x80) << 21) | (s1 << 28);
-            s = s1 >> 3;
-            return bytes;
-          }
-          loadBinarySingle<sizeof(std::uint32_t)>(&s2, sizeof(std::uint8_t));
-          ++bytes;
-          if(s2 < 0x80) {
-            f = (f1 - 0x80) | ((f2 - 0x80) << 7) | ((f3 - 0x80) << 14) | ((f4 - 0x80) << 21) | ((s1 - 0x80) << 28);
-            s = ((s1 - 0x80) >> 4) | (s2 << 3);
-            return bytes;
-          }
-          loadBinarySingle<sizeof(std::uint32_t)>(&s3, sizeof(std::uint8_t));
-          ++bytes;
-          if(s3 < 0x80) {
-            f = (f1 - 0x80) | ((f2 - 0x80) << 7) | ((f3 - 0x80) << 14) | ((f4 - 0x80) << 21) | ((s1 - 0x80) << 28);
-            s = ((s1 - 0x80) >> 4) | ((s2 - 0x80) << 3) | s3 << 10;
-            return bytes;
-          }
-          loadBinarySingle<sizeof(std::uint32_t)>(&s4, sizeof(std::uint8_t));
-          ++bytes;
-          if(s4 < 0x80) {
-            f = (f1 - 0x80) | ((f2 - 0x80) << 7) | ((f3 - 0x80) << 14) | ((f4 - 0x80) << 21) | ((s1 - 0x80) << 28);
-            s = ((s1 - 0x80) >> 4) | ((s2 - 0x80) << 3) | ((s3 - 0x80) << 10) | s4 << 17;
-            return bytes;
-          }
-          loadBinarySingle<sizeof(std::uint32_t)>(&s5, sizeof(std::uint8_t));
-          ++bytes;
-          if(s5 < 0x80) {
-            f = (f1 - 0x80) | ((f2 - 0x80) << 7) | ((f3 - 0x80) << 14) | ((f4 - 0x80) << 21) | ((s1 - 0x80) << 28);
-            s = ((s1 - 0x80) >> 4) | ((s2 - 0x80) << 3) | ((s3 - 0x80) << 10) | ((s4 - 0x80) << 17) | s5 << 24;
-            return bytes;
-          }
-          loadBinarySingle<sizeof(std::uint32_t)>(&s6, sizeof(std::uint8_t));
-          ++bytes;
-          if(s6 < 0x80) {
-            f = (f1 - 0x80) | ((f2 - 0x80) << 7) | ((f3 - 0x80) << 14) | ((f4 - 0x80) << 21) | ((s1 - 0x80) << 28);
-            s = ((s1 - 0x80) >> 4) | ((s2 - 0x80) << 3)  | ((s3 - 0x80) << 10) | ((s4 - 0x80) << 17) | ((s5 - 0x80) << 24) | s6 << 31;
-            return bytes;
-          } else {
-            throw Exception("Too big varint");
+        if(loadVarintDirect(v))
+          return;
+
+        std::uint64_t result = 0;
+        for(std::size_t i = 0; i < extendable_binary_detail::maxVarintSize; ++i) {
+          std::uint8_t byte;
+          loadBinary<sizeof(std::uint8_t)>(&byte, sizeof(std::uint8_t));
+          result |= static_cast<std::uint64_t>(byte & 0x7f) << (7 * i);
+          if(byte < 0x80) {
+            v = static_cast<T>(result);
+            return;
           }
-        };
-        load();
-        if(sizeof(T) == 8) {
-          std::uint64_t final = s;
-          final <<= (sizeof(s)*8);
-          final |= f;
-          std::memcpy(&v, &final, sizeof(T));
-        } else {
-          copyBinarySingleNoSwap<sizeof(s)>(&v, &f, sizeof(T));
         }
+        throw Exception("Too big varint");
       }
 
       //! Load varint from the stream, discard input value
+      /*! Value of varint is not decoded, only its end is found. */
       inline void skipVarint()
       {
-        // TODO can implement faster approach, without interpreting
-        std::uint64_t ignore;
-        loadVarint(ignore);
+        using namespace extendable_binary_detail;
+        if(savedShared.saving.empty()) {
+          std::size_t available;
+          if(const std::uint8_t * data = itsStream.peekMemory(available)) {
+            std::size_t size = 0;
+            if(available >= maxVarintSize) {
+              size = varintSize(data);
+            } else {
+              while(size < available && data[size] >= 0x80)
+                ++size;
+              if(size == available)
+                throw Exception("Failed to read varint from input buffer! Left " + std::to_string(available));
+              ++size;
+            }
+            itsStream.skipMemory(size);
+            return;
+          }
+        }
+
+        for(std::size_t i = 0; i < maxVarintSize; ++i) {
+          std::uint8_t byte;
+          loadBinary<sizeof(std::uint8_t)>(&byte, sizeof(std::uint8_t));
+          if(byte < 0x80)
+            return;
+        }
+        throw Exception("Too big varint");
+      }
+
+      //! Load layout of packed struct from the stream
+      /*! Type tag has to be already loaded.
+          Throws Exception if layout is not valid. */
+      inline void loadPackedLayout(extendable_binary_detail::PackedLayout & layout)
+      {
+        using namespace extendable_binary_detail;
+        std::uint64_t size;
+        std::uint64_t fieldCount;
+        loadVarint(size);
+        loadVarint(fieldCount);
+        if(size == 0 || size > maxPackedStructSize || fieldCount > size)
+          throw Exception("Invalid packed struct layout");
+        layout.size = static_cast<std::size_t>(size);
+        layout.fields.clear();
+        std::size_t next = 0;
+        for(std::uint64_t i = 0; i < fieldCount; ++i) {
+          std::uint8_t info;
+          loadBinary<sizeof(std::uint8_t)>(&info, sizeof(std::uint8_t));
+          const std::uint8_t kind = (info >> 2) & 0x3;
+          PackedField field{next, static_cast<std::uint8_t>(1u << (info & 0x3)), static_cast<PackedFieldKind>(kind)};
+          if(info & 0x10) {
+            std::uint64_t offset;
+            loadVarint(offset);
+            if(offset > layout.size)
+              throw Exception("Invalid packed struct layout");
+            field.offset = static_cast<std::size_t>(offset);
+          }
+          if((info & 0xe0) != 0 || kind > static_cast<std::uint8_t>(PackedFieldKind::floating_point)
+             || field.offset + field.size > layout.size
+             || (field.kind == PackedFieldKind::floating_point && field.size != 4 && field.size != 8))
+            throw Exception("Invalid packed struct layout");
+          next = field.offset + field.size;
+          layout.fields.push_back(field);
+        }
+      }
+
+      //! Load packed structs from the stream
+      /*! Layout of saved structs has to be already loaded with loadPackedLayout().
+          If layouts are the same and bytes don't have to be swapped data is loaded at once.
+          Otherwise fields are matched by order of serialization, fields which were not saved
+          are not modified and saved fields not present in layout are skipped.
+          @param layout layout of structs being loaded
+          @param saved layout of saved structs
+          @param dest address of first struct
+          @param count number of structs */
+      void loadPackedStructs(extendable_binary_detail::PackedLayout const & layout,
+                             extendable_binary_detail::PackedLayout const & saved,
+                             void * dest, std::size_t count)
+      {
+        using namespace extendable_binary_detail;
+        std::uint8_t * out = reinterpret_cast<std::uint8_t *>(dest);
+        if(false == itsConvertEndianness && layout == saved) {
+          loadBinary<sizeof(std::uint8_t)>(out, count * layout.size);
+          return;
+        }
+        std::vector<std::uint8_t> element(saved.size);
+        const std::size_t mapped = std::min(layout.fields.size(), saved.fields.size());
+        for(std::size_t i = 0; i < count; ++i, out += layout.size) {
+          loadBinary<sizeof(std::uint8_t)>(element.data(), saved.size);
+          if(itsConvertEndianness) {
+            for(auto const & field : saved.fields) {
+              std::reverse(element.data() + field.offset, element.data() + field.offset + field.size);
+            }
+          }
+          for(std::size_t j = 0; j < mapped; ++j) {
+            convertPackedField(element.data() + saved.fields[j].offset, saved.fields[j],
+                               out + layout.fields[j].offset, layout.fields[j]);
+          }
+        }
       }
 
       //! Load metadata of new object
@@ -693,6 +1295,9 @@ namespace cereal
             throw Exception("Unexpected type expected class or pointer, got:" + std::to_string(static_cast<int>(type.first)));
           }
         }
+        if(itsLengthPrefixedObjects && false == emptyClass) {
+          itsObjects.push_back(loadObjectLength());
+        }
       }
 
       //! Read all remaining data from current object
@@ -702,6 +1307,17 @@ namespace cereal
       {
         if(emptyClass) {
           // empty class or shared pointer with object which was already saved
+        } else if(itsLengthPrefixedObjects) {
+          if(itsObjects.empty())
+            throw Exception("Unexpected end of object");
+          const ObjectFrame object = itsObjects.back();
+          itsObjects.pop_back();
+          if(object.hasDefinitions) {
+            loadTypeTag();
+            loadEndOfClass(true);
+          } else {
+            skipToObjectEnd(object);
+          }
         } else {
           loadTypeTag();
           loadEndOfClass(true);
@@ -759,37 +1375,141 @@ namespace cereal
 
     private:
 
-      //! Struct to keep information of already loaded but skipped shared pointers
-      struct SavedShared {
-        //! Map with shared pointers for which data is being read
-        /*! Key - object id, value - position in stream
-            Note that end position in value is not yet set. */
-        std::vector<std::pair<std::uint32_t, extendable_binary_detail::StreamPos>> saving;
-        //! Map with shared pointers for which data is available in internal buffer
-        /*! Key - object id, value - position in stream */
-        std::map<std::uint32_t, extendable_binary_detail::StreamPos> saved;
-        std::set<std::uint32_t> loaded; //!< Loaded shared pointers' object ids
-      };
-
-      //! Reset current object metadata
-      inline void resetObjectDetails()
+      //! Forgets state of previous archive and loads header of new one
+      inline void resetState()
       {
-        // should be reset on all fields?
-        classVersion = 0;
-        emptyClass = false;
-        objectId = 0;
-        polymorphicId = 0;
-        polymorphicName.clear();
+        resetObjectDetails();
+        lastSizeTag = 0;
+        lastTypeTag = {extendable_binary_detail::FieldType::last_field, 0};
+        savedShared.saving.clear();
+        savedShared.saved.clear();
+        itsObjects.clear();
+        itsSkippedDataSize = 0;
+        resetTracking();
+        loadHeader();
       }
 
-      //! Load object metadata from input stream
-      inline void loadClassData(std::uint8_t classMarkers)
+      //! Load archive header from input
+      inline void loadHeader()
       {
         using namespace extendable_binary_detail;
-        ClassMarkers markers = static_cast<ClassMarkers>(classMarkers);
-        if(markers & ClassMarkers::EmptyClass) {
-          emptyClass = true;
-        }
+        std::uint8_t header;
+        this->loadBinary<sizeof(std::uint8_t)>( &header, sizeof(std::uint8_t));
+        const std::uint8_t knownFlags = static_cast<std::uint8_t>(HeaderFlags::LittleEndian)
+                                        | static_cast<std::uint8_t>(HeaderFlags::LengthPrefixedObjects)
+                                        | static_cast<std::uint8_t>(HeaderFlags::DeltaEncodedKeys)
+                                        | static_cast<std::uint8_t>(HeaderFlags::PackedBits);
+        if(header & ~knownFlags)
+          throw Exception("Unsupported archive header: " + std::to_string(static_cast<int>(header)));
+        const std::uint8_t streamLittleEndian = (header & HeaderFlags::LittleEndian) != 0;
+        itsConvertEndianness = itsOptions.is_little_endian() ^ streamLittleEndian;
+        itsLengthPrefixedObjects = (header & HeaderFlags::LengthPrefixedObjects) != 0;
+        itsDeltaEncodedKeys = (header & HeaderFlags::DeltaEncodedKeys) != 0;
+        itsPackedBits = (header & HeaderFlags::PackedBits) != 0;
+        itsIgnoreUnknownPolymorphicTypes = itsOptions.itsIgnoreUnknownPolymorphicTypes;
+      }
+
+      //! Gets size bytes directly from input memory buffer
+      /*! @return address of data or nullptr if archive doesn't read from memory buffer
+                  or data has to be copied for skipped shared object.
+          Throws Exception if there are less than size bytes available. */
+      inline const std::uint8_t * readDirect(std::size_t size)
+      {
+        if(false == savedShared.saving.empty())
+          return nullptr;
+        return itsStream.readMemory(size);
+      }
+
+      //! Load varint directly from input memory buffer
+      /*! @return false if archive doesn't read from memory buffer, v is not modified then.
+          Throws Exception if varint is too big or buffer ends before end of varint. */
+      template <class T>
+      inline bool loadVarintDirect(T& v)
+      {
+        using namespace extendable_binary_detail;
+        if(false == savedShared.saving.empty())
+          return false;
+        std::size_t available;
+        const std::uint8_t * data = itsStream.peekMemory(available);
+        if(data == nullptr)
+          return false;
+
+        if(available >= maxVarintSize) {
+          std::uint64_t result;
+          itsStream.skipMemory(decodeVarint(data, result));
+          v = static_cast<T>(result);
+          return true;
+        }
+
+        // end of buffer, byte by byte
+        std::uint64_t result = 0;
+        for(std::size_t i = 0; i < available; ++i) {
+          result |= static_cast<std::uint64_t>(data[i] & 0x7f) << (7 * i);
+          if(data[i] < 0x80) {
+            itsStream.skipMemory(i + 1);
+            v = static_cast<T>(result);
+            return true;
+          }
+        }
+        throw Exception("Failed to read varint from input buffer! Left " + std::to_string(available));
+      }
+
+      //! Struct to keep information of already loaded but skipped shared pointers
+      struct SavedShared {
+        //! Shared pointer for which data is being copied
+        struct Saving
+        {
+          std::uint32_t objectId;
+          std::size_t start; //!< start of data in skipped data arena
+          int classDepth; //!< depth at which object ends
+        };
+
+        //! Shared pointer for which data is available in skipped data arena
+        struct Saved
+        {
+          std::uint32_t objectId;
+          extendable_binary_detail::StreamPos range; //!< position in skipped data arena
+          bool loaded; //!< if object was loaded, data is not needed then
+        };
+
+        //! Finds skipped shared pointer
+        /*! @return saved pointer data or nullptr if object with objectId was not skipped */
+        Saved * find(std::uint32_t objectId)
+        {
+          auto it = lowerBound(objectId);
+          return it != saved.end() && it->objectId == objectId ? &*it : nullptr;
+        }
+
+        //! Gets first saved pointer with object id not less than objectId
+        std::vector<Saved>::iterator lowerBound(std::uint32_t objectId)
+        {
+          return std::lower_bound(saved.begin(), saved.end(), objectId,
+                                  [](Saved const & s, std::uint32_t id) { return s.objectId < id; });
+        }
+
+        std::vector<Saving> saving; //!< Stack of shared pointers for which data is being copied
+        std::vector<Saved> saved; //!< Shared pointers which data was copied, sorted by object id
+      };
+
+      //! Reset current object metadata
+      inline void resetObjectDetails()
+      {
+        // should be reset on all fields?
+        classVersion = 0;
+        emptyClass = false;
+        objectId = 0;
+        polymorphicId = 0;
+        polymorphicName.clear();
+      }
+
+      //! Load object metadata from input stream
+      inline void loadClassData(std::uint8_t classMarkers)
+      {
+        using namespace extendable_binary_detail;
+        ClassMarkers markers = static_cast<ClassMarkers>(classMarkers);
+        if(markers & ClassMarkers::EmptyClass) {
+          emptyClass = true;
+        }
         if(markers & ClassMarkers::HasVersion) {
           loadVarint(classVersion);
         }
@@ -798,38 +1518,43 @@ namespace cereal
       //! Load shared pointer from stream
       void loadSharedPointer()
       {
-        const auto normalObjectId = objectId & ~detail::msb_32bit;
-        const auto wasSkipped = savedShared.saved.find(normalObjectId);
         // usual path
-        if(wasSkipped == savedShared.saved.end())
+        if(savedShared.saved.empty())
+          return;
+
+        const auto normalObjectId = objectId & ~detail::msb_32bit;
+        auto * const wasSkipped = savedShared.find(normalObjectId);
+        if(wasSkipped == nullptr)
           return;
 
         const bool isNewObjectInStream = (objectId & detail::msb_32bit) != 0;
-        const auto alreadyLoaded = savedShared.loaded.find(normalObjectId);
         if (false == isNewObjectInStream) {
           /* Object was not loaded before according to stream order. */
-          if (alreadyLoaded == savedShared.loaded.end()) {
-            // TODO we can delete it here (if we made a copy)
-            savedShared.loaded.emplace(normalObjectId);
+          if (false == wasSkipped->loaded) {
+            wasSkipped->loaded = true;
             // we change objectId to indicate that we want to load it now
             objectId = objectId | detail::msb_32bit;
-            pushLoadShared(wasSkipped->second);
+            // copied data is released when it's read
+            itsStream.pushReadingPos(wasSkipped->range);
             emptyClass = false; // unneeded redundancy?
           }
-        } else if (alreadyLoaded == savedShared.loaded.end()) {
+        } else if (false == wasSkipped->loaded) {
           /* NewObjectInStream, was skipped and not loaded before.
            * Here we are loading it with stream order (stream indicates that it's new object) so there's no need to
            * push additional stream position, it is naturally next in stream.
            * We just have to mark that that object is now being loaded so we don't load it again and make duplicate with
-           * different address. */
-          savedShared.loaded.emplace(normalObjectId);
-        } else if (alreadyLoaded != savedShared.loaded.end()) {
+           * different address. Copied data won't be needed. */
+          wasSkipped->loaded = true;
+          itsStream.releaseSharedRange(wasSkipped->range);
+        } else {
           /* NewObjectInStream, was skipped but was loaded before.
            * We don't want to load it for the second time. We have move forward in the stream to the end of object. */
           objectId = normalObjectId;
           emptyClass = true;
           // move forward
-          itsStream.skipData(wasSkipped->second.end - wasSkipped->second.start);
+          const auto size = static_cast<std::size_t>(wasSkipped->range.end - wasSkipped->range.start);
+          itsSkippedDataSize += size;
+          itsStream.skipData(size);
         }
       }
 
@@ -859,24 +1584,23 @@ namespace cereal
                                           nameSize * sizeof(char_type));
             // TODO change to uint8_t (may not match on sending side)
             // normally it would be multiply by one, but on other platforms we could just have problems
+            /* Registered here so binding for id can be checked below. If pointer is skipped
+             * name would've not been registered otherwise. */
+            registerPolymorphicName(polymorphicId, polymorphicName);
           } else if(noPolymorphicCast) {
             return;
-          } else {
-            polymorphicName = getPolymorphicName(polymorphicId);
           }
           if (itsIgnoreUnknownPolymorphicTypes &&
               false == emptyClass &&
-              false == polymorphic_detail::hasPolymorphicBinding<ExtendableBinaryInputArchive>(polymorphicName)
+              false == polymorphic_detail::hasPolymorphicBinding(*this, polymorphicId)
               ) {
-            if(isNewId) {
-              /* We will skip pointer loading do name would've not been registered.
-               * note: resetObjectDetails will reset name and id */
-              registerPolymorphicName(polymorphicId, polymorphicName);
-            }
+            // note: resetObjectDetails will reset name and id
             resetObjectDetails();
             emptyClass = true;
-            loadTypeTag();
-            loadEndOfClass(true);
+            if(false == skipObjectWithLength()) {
+              loadTypeTag();
+              loadEndOfClass(true);
+            }
           }
         }
       }
@@ -925,17 +1649,18 @@ namespace cereal
             }
             case FieldType::class_t: {
               ClassMarkers markers = static_cast<ClassMarkers>(type.second);
-              if(false == (markers & ClassMarkers::EmptyClass)) {
-                ++class_depth;
-              }
               if(markers & ClassMarkers::HasVersion) {
                 skipVarint();
               }
+              if(false == (markers & ClassMarkers::EmptyClass) && false == skipObjectWithLength()) {
+                ++class_depth;
+              }
               break;
             }
             case FieldType::pointer: {
               PointerMarkers markers = static_cast<PointerMarkers>(type.second);
-              if(false == (markers & PointerMarkers::Empty)) {
+              const bool hasFields = false == (markers & PointerMarkers::Empty);
+              if(hasFields) {
                 ++class_depth;
               }
               if(markers & PointerMarkers::IsSharedPtr) {
@@ -962,6 +1687,13 @@ namespace cereal
                    * If polymorphic pointer of the same class is saved later class name would be unknown since class name is saved only once. */
                 }
               }
+              if(hasFields && skipObjectWithLength()) {
+                // whole object including its end marker was skipped
+                if(isSkippedSharedObjectEnd(class_depth)) {
+                  popSaveShared();
+                }
+                --class_depth;
+              }
               break;
             }
             case FieldType::packed_array: {
@@ -971,7 +1703,30 @@ namespace cereal
               break;
             }
             case FieldType::packed_struct: {
-              throw Exception("packed_struct is not supported yet");
+              PackedLayout layout;
+              loadPackedLayout(layout);
+              std::uint64_t count = 1;
+              if(type.second & PackedStructMarkers::IsArray) {
+                loadVarint(count);
+              }
+              if(count > std::numeric_limits<std::size_t>::max() / layout.size) {
+                throw Exception("Packed struct array size is too big");
+              }
+              skipData(static_cast<std::size_t>(count) * layout.size);
+              break;
+            }
+            case FieldType::integer_array: {
+              skipVarint();
+              std::size_t size;
+              loadVarint(size);
+              skipData(size);
+              break;
+            }
+            case FieldType::bit_array: {
+              std::uint64_t count;
+              loadVarint(count);
+              skipData(static_cast<std::size_t>(bitArraySize(count)));
+              break;
             }
             case FieldType::size_tag: {
               /* We need to load size tag because it can be needed to load BinaryData (packed_array) later */
@@ -989,20 +1744,60 @@ namespace cereal
         } while(class_depth > 0);
       }
 
+      //! Object loaded with length for which fields are being loaded
+      struct ObjectFrame
+      {
+        std::size_t end; //!< position of end of object data in source
+        std::size_t source; //!< source of data in which object is saved, @see StreamAdapter::source()
+        bool hasDefinitions; //!< if object data has to be read field by field when skipped
+      };
+
+      //! Load length of object data saved after object metadata
+      inline ObjectFrame loadObjectLength()
+      {
+        std::uint64_t value;
+        loadVarint(value);
+        const std::uint64_t length = value >> 1;
+        const std::size_t position = itsStream.position();
+        if(length > std::numeric_limits<std::size_t>::max() - position)
+          throw Exception("Object length is too big");
+        return {position + static_cast<std::size_t>(length), itsStream.source(), (value & 1) != 0};
+      }
+
+      //! Skips remaining data of object, including end of object marker
+      inline void skipToObjectEnd(ObjectFrame const & object)
+      {
+        const std::size_t position = itsStream.position();
+        if(object.source != itsStream.source() || position > object.end)
+          throw Exception("Object data doesn't match its length");
+        skipData(object.end - position);
+      }
+
+      //! Skips data of object which metadata was just loaded, if archive has length prefixed objects
+      /*! Data is skipped at once if it doesn't have definitions which may be needed later in stream.
+          For skipped shared objects data is copied at once.
+          @return true if data was skipped, false if it has to be skipped field by field */
+      inline bool skipObjectWithLength()
+      {
+        if(false == itsLengthPrefixedObjects)
+          return false;
+        const ObjectFrame object = loadObjectLength();
+        if(object.hasDefinitions)
+          return false;
+        skipToObjectEnd(object);
+        return true;
+      }
+
       inline void pushSaveShared(std::uint32_t skippedObjectId, int classDepth)
       {
-        savedShared.saving.emplace_back(
-            std::make_pair(skippedObjectId,
-                           extendable_binary_detail::StreamPos{sharedObjectStream.tellp(),
-                                                               static_cast<std::streamoff>(classDepth)
-                           }));
+        savedShared.saving.push_back({skippedObjectId, itsStream.beginSharedRange(), classDepth});
       }
 
       /** Called at the end of shared object loading */
       inline bool isSkippedSharedObjectEnd(int classDepth)
       {
         return false == savedShared.saving.empty()
-               && savedShared.saving.back().second.end == static_cast<std::streamoff>(classDepth);
+               && savedShared.saving.back().classDepth == classDepth;
       }
 
       /** End of saving skipped shared object */
@@ -1010,17 +1805,18 @@ namespace cereal
       {
         if (savedShared.saving.empty()) // maybe check earlier
           throw Exception("unexpected end of shared object");
-        auto &last = savedShared.saving.back();
-        last.second.end = sharedObjectStream.tellp();
-        savedShared.saved.emplace(last.first, last.second);
+        auto const & last = savedShared.saving.back();
+        auto const range = itsStream.endSharedRange(last.start);
+        auto it = savedShared.lowerBound(last.objectId);
+        if (it != savedShared.saved.end() && it->objectId == last.objectId) {
+          // data of object is already available
+          itsStream.releaseSharedRange(range);
+        } else {
+          savedShared.saved.insert(it, {last.objectId, range, false});
+        }
         savedShared.saving.pop_back();
       }
 
-      inline void pushLoadShared(extendable_binary_detail::StreamPos &pos)
-      {
-        itsStream.pushReadingPos(pos);
-      }
-
 
     private:
       std::uint32_t classVersion = 0; //!< class version of current object
@@ -1034,14 +1830,152 @@ namespace cereal
           {extendable_binary_detail::FieldType::last_field, 0};
 
       SavedShared savedShared; //!< struct with skipped shared pointers mapping
-      std::stringstream sharedObjectStream; //!<
+      std::vector<ObjectFrame> itsObjects; //!< Stack of objects loaded with length
+      std::size_t itsSkippedDataSize = 0; //!< Number of bytes skipped, see skippedDataSize()
       extendable_binary_detail::StreamAdapter itsStream;
+      const Options itsOptions; //!< Options used to load header of every archive, see reset()
 
       uint8_t itsConvertEndianness; //!< If set to true, we will need to swap bytes upon loading
+      bool itsLengthPrefixedObjects = false; //!< If length of object data is saved before its fields
+      bool itsDeltaEncodedKeys = false; //!< If keys of ordered containers are saved as one integer array
+      bool itsPackedBits = false; //!< If std::vector<bool> and std::bitset are saved as packed bits
       //! If set to true, polymorphic pointers of unknown type will be loaded as nullptr
       bool itsIgnoreUnknownPolymorphicTypes;
   };
 
+  // ######################################################################
+  //! Pool of ExtendableBinary archives reused for many small messages
+  /*! Archives taken from pool are reset() instead of being constructed, so memory of their
+      buffers and tracking tables is allocated only once. Archive is returned to the pool when
+      Handle is destroyed, output archive is flushed then (errors are not reported, same as in
+      archive destructor). Taking archive while other one is used, e.g. when message is saved
+      inside of serialization function, creates additional archive.
+
+      Pool is not thread safe, it should be used by one thread, see thread_local_archive_pool().
+
+      @code{cpp}
+      auto ar = cereal::thread_local_archive_pool<cereal::ExtendableBinaryOutputArchive>().acquire(stream);
+      ar(message);
+      @endcode
+
+      @tparam Archive ExtendableBinaryOutputArchive or ExtendableBinaryInputArchive
+      \ingroup Archives */
+  template <class Archive>
+  class ExtendableBinaryArchivePool
+  {
+    public:
+      //! Archive taken from pool, returned to it when destroyed
+      class Handle
+      {
+        public:
+          Handle(Handle && other) CEREAL_NOEXCEPT :
+            itsPool(other.itsPool), itsArchive(std::move(other.itsArchive))
+          { }
+
+          Handle(Handle const &) = delete;
+          Handle & operator=(Handle const &) = delete;
+          Handle & operator=(Handle &&) = delete;
+
+          //! Returns archive to pool
+          ~Handle() CEREAL_NOEXCEPT
+          {
+            if(itsArchive)
+              itsPool->release(std::move(itsArchive));
+          }
+
+          //! Serializes all passed in data
+          template <class ... Types> inline
+          Archive & operator()(Types && ... args)
+          {
+            return (*itsArchive)(std::forward<Types>(args)...);
+          }
+
+          Archive & operator*() const { return *itsArchive; }
+          Archive * operator->() const { return itsArchive.get(); }
+
+        private:
+          friend class ExtendableBinaryArchivePool;
+
+          Handle(ExtendableBinaryArchivePool * pool, std::unique_ptr<Archive> archive) :
+            itsPool(pool), itsArchive(std::move(archive))
+          { }
+
+          ExtendableBinaryArchivePool * itsPool; //!< pool to which archive is returned
+          std::unique_ptr<Archive> itsArchive;
+      };
+
+      //! Construct empty pool
+      /*! @param options options of all archives created by pool */
+      explicit ExtendableBinaryArchivePool(typename Archive::Options const & options = Archive::Options::Default()) :
+        itsOptions(options)
+      { }
+
+      ExtendableBinaryArchivePool(ExtendableBinaryArchivePool const &) = delete;
+      ExtendableBinaryArchivePool & operator=(ExtendableBinaryArchivePool const &) = delete;
+
+      //! Gets archive saving to or loading from source
+      /*! @param source arguments of archive constructor without options: stream, or memory buffer and its size
+                        for input archive
+          Throws Exception if header of input archive cannot be loaded */
+      template <class ... Source>
+      Handle acquire(Source && ... source)
+      {
+        if(itsFree.empty())
+          return Handle(this, std::unique_ptr<Archive>(new Archive(std::forward<Source>(source)..., itsOptions)));
+        std::unique_ptr<Archive> archive = std::move(itsFree.back());
+        itsFree.pop_back();
+        try {
+          archive->reset(std::forward<Source>(source)...);
+        } catch(...) {
+          itsFree.push_back(std::move(archive));
+          throw;
+        }
+        return Handle(this, std::move(archive));
+      }
+
+      //! Number of archives waiting in pool
+      std::size_t size() const
+      {
+        return itsFree.size();
+      }
+
+    private:
+      //! Puts archive back to pool
+      void release(std::unique_ptr<Archive> archive) CEREAL_NOEXCEPT
+      {
+        finish(*archive);
+        try {
+          itsFree.push_back(std::move(archive));
+        } catch(...) {
+        }
+      }
+
+      //! Writes buffered data of output archive
+      static void finish(ExtendableBinaryOutputArchive & ar) CEREAL_NOEXCEPT
+      {
+        try {
+          ar.flush();
+        } catch(...) {
+        }
+      }
+
+      static void finish(ExtendableBinaryInputArchive &) CEREAL_NOEXCEPT
+      { }
+
+      typename Archive::Options itsOptions; //!< options of created archives
+      std::vector<std::unique_ptr<Archive>> itsFree; //!< archives not used now
+  };
+
+  //! Gets pool of archives with default options owned by calling thread
+  /*! Pool with other options can be declared as thread_local variable of ExtendableBinaryArchivePool type.
+      @tparam Archive ExtendableBinaryOutputArchive or ExtendableBinaryInputArchive */
+  template <class Archive> inline
+  ExtendableBinaryArchivePool<Archive> & thread_local_archive_pool()
+  {
+    static thread_local ExtendableBinaryArchivePool<Archive> pool;
+    return pool;
+  }
+
   // ######################################################################
   // Common ExtendableBinaryArchive serialization functions
 
@@ -1051,8 +1985,7 @@ namespace cereal
   CEREAL_SAVE_FUNCTION_NAME(ExtendableBinaryOutputArchive & ar, T const & t)
   {
     using namespace extendable_binary_detail;
-    std::uint8_t v = writeType(FieldType::integer_packed, (t ? 1 : 0));
-    ar.template saveBinary<sizeof(std::uint8_t)>(&v, sizeof(std::uint8_t));
+    ar.saveTypeTag(FieldType::integer_packed, (t ? 1 : 0));
     // sizeof bool is implementation defined
   }
 
@@ -1079,16 +2012,14 @@ namespace cereal
     using unsigned_type = typename std::make_unsigned<T>::type;
     // can be stored in the same byte as type
     if( t <= 0xf && t >= 0 ) {
-      std::uint8_t v = writeType(FieldType::integer_packed, static_cast<std::uint8_t>(t));
-      ar.template saveBinary<sizeof(std::uint8_t)>(&v, sizeof(v));
+      ar.saveTypeTag(FieldType::integer_packed, static_cast<std::uint8_t>(t));
     } else {
       // note that abs of minimal value for signed type may not to stored the same signed type
       // http://stackoverflow.com/questions/17313579/is-there-a-safe-way-to-get-the-unsigned-absolute-value-of-a-signed-integer-with
       const unsigned_type absolute = t >= 0 ? t : -static_cast<unsigned_type>(t);
       const auto neededBytes = getIntSizeTagFromByteCount(getHighestBit(absolute));
       const auto fieldType = t >= 0 ? FieldType::positive_integer : FieldType::negative_integer;
-      std::uint8_t v = writeType(fieldType, neededBytes);
-      ar.template saveBinary<sizeof(std::uint8_t)>(&v, sizeof(v));
+      ar.saveTypeTag(fieldType, neededBytes);
       ar.saveBinarySingle<sizeof(T)>(std::addressof(absolute), neededBytes);
     }
   }
@@ -1145,8 +2076,7 @@ namespace cereal
                    "Extendable binary only supports IEEE 754 standardized floating point" );
     using namespace extendable_binary_detail;
     std::uint8_t floatSize = getTagSizeFromFloatType<T>();
-    std::uint8_t v = writeType(FieldType::floating_point, floatSize);
-    ar.template saveBinary<sizeof(std::uint8_t)>(&v, sizeof(std::uint8_t));
+    ar.saveTypeTag(FieldType::floating_point, floatSize);
     if (t == t) {
       ar.template saveBinary<sizeof(T)>(std::addressof(t), sizeof(t));
     } else {
@@ -1209,8 +2139,7 @@ namespace cereal
     }
     const auto neededBytes = getIntSizeTagFromByteCount(getHighestBit(t.size));
     const auto fieldType = FieldType::size_tag;
-    std::uint8_t v = writeType(fieldType, neededBytes);
-    ar.template saveBinary<sizeof(std::uint8_t)>(&v, sizeof(v));
+    ar.saveTypeTag(fieldType, neededBytes);
     ar.saveBinarySingle<sizeof(T)>(std::addressof(t.size), static_cast<std::size_t>(neededBytes));
   }
 
@@ -1238,8 +2167,7 @@ namespace cereal
   void CEREAL_SAVE_FUNCTION_NAME(ExtendableBinaryOutputArchive & ar, OmittedFieldTag const &)
   {
     using namespace extendable_binary_detail;
-    std::uint8_t v = writeType(FieldType::omitted_field, 0);
-    ar.template saveBinary<sizeof(std::uint8_t)>(&v, sizeof(std::uint8_t));
+    ar.saveTypeTag(FieldType::omitted_field, 0);
   }
 
   //! Loading OmittedFieldTag from ExtendableBinary archive
@@ -1249,20 +2177,41 @@ namespace cereal
     ar.loadOmittedObject();
   }
 
+  namespace extendable_binary_detail
+  {
+    //! Saves array of integers in compressed form, @see ExtendableBinaryOutputArchive::saveIntegerArray()
+    /*! Arrays of single byte integers are not compressed */
+    template <class T> inline
+    bool saveIntegerArray(ExtendableBinaryOutputArchive & ar, const T * data, std::size_t count,
+                          typename std::enable_if<is_compressible_integer<T>::value && (sizeof(T) > 1)>::type * = nullptr)
+    {
+      return ar.saveIntegerArray<T>(data, count, [](T value) { return value; }, true);
+    }
+
+    //! Arrays of other types are saved as raw memory
+    template <class T> inline
+    bool saveIntegerArray(ExtendableBinaryOutputArchive &, const T *, std::size_t,
+                          typename std::enable_if<!is_compressible_integer<T>::value || (sizeof(T) == 1)>::type * = nullptr)
+    {
+      return false;
+    }
+  } // namespace extendable_binary_detail
+
   //! Saving binary data to ExtendableBinary archive
   template <class T> inline
   void CEREAL_SAVE_FUNCTION_NAME(ExtendableBinaryOutputArchive & ar, BinaryData<T> const & bd)
   {
     using TT = typename std::remove_pointer<T>::type;
     using namespace extendable_binary_detail;
+    if(ar.compressesIntegerArrays() && saveIntegerArray(ar, reinterpret_cast<const TT *>(bd.data), static_cast<std::size_t>(bd.size) / sizeof(TT)))
+      return;
     std::uint8_t packedSizeOfElem;
     if(sizeof(TT) < 0xf) {
       packedSizeOfElem = sizeof(TT);
     } else {
       packedSizeOfElem = 0xf;
     }
-    std::uint8_t v = writeType(FieldType::packed_array, packedSizeOfElem);
-    ar.template saveBinary<sizeof(std::uint8_t)>(&v, sizeof(std::uint8_t));
+    ar.saveTypeTag(FieldType::packed_array, packedSizeOfElem);
     if(sizeof(TT) >= 0xf) {
       ar.saveVarint(sizeof(TT));
     }
@@ -1271,6 +2220,62 @@ namespace cereal
     ar.template saveBinary<sizeof(TT)>( bd.data, static_cast<std::size_t>( bd.size ) );
   }
 
+  namespace extendable_binary_detail
+  {
+    //! Loads size of element and number of elements of packed array
+    /*! Type tag has to be already loaded.
+        Throws Exception if size of element doesn't match TT.
+        @param ar archive to load from
+        @param typeInfo field specific part of type tag
+        @tparam TT type of element
+        @return size of packed array data in bytes */
+    template <class TT> inline
+    std::uint64_t loadPackedArraySize(ExtendableBinaryInputArchive & ar, std::uint8_t typeInfo)
+    {
+      std::uint64_t sizeOfElem;
+      if(typeInfo == 0xf) {
+        ar.loadVarint(sizeOfElem);
+      } else {
+        sizeOfElem = typeInfo;
+      }
+      if(sizeof(TT) != sizeOfElem) {
+        // We could allow mismatch here, only problem would be how to make endian swap
+        throw Exception("Wrong dest type size, expected:" + std::to_string(sizeOfElem) + " got:" + std::to_string(sizeof(TT)));
+      }
+      std::uint64_t numberOfElements;
+      ar.loadVarint(numberOfElements);
+      if(numberOfElements > std::numeric_limits<std::uint64_t>::max() / sizeOfElem) {
+        throw Exception("Packed array size is too big");
+      }
+      return numberOfElements * sizeOfElem;
+    }
+
+    //! Loads FieldType::integer_array to array of integers, @see ExtendableBinaryInputArchive::loadIntegerArray()
+    template <class T> inline
+    std::size_t loadIntegerArray(ExtendableBinaryInputArchive & ar, std::uint8_t typeInfo, T * data, std::size_t capacity,
+                                 typename std::enable_if<is_compressible_integer<T>::value>::type * = nullptr)
+    {
+      return ar.loadIntegerArray<T>(typeInfo, capacity, [&data](T value) { *data++ = value; });
+    }
+
+    //! Integer array can't be loaded to array of other types
+    template <class T> inline
+    std::size_t loadIntegerArray(ExtendableBinaryInputArchive &, std::uint8_t, T *, std::size_t,
+                                 typename std::enable_if<!is_compressible_integer<T>::value>::type * = nullptr)
+    {
+      throw Exception("Integer array can't be loaded to array of non integer type");
+    }
+
+    //! Destination of packed array loaded in place
+    /*! Used by ArrayView loading, @see loadBinaryView() */
+    template <class T>
+    struct PackedArrayView
+    {
+      ArrayView<T> & view;
+      std::size_t size; //!< number of elements announced by size tag
+    };
+  } // namespace extendable_binary_detail
+
   //! Loading binary data from extendable binary
   /*! Size of array is saved as varint. Apart from tag, size of element is saved. */
   template <class T> inline
@@ -1278,28 +2283,921 @@ namespace cereal
   {
     typedef typename std::remove_pointer<T>::type TT;
     using namespace extendable_binary_detail;
-    const auto type = ar.getTypeTag<FieldType::packed_array>();
-    if(type.first == FieldType::omitted_field)
+    const auto type = ar.getTypeTagNoError<FieldType::packed_array>();
+    if(type.first == FieldType::integer_array) {
+      loadIntegerArray(ar, type.second, reinterpret_cast<TT *>(bd.data), static_cast<std::size_t>(bd.size) / sizeof(TT));
       return;
-    std::uint64_t sizeOfElem;
-    if(type.second == 0xf) {
-      ar.loadVarint(sizeOfElem);
-    } else {
-      sizeOfElem = type.second;
-    }
-    if(sizeof(TT) != sizeOfElem) {
-      // We could allow mismatch here, only problem would be how to make endian swap
-      throw Exception("Wrong dest type size, expected:" + std::to_string(sizeOfElem) + " got:" + std::to_string(sizeof(TT)));
     }
-    std::uint64_t numberOfElements;
-    ar.loadVarint(numberOfElements);
-    std::uint64_t wholeSize = numberOfElements * sizeOfElem;
+    ar.getTypeTag<FieldType::packed_array>();
+    if(type.first == FieldType::omitted_field)
+      return;
+    const std::uint64_t wholeSize = loadPackedArraySize<TT>(ar, type.second);
     if( wholeSize > bd.size )  {
       throw Exception("BinaryData is bigger than dest var");
     }
     ar.template loadBinary<sizeof(TT)>( bd.data, wholeSize );
   }
 
+  //! Loading packed array in place from ExtendableBinary archive
+  /*! View points to input buffer if possible, otherwise data is copied. */
+  template <class T> inline
+  void CEREAL_LOAD_FUNCTION_NAME(ExtendableBinaryInputArchive & ar, extendable_binary_detail::PackedArrayView<T> & pv)
+  {
+    using namespace extendable_binary_detail;
+    const auto type = ar.getTypeTagNoError<FieldType::packed_array>();
+    if(type.first == FieldType::integer_array) {
+      // compressed data has to be decoded, view can't point to input buffer
+      if(loadIntegerArray(ar, type.second, pv.view.allocate(pv.size), pv.size) != pv.size)
+        throw Exception("Packed array size doesn't match size tag");
+      return;
+    }
+    ar.getTypeTag<FieldType::packed_array>();
+    if(type.first == FieldType::omitted_field) {
+      pv.view.assign(nullptr, 0);
+      return;
+    }
+    const std::uint64_t wholeSize = loadPackedArraySize<T>(ar, type.second);
+    if( wholeSize != pv.size * sizeof(T) ) {
+      throw Exception("Packed array size doesn't match size tag");
+    }
+    const std::size_t size = static_cast<std::size_t>(wholeSize);
+    if(const void * data = ar.template loadBinaryView<sizeof(T), alignof(T)>( size )) {
+      pv.view.assign(reinterpret_cast<const T *>(data), pv.size);
+    } else {
+      ar.template loadBinary<sizeof(T)>( pv.view.allocate(pv.size), size );
+    }
+  }
+
+  //! Loading ArrayView from ExtendableBinary archive
+  /*! If archive reads from memory buffer view points into it, @see ExtendableBinaryInputArchive::loadBinaryView() */
+  template <class T> inline
+  void CEREAL_LOAD_FUNCTION_NAME(ExtendableBinaryInputArchive & ar, ArrayView<T> & view)
+  {
+    size_type size = 0;
+    ar( make_size_tag( size ) );
+    if(size > std::numeric_limits<std::size_t>::max() / sizeof(T))
+      throw Exception("Packed array size is too big");
+    extendable_binary_detail::PackedArrayView<T> pv{view, static_cast<std::size_t>(size)};
+    ar( pv );
+  }
+
+  namespace extendable_binary_detail
+  {
+    //! Archive used to find layout of packed struct
+    /*! Serialization function of struct is called for default constructed object and
+        position of every arithmetic field in the object is recorded. */
+    class PackedLayoutArchive : public OutputArchive<PackedLayoutArchive, AllowEmptyClassElision>
+    {
+      public:
+        //! Construct archive recording fields of object
+        /*! @param object address of object which will be serialized
+            @param size size of object */
+        PackedLayoutArchive(const void * object, std::size_t size) :
+          OutputArchive<PackedLayoutArchive, AllowEmptyClassElision>(this),
+          itsObject(reinterpret_cast<const std::uint8_t *>(object)),
+          itsLayout{size, {}}
+        { }
+
+        //! Records field of object
+        template <class T> inline
+        void addField(T const & t)
+        {
+          static_assert(!std::is_floating_point<T>::value || sizeof(T) == 4 || sizeof(T) == 8,
+                        "only float and double are supported in packed struct");
+          static_assert(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8,
+                        "unsupported size of field in packed struct");
+          const std::uint8_t * field = reinterpret_cast<const std::uint8_t *>(std::addressof(t));
+          if(field < itsObject || field + sizeof(T) > itsObject + itsLayout.size)
+            throw Exception("Packed struct can have only its own members as fields");
+          const PackedFieldKind kind = std::is_floating_point<T>::value ? PackedFieldKind::floating_point :
+                                       std::is_signed<T>::value ? PackedFieldKind::signed_integer :
+                                       PackedFieldKind::unsigned_integer;
+          itsLayout.fields.push_back({static_cast<std::size_t>(field - itsObject), sizeof(T), kind});
+        }
+
+        //! Gets recorded layout
+        /*! Throws Exception if fields don't cover whole object or overlap, object has to be saved as raw memory */
+        PackedLayout layout() const
+        {
+          std::vector<PackedField> sorted = itsLayout.fields;
+          std::sort(sorted.begin(), sorted.end(),
+                    [](PackedField const & l, PackedField const & r) { return l.offset < r.offset; });
+          std::size_t next = 0;
+          for(auto const & field : sorted) {
+            if(field.offset != next)
+              throw Exception("Packed struct can't have padding or fields which are not serialized");
+            next += field.size;
+          }
+          if(next != itsLayout.size)
+            throw Exception("Packed struct can't have padding or fields which are not serialized");
+          return itsLayout;
+        }
+
+      private:
+        const std::uint8_t * itsObject; //!< beginning of recorded object
+        PackedLayout itsLayout; //!< recorded fields
+    };
+
+    //! Recording arithmetic field of packed struct
+    template <class T> inline
+    typename std::enable_if<std::is_arithmetic<T>::value, void>::type
+    CEREAL_SAVE_FUNCTION_NAME(PackedLayoutArchive & ar, T const & t)
+    {
+      ar.addField(t);
+    }
+
+    //! Recording array of arithmetic fields of packed struct (e.g. std::array)
+    template <class T> inline
+    void CEREAL_SAVE_FUNCTION_NAME(PackedLayoutArchive & ar, BinaryData<T> const & bd)
+    {
+      using TT = typename std::remove_const<typename std::remove_pointer<T>::type>::type;
+      const TT * data = reinterpret_cast<const TT *>(bd.data);
+      for(std::size_t i = 0; i < bd.size / sizeof(TT); ++i)
+        ar.addField(data[i]);
+    }
+
+    //! Serializing NVP types of packed struct
+    template <class T> inline
+    void CEREAL_SERIALIZE_FUNCTION_NAME(PackedLayoutArchive & ar, NameValuePair<T> & t)
+    {
+      ar( t.value );
+    }
+
+    //! Class version is not a part of packed struct
+    template <class T> inline
+    void CEREAL_SAVE_FUNCTION_NAME(PackedLayoutArchive &, detail::VersionIdTag<T> const &)
+    { }
+
+    //! Gets layout of packed struct
+    /*! Layout is found once by serializing default constructed object. */
+    template <class T> inline
+    PackedLayout const & getPackedLayout()
+    {
+      static_assert(std::is_trivially_copyable<T>::value, "packed struct has to be trivially copyable");
+      static_assert(sizeof(T) <= maxPackedStructSize, "packed struct is too big");
+      static const PackedLayout layout = []() {
+        const T object{};
+        PackedLayoutArchive ar(std::addressof(object), sizeof(T));
+        ar(object);
+        return ar.layout();
+      }();
+      return layout;
+    }
+  } // namespace extendable_binary_detail
+
+  template <class T>
+  struct specialize<extendable_binary_detail::PackedLayoutArchive, detail::VersionIdTag<T>, specialization::non_member_load_save> {};
+
+  //! Saving packed struct to ExtendableBinary archive
+  /*! @see CEREAL_EXTENDABLE_BINARY_PACKED_STRUCT */
+  template <class T> inline
+  typename std::enable_if<extendable_binary_detail::is_packed_struct<T>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME(ExtendableBinaryOutputArchive & ar, T const & t)
+  {
+    ar.savePackedStructs(extendable_binary_detail::getPackedLayout<T>(), std::addressof(t), 1, false);
+  }
+
+  //! Loading packed struct from ExtendableBinary archive
+  template <class T> inline
+  typename std::enable_if<extendable_binary_detail::is_packed_struct<T>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME(ExtendableBinaryInputArchive & ar, T & t)
+  {
+    using namespace extendable_binary_detail;
+    const auto type = ar.getTypeTag<FieldType::packed_struct>();
+    if(type.first == FieldType::omitted_field)
+      return;
+    if(type.second & PackedStructMarkers::IsArray)
+      throw Exception("Expected single packed struct, got array");
+    PackedLayout saved;
+    ar.loadPackedLayout(saved);
+    ar.loadPackedStructs(getPackedLayout<T>(), saved, std::addressof(t), 1);
+  }
+
+  //! Saving std::vector of packed structs to ExtendableBinary archive
+  /*! Vector is saved as one packed_struct field */
+  template <class T, class A> inline
+  typename std::enable_if<extendable_binary_detail::is_packed_struct<T>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME(ExtendableBinaryOutputArchive & ar, std::vector<T, A> const & vector)
+  {
+    ar.savePackedStructs(extendable_binary_detail::getPackedLayout<T>(), vector.data(), vector.size(), true);
+  }
+
+  //! Loading std::vector of packed structs from ExtendableBinary archive
+  /*! Vector grows while data is loaded, number of elements saved in stream is not used to allocate memory up front. */
+  template <class T, class A> inline
+  typename std::enable_if<extendable_binary_detail::is_packed_struct<T>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME(ExtendableBinaryInputArchive & ar, std::vector<T, A> & vector)
+  {
+    using namespace extendable_binary_detail;
+    const auto type = ar.getTypeTag<FieldType::packed_struct>();
+    if(type.first == FieldType::omitted_field)
+      return;
+    if(false == (type.second & PackedStructMarkers::IsArray))
+      throw Exception("Expected array of packed structs, got single struct");
+    PackedLayout saved;
+    ar.loadPackedLayout(saved);
+    std::uint64_t count;
+    ar.loadVarint(count);
+    if(count > vector.max_size())
+      throw Exception("Packed struct array size is too big");
+
+    const std::size_t batch = std::max<std::size_t>(1, writeBufferSize * 16 / saved.size);
+    vector.clear();
+    while(vector.size() < count) {
+      const std::size_t loaded = vector.size();
+      const std::size_t size = static_cast<std::size_t>(std::min<std::uint64_t>(count - loaded, batch));
+      vector.resize(loaded + size);
+      ar.loadPackedStructs(getPackedLayout<T>(), saved, vector.data() + loaded, size);
+    }
+  }
+
+  namespace extendable_binary_detail
+  {
+    //! Archive encoding fields of fused struct into memory buffer
+    /*! Serialization function of struct is called with this archive and every arithmetic field
+        is encoded with its type tag right after previous one. Calls are resolved at compile time,
+        so whole struct is encoded by straight-line code.
+        @tparam BigEndian if values are encoded in big endian byte order */
+    template <bool BigEndian>
+    class FusedEncoder
+    {
+      public:
+        //! Indicates this archive is used for saving
+        using is_saving = std::true_type;
+        //! Indicates this archive is not used for loading
+        using is_loading = std::false_type;
+
+        //! Construct encoder writing to buffer
+        /*! @param buffer destination of encoded fields
+            @param size size of buffer */
+        FusedEncoder(std::uint8_t * buffer, std::size_t size) :
+          itsBegin(buffer), itsPos(buffer), itsEnd(buffer + size)
+        { }
+
+        //! Encodes all passed fields
+        template <class ... Types> inline
+        FusedEncoder & operator()( Types && ... args )
+        {
+          process( std::forward<Types>( args )... );
+          return *this;
+        }
+
+        //! Encodes field, boost compatible syntax
+        template <class T> inline
+        FusedEncoder & operator&( T && arg )
+        {
+          process( std::forward<T>( arg ) );
+          return *this;
+        }
+
+        //! Encodes field, boost compatible syntax
+        template <class T> inline
+        FusedEncoder & operator<<( T && arg )
+        {
+          process( std::forward<T>( arg ) );
+          return *this;
+        }
+
+        //! Gets number of encoded bytes
+        std::size_t size() const
+        {
+          return static_cast<std::size_t>(itsPos - itsBegin);
+        }
+
+      private:
+        inline void process()
+        { }
+
+        template <class T, class ... Other> inline
+        void process( T && head, Other && ... tail )
+        {
+          field( head );
+          process( std::forward<Other>( tail )... );
+        }
+
+        template <class T> inline
+        void field( NameValuePair<T> const & nvp )
+        {
+          field( nvp.value );
+        }
+
+        //! Throws Exception if fields don't fit to buffer (struct serializes the same field twice or not its member)
+        template <class T> inline
+        void field( T const & t )
+        {
+          static_assert(std::is_arithmetic<T>::value, "fused struct can serialize only arithmetic fields");
+          if(static_cast<std::size_t>(itsEnd - itsPos) < 1 + sizeof(T))
+            throw Exception("Fused struct can serialize only its own members, every member once");
+          itsPos += encodeFusedField<BigEndian>(t, itsPos);
+        }
+
+        std::uint8_t * itsBegin; //!< beginning of buffer
+        std::uint8_t * itsPos; //!< next encoded field
+        std::uint8_t * itsEnd; //!< end of buffer
+    };
+
+    //! Archive decoding fields of fused struct from memory buffer
+    /*! Decoding stops at the first field which can't be decoded directly (e.g. type of
+        saved field is different or not enough data is available), struct is loaded
+        by ExtendableBinaryInputArchive then.
+        @tparam BigEndian if values are encoded in big endian byte order */
+    template <bool BigEndian>
+    class FusedDecoder
+    {
+      public:
+        //! Indicates this archive is not used for saving
+        using is_saving = std::false_type;
+        //! Indicates this archive is used for loading
+        using is_loading = std::true_type;
+
+        //! Construct decoder reading from buffer
+        /*! @param data encoded fields
+            @param size number of bytes available at data */
+        FusedDecoder(const std::uint8_t * data, std::size_t size) :
+          itsBegin(data), itsPos(data), itsEnd(data + size)
+        { }
+
+        //! Decodes all passed fields
+        template <class ... Types> inline
+        FusedDecoder & operator()( Types && ... args )
+        {
+          process( std::forward<Types>( args )... );
+          return *this;
+        }
+
+        //! Decodes field, boost compatible syntax
+        template <class T> inline
+        FusedDecoder & operator&( T && arg )
+        {
+          process( std::forward<T>( arg ) );
+          return *this;
+        }
+
+        //! Decodes field, boost compatible syntax
+        template <class T> inline
+        FusedDecoder & operator>>( T && arg )
+        {
+          process( std::forward<T>( arg ) );
+          return *this;
+        }
+
+        //! Checks if all fields were decoded
+        bool decoded() const
+        {
+          return itsPos != nullptr;
+        }
+
+        //! Gets number of decoded bytes, valid only if all fields were decoded
+        std::size_t size() const
+        {
+          return static_cast<std::size_t>(itsPos - itsBegin);
+        }
+
+      private:
+        inline void process()
+        { }
+
+        template <class T, class ... Other> inline
+        void process( T && head, Other && ... tail )
+        {
+          field( head );
+          process( std::forward<Other>( tail )... );
+        }
+
+        template <class T> inline
+        void field( NameValuePair<T> & nvp )
+        {
+          field( nvp.value );
+        }
+
+        template <class T> inline
+        void field( T & t )
+        {
+          static_assert(std::is_arithmetic<T>::value, "fused struct can serialize only arithmetic fields");
+          if(itsPos == nullptr)
+            return;
+          const std::size_t size = decodeFusedField<BigEndian>(t, itsPos, static_cast<std::size_t>(itsEnd - itsPos));
+          itsPos = size == 0 ? nullptr : itsPos + size;
+        }
+
+        const std::uint8_t * itsBegin; //!< beginning of data
+        const std::uint8_t * itsPos; //!< next field, nullptr if some field couldn't be decoded
+        const std::uint8_t * itsEnd; //!< end of available data
+    };
+
+    //! Checks if fused struct has serialization function with version
+    template <class T>
+    struct is_versioned_fused_struct : std::integral_constant<bool,
+      traits::has_member_versioned_serialize<T, ExtendableBinaryOutputArchive>::value ||
+      traits::has_non_member_versioned_serialize<T, ExtendableBinaryOutputArchive>::value> {};
+
+    //! Calls member serialization function of fused struct
+    template <class Archive, class T> inline
+    typename std::enable_if<traits::has_member_serialize<T, ExtendableBinaryOutputArchive>::value, void>::type
+    serializeFused(Archive & ar, T & t, std::uint32_t)
+    {
+      access::member_serialize(ar, t);
+    }
+
+    //! Calls versioned member serialization function of fused struct
+    template <class Archive, class T> inline
+    typename std::enable_if<traits::has_member_versioned_serialize<T, ExtendableBinaryOutputArchive>::value, void>::type
+    serializeFused(Archive & ar, T & t, std::uint32_t version)
+    {
+      access::member_serialize(ar, t, version);
+    }
+
+    //! Calls non member serialization function of fused struct
+    template <class Archive, class T> inline
+    typename std::enable_if<traits::has_non_member_serialize<T, ExtendableBinaryOutputArchive>::value, void>::type
+    serializeFused(Archive & ar, T & t, std::uint32_t)
+    {
+      CEREAL_SERIALIZE_FUNCTION_NAME(ar, t);
+    }
+
+    //! Calls versioned non member serialization function of fused struct
+    template <class Archive, class T> inline
+    typename std::enable_if<traits::has_non_member_versioned_serialize<T, ExtendableBinaryOutputArchive>::value, void>::type
+    serializeFused(Archive & ar, T & t, std::uint32_t version)
+    {
+      CEREAL_SERIALIZE_FUNCTION_NAME(ar, t, version);
+    }
+
+    //! Encodes all fields of fused struct into stack buffer and saves them at once
+    template <bool BigEndian, class T> inline
+    void saveFusedStruct(ExtendableBinaryOutputArchive & ar, T const & t, std::uint32_t version)
+    {
+      static_assert(sizeof(T) <= maxFusedStructSize, "fused struct is too big");
+      // every field takes at most its size and one byte of type tag
+      std::uint8_t buffer[2 * sizeof(T)];
+      FusedEncoder<BigEndian> encoder(buffer, sizeof(buffer));
+      serializeFused(encoder, const_cast<T &>(t), version);
+      ar.saveFusedFields(buffer, encoder.size());
+    }
+
+    //! Decodes all fields of fused struct directly from input memory buffer
+    /*! @return false if struct has to be loaded field by field */
+    template <bool BigEndian, class T> inline
+    bool loadFusedStruct(ExtendableBinaryInputArchive & ar, T & t, std::uint32_t version,
+                         const std::uint8_t * data, std::size_t available)
+    {
+      FusedDecoder<BigEndian> decoder(data, available);
+      serializeFused(decoder, t, version);
+      if(false == decoder.decoded())
+        return false;
+      ar.skipDirect(decoder.size());
+      return true;
+    }
+
+    //! Saves fused struct, @see CEREAL_EXTENDABLE_BINARY_FUSED_STRUCT
+    template <class T> inline
+    void saveFusedStruct(ExtendableBinaryOutputArchive & ar, T const & t, std::uint32_t version)
+    {
+      if(ar.savesBigEndian())
+        saveFusedStruct<true>(ar, t, version);
+      else
+        saveFusedStruct<false>(ar, t, version);
+    }
+
+    //! Loads fused struct, @see CEREAL_EXTENDABLE_BINARY_FUSED_STRUCT
+    /*! Fields are decoded directly when archive reads from memory buffer, otherwise
+        or if some field can't be decoded directly struct is loaded field by field. */
+    template <class T> inline
+    void loadFusedStruct(ExtendableBinaryInputArchive & ar, T & t, std::uint32_t version)
+    {
+      std::size_t available = 0;
+      if(const std::uint8_t * data = ar.peekDirect(available)) {
+        if(ar.loadsBigEndian() ? loadFusedStruct<true>(ar, t, version, data, available)
+                               : loadFusedStruct<false>(ar, t, version, data, available))
+          return;
+      }
+      serializeFused(ar, t, version);
+    }
+  } // namespace extendable_binary_detail
+
+  //! Saving fused struct to ExtendableBinary archive
+  /*! @see CEREAL_EXTENDABLE_BINARY_FUSED_STRUCT */
+  template <class T> inline
+  typename std::enable_if<extendable_binary_detail::is_fused_struct<T>::value &&
+                          !extendable_binary_detail::is_versioned_fused_struct<T>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME(ExtendableBinaryOutputArchive & ar, T const & t)
+  {
+    extendable_binary_detail::saveFusedStruct(ar, t, 0);
+  }
+
+  //! Saving fused struct with versioned serialization function to ExtendableBinary archive
+  template <class T> inline
+  typename std::enable_if<extendable_binary_detail::is_fused_struct<T>::value &&
+                          extendable_binary_detail::is_versioned_fused_struct<T>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME(ExtendableBinaryOutputArchive & ar, T const & t, std::uint32_t const version)
+  {
+    extendable_binary_detail::saveFusedStruct(ar, t, version);
+  }
+
+  //! Loading fused struct from ExtendableBinary archive
+  template <class T> inline
+  typename std::enable_if<extendable_binary_detail::is_fused_struct<T>::value &&
+                          !extendable_binary_detail::is_versioned_fused_struct<T>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME(ExtendableBinaryInputArchive & ar, T & t)
+  {
+    extendable_binary_detail::loadFusedStruct(ar, t, 0);
+  }
+
+  //! Loading fused struct with versioned serialization function from ExtendableBinary archive
+  template <class T> inline
+  typename std::enable_if<extendable_binary_detail::is_fused_struct<T>::value &&
+                          extendable_binary_detail::is_versioned_fused_struct<T>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME(ExtendableBinaryInputArchive & ar, T & t, std::uint32_t const version)
+  {
+    extendable_binary_detail::loadFusedStruct(ar, t, version);
+  }
+
+  namespace extendable_binary_detail
+  {
+    //! Integers saved as one FieldType::integer_array field
+    /*! Array is always compressed, @see ExtendableBinaryOutputArchive::saveIntegerArray() */
+    template <class T, class It, class Get>
+    struct IntegerArrayOutput
+    {
+      It first; //!< iterator to first element
+      std::size_t count; //!< number of elements
+      Get get; //!< gets integer of type T from element
+    };
+
+    //! Creates IntegerArrayOutput for elements in range with count elements starting from first
+    template <class T, class It, class Get> inline
+    IntegerArrayOutput<T, It, Get> makeIntegerArrayOutput(It first, std::size_t count, Get get)
+    {
+      return {first, count, get};
+    }
+
+    //! Integers loaded from one FieldType::integer_array field
+    template <class T, class Sink>
+    struct IntegerArrayInput
+    {
+      std::size_t count; //!< number of elements announced by size tag
+      Sink sink; //!< called with every loaded integer of type T
+    };
+
+    //! Creates IntegerArrayInput which expects count elements
+    template <class T, class Sink> inline
+    IntegerArrayInput<T, Sink> makeIntegerArrayInput(size_type count, Sink sink)
+    {
+      if(count > std::numeric_limits<std::size_t>::max())
+        throw Exception("Integer array size is too big");
+      return {static_cast<std::size_t>(count), sink};
+    }
+
+    //! Saves std::set or std::multiset with integer keys
+    /*! Keys are saved as one delta encoded array if ExtendableBinaryOutputArchive::savesDeltaEncodedKeys() */
+    template <class SetT> inline
+    void saveIntegerSet(ExtendableBinaryOutputArchive & ar, SetT const & set)
+    {
+      using K = typename SetT::key_type;
+      ar( make_size_tag( static_cast<size_type>(set.size()) ) );
+      if(ar.savesDeltaEncodedKeys()) {
+        ar( makeIntegerArrayOutput<K>(set.begin(), set.size(), [](K const & key) { return key; }) );
+        return;
+      }
+      for( const auto & i : set )
+        ar( i );
+    }
+
+    //! Loads std::set or std::multiset with integer keys
+    /*! Keys are inserted at the end of set */
+    template <class SetT> inline
+    void loadIntegerSet(ExtendableBinaryInputArchive & ar, SetT & set)
+    {
+      using K = typename SetT::key_type;
+      size_type size;
+      ar( make_size_tag( size ) );
+      set.clear();
+      if(ar.hasDeltaEncodedKeys()) {
+        auto keys = makeIntegerArrayInput<K>(size, [&set](K key) { set.emplace_hint(set.end(), key); });
+        ar( keys );
+        return;
+      }
+      auto hint = set.begin();
+      for( size_type i = 0; i < size; ++i ) {
+        K key;
+        ar( key );
+        hint = set.emplace_hint( hint, std::move( key ) );
+      }
+    }
+
+    //! Saves std::map or std::multimap with integer keys
+    /*! If ExtendableBinaryOutputArchive::savesDeltaEncodedKeys() keys are saved as one delta encoded array,
+        followed by values */
+    template <class MapT> inline
+    void saveIntegerMap(ExtendableBinaryOutputArchive & ar, MapT const & map)
+    {
+      using K = typename MapT::key_type;
+      ar( make_size_tag( static_cast<size_type>(map.size()) ) );
+      if(ar.savesDeltaEncodedKeys()) {
+        ar( makeIntegerArrayOutput<K>(map.begin(), map.size(), [](typename MapT::value_type const & i) { return i.first; }) );
+        for( const auto & i : map )
+          ar( i.second );
+        return;
+      }
+      for( const auto & i : map )
+        ar( make_map_item(i.first, i.second) );
+    }
+
+    //! Loads std::map or std::multimap with integer keys
+    /*! Elements are inserted at the end of map, values are loaded in place */
+    template <class MapT> inline
+    void loadIntegerMap(ExtendableBinaryInputArchive & ar, MapT & map)
+    {
+      using K = typename MapT::key_type;
+      size_type size;
+      ar( make_size_tag( size ) );
+      map.clear();
+      if(ar.hasDeltaEncodedKeys()) {
+        std::vector<K> keys;
+        auto input = makeIntegerArrayInput<K>(size, [&keys](K key) { keys.push_back(key); });
+        ar( input );
+        for( auto key : keys )
+          common_detail::loadMapValue( ar, map, map.end(), key );
+        return;
+      }
+      common_detail::MapItemLoader<MapT> item{ map, map.begin() };
+      for( size_type i = 0; i < size; ++i )
+        ar( item );
+    }
+  } // namespace extendable_binary_detail
+
+  //! Saving IntegerArrayOutput to ExtendableBinary archive
+  template <class T, class It, class Get> inline
+  void CEREAL_SAVE_FUNCTION_NAME(ExtendableBinaryOutputArchive & ar, extendable_binary_detail::IntegerArrayOutput<T, It, Get> const & array)
+  {
+    ar.saveIntegerArray<T>(array.first, array.count, array.get, false);
+  }
+
+  //! Loading IntegerArrayInput from ExtendableBinary archive
+  /*! Throws Exception if number of loaded elements is different than expected */
+  template <class T, class Sink> inline
+  void CEREAL_LOAD_FUNCTION_NAME(ExtendableBinaryInputArchive & ar, extendable_binary_detail::IntegerArrayInput<T, Sink> & array)
+  {
+    using namespace extendable_binary_detail;
+    const auto type = ar.getTypeTag<FieldType::integer_array>();
+    const std::size_t loaded = type.first == FieldType::omitted_field ? 0 : ar.loadIntegerArray<T>(type.second, array.count, array.sink);
+    if(loaded != array.count)
+      throw Exception("Integer array size doesn't match size tag");
+  }
+
+  //! Saving std::set with integer keys to ExtendableBinary archive
+  template <class K, class C, class A> inline
+  typename std::enable_if<extendable_binary_detail::is_compressible_integer<K>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME(ExtendableBinaryOutputArchive & ar, std::set<K, C, A> const & set)
+  {
+    extendable_binary_detail::saveIntegerSet(ar, set);
+  }
+
+  //! Loading std::set with integer keys from ExtendableBinary archive
+  template <class K, class C, class A> inline
+  typename std::enable_if<extendable_binary_detail::is_compressible_integer<K>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME(ExtendableBinaryInputArchive & ar, std::set<K, C, A> & set)
+  {
+    extendable_binary_detail::loadIntegerSet(ar, set);
+  }
+
+  //! Saving std::multiset with integer keys to ExtendableBinary archive
+  template <class K, class C, class A> inline
+  typename std::enable_if<extendable_binary_detail::is_compressible_integer<K>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME(ExtendableBinaryOutputArchive & ar, std::multiset<K, C, A> const & multiset)
+  {
+    extendable_binary_detail::saveIntegerSet(ar, multiset);
+  }
+
+  //! Loading std::multiset with integer keys from ExtendableBinary archive
+  template <class K, class C, class A> inline
+  typename std::enable_if<extendable_binary_detail::is_compressible_integer<K>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME(ExtendableBinaryInputArchive & ar, std::multiset<K, C, A> & multiset)
+  {
+    extendable_binary_detail::loadIntegerSet(ar, multiset);
+  }
+
+  //! Saving std::map with integer keys to ExtendableBinary archive
+  template <class K, class V, class C, class A> inline
+  typename std::enable_if<extendable_binary_detail::is_compressible_integer<K>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME(ExtendableBinaryOutputArchive & ar, std::map<K, V, C, A> const & map)
+  {
+    extendable_binary_detail::saveIntegerMap(ar, map);
+  }
+
+  //! Loading std::map with integer keys from ExtendableBinary archive
+  template <class K, class V, class C, class A> inline
+  typename std::enable_if<extendable_binary_detail::is_compressible_integer<K>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME(ExtendableBinaryInputArchive & ar, std::map<K, V, C, A> & map)
+  {
+    extendable_binary_detail::loadIntegerMap(ar, map);
+  }
+
+  //! Saving std::multimap with integer keys to ExtendableBinary archive
+  template <class K, class V, class C, class A> inline
+  typename std::enable_if<extendable_binary_detail::is_compressible_integer<K>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME(ExtendableBinaryOutputArchive & ar, std::multimap<K, V, C, A> const & multimap)
+  {
+    extendable_binary_detail::saveIntegerMap(ar, multimap);
+  }
+
+  //! Loading std::multimap with integer keys from ExtendableBinary archive
+  template <class K, class V, class C, class A> inline
+  typename std::enable_if<extendable_binary_detail::is_compressible_integer<K>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME(ExtendableBinaryInputArchive & ar, std::multimap<K, V, C, A> & multimap)
+  {
+    extendable_binary_detail::loadIntegerMap(ar, multimap);
+  }
+
+  //! Saving std::vector of std::chrono::time_point to ExtendableBinary archive
+  /*! Time points are saved as one delta encoded array if ExtendableBinaryOutputArchive::savesDeltaEncodedKeys() */
+  template <class C, class D, class A> inline
+  typename std::enable_if<extendable_binary_detail::is_compressible_integer<typename D::rep>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME(ExtendableBinaryOutputArchive & ar, std::vector<std::chrono::time_point<C, D>, A> const & vector)
+  {
+    using TimePoint = std::chrono::time_point<C, D>;
+    ar( make_size_tag( static_cast<size_type>(vector.size()) ) );
+    if(ar.savesDeltaEncodedKeys()) {
+      ar( extendable_binary_detail::makeIntegerArrayOutput<typename D::rep>(vector.begin(), vector.size(),
+            [](TimePoint const & t) { return t.time_since_epoch().count(); }) );
+      return;
+    }
+    for( auto const & t : vector )
+      ar( t );
+  }
+
+  //! Loading std::vector of std::chrono::time_point from ExtendableBinary archive
+  template <class C, class D, class A> inline
+  typename std::enable_if<extendable_binary_detail::is_compressible_integer<typename D::rep>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME(ExtendableBinaryInputArchive & ar, std::vector<std::chrono::time_point<C, D>, A> & vector)
+  {
+    using Rep = typename D::rep;
+    size_type size;
+    ar( make_size_tag( size ) );
+    if(ar.hasDeltaEncodedKeys()) {
+      vector.clear();
+      auto input = extendable_binary_detail::makeIntegerArrayInput<Rep>(size, [&vector](Rep count) { vector.emplace_back(D(count)); });
+      ar( input );
+      return;
+    }
+    vector.clear();
+    common_detail::reserve( vector, size );
+    for( size_type i = 0; i < size; ++i )
+    {
+      std::chrono::time_point<C, D> t;
+      ar( t );
+      vector.push_back( t );
+    }
+  }
+
+  namespace extendable_binary_detail
+  {
+    //! Bits saved as one FieldType::bit_array field, @see ExtendableBinaryOutputArchive::saveBits()
+    template <class Get>
+    struct BitArrayOutput
+    {
+      std::size_t count; //!< number of bits
+      Get get; //!< gets bit with given index
+    };
+
+    //! Creates BitArrayOutput for count bits
+    template <class Get> inline
+    BitArrayOutput<Get> makeBitArrayOutput(std::size_t count, Get get)
+    {
+      return {count, get};
+    }
+
+    //! Bits loaded from one FieldType::bit_array field, @see ExtendableBinaryInputArchive::loadBits()
+    template <class Chunk>
+    struct BitArrayInput
+    {
+      std::uint64_t maxCount; //!< maximal number of bits
+      bool exactCount; //!< if exactly maxCount bits have to be loaded
+      Chunk chunk; //!< called for every chunk of loaded bits
+    };
+
+    //! Creates BitArrayInput for at most (or exactly if exactCount is set) maxCount bits
+    template <class Chunk> inline
+    BitArrayInput<Chunk> makeBitArrayInput(std::uint64_t maxCount, bool exactCount, Chunk chunk)
+    {
+      return {maxCount, exactCount, chunk};
+    }
+
+    //! Value of type field saved before bits of std::bitset when bits are not packed
+    /*! Same as bitset_detail::type::bits in cereal/types/bitset.hpp */
+    enum { bitsetChunksType = 3 };
+  } // namespace extendable_binary_detail
+
+  //! Saving BitArrayOutput to ExtendableBinary archive
+  template <class Get> inline
+  void CEREAL_SAVE_FUNCTION_NAME(ExtendableBinaryOutputArchive & ar, extendable_binary_detail::BitArrayOutput<Get> const & bits)
+  {
+    ar.saveBits(bits.count, bits.get);
+  }
+
+  //! Loading BitArrayInput from ExtendableBinary archive
+  /*! Throws Exception if number of saved bits doesn't match expected */
+  template <class Chunk> inline
+  void CEREAL_LOAD_FUNCTION_NAME(ExtendableBinaryInputArchive & ar, extendable_binary_detail::BitArrayInput<Chunk> & bits)
+  {
+    using namespace extendable_binary_detail;
+    const auto type = ar.getTypeTag<FieldType::bit_array>();
+    std::uint64_t count = 0;
+    if(type.first != FieldType::omitted_field)
+      ar.loadVarint(count);
+    if(count > bits.maxCount || (bits.exactCount && count != bits.maxCount))
+      throw Exception("Bit array size doesn't match, expected: " + std::to_string(bits.maxCount) + " got: " + std::to_string(count));
+    ar.loadBits(count, bits.chunk);
+  }
+
+  //! Saving std::vector<bool> to ExtendableBinary archive
+  /*! Vector is saved as one bit array if ExtendableBinaryOutputArchive::savesPackedBits(),
+      otherwise as size and bool fields, same as in cereal/types/vector.hpp */
+  template <class A> inline
+  void CEREAL_SAVE_FUNCTION_NAME(ExtendableBinaryOutputArchive & ar, std::vector<bool, A> const & vector)
+  {
+    if(ar.savesPackedBits()) {
+      ar( extendable_binary_detail::makeBitArrayOutput(vector.size(), [&vector](std::size_t i) { return vector[i]; }) );
+      return;
+    }
+    ar( make_size_tag( static_cast<size_type>(vector.size()) ) );
+    for(auto && v : vector)
+      ar( static_cast<bool>(v) );
+  }
+
+  //! Loading std::vector<bool> from ExtendableBinary archive
+  /*! Vector grows while packed bits are loaded */
+  template <class A> inline
+  void CEREAL_LOAD_FUNCTION_NAME(ExtendableBinaryInputArchive & ar, std::vector<bool, A> & vector)
+  {
+    using namespace extendable_binary_detail;
+    if(ar.hasPackedBits()) {
+      vector.clear();
+      auto set = [&vector](std::size_t i, bool b) { vector[i] = b; };
+      auto bits = makeBitArrayInput(vector.max_size(), false, [&vector, &set](const std::uint8_t * data, std::size_t first, std::size_t count) {
+        vector.resize(first + count);
+        unpackBools(data, first, count, set);
+      });
+      ar( bits );
+      return;
+    }
+    size_type size;
+    ar( make_size_tag( size ) );
+    vector.clear();
+    common_detail::reserve( vector, size );
+    for(size_type i = 0; i < size; ++i) {
+      bool b;
+      ar( b );
+      vector.push_back( b );
+    }
+  }
+
+  //! Saving std::bitset to ExtendableBinary archive
+  /*! Bitset is saved as one bit array if ExtendableBinaryOutputArchive::savesPackedBits(),
+      otherwise as type and 8 bit chunks, same as in cereal/types/bitset.hpp */
+  template <std::size_t N> inline
+  void CEREAL_SAVE_FUNCTION_NAME(ExtendableBinaryOutputArchive & ar, std::bitset<N> const & bits)
+  {
+    if(ar.savesPackedBits()) {
+      ar( extendable_binary_detail::makeBitArrayOutput(N, [&bits](std::size_t i) { return bits[i]; }) );
+      return;
+    }
+    ar( static_cast<std::uint8_t>(extendable_binary_detail::bitsetChunksType) );
+    for( std::size_t i = 0; i < N; i += 8 ) {
+      std::uint8_t chunk = 0;
+      for( std::size_t b = 0; b < 8 && i + b < N; ++b )
+        if( bits[i + b] )
+          chunk |= static_cast<std::uint8_t>(0x80 >> b);
+      ar( chunk );
+    }
+  }
+
+  //! Loading std::bitset from ExtendableBinary archive
+  template <std::size_t N> inline
+  void CEREAL_LOAD_FUNCTION_NAME(ExtendableBinaryInputArchive & ar, std::bitset<N> & bits)
+  {
+    using namespace extendable_binary_detail;
+    bits.reset();
+    if(ar.hasPackedBits()) {
+      auto set = [&bits](std::size_t i, bool b) { bits[i] = b; };
+      auto input = makeBitArrayInput(N, true, [&set](const std::uint8_t * data, std::size_t first, std::size_t count) {
+        unpackBools(data, first, count, set);
+      });
+      ar( input );
+      return;
+    }
+    std::uint8_t type;
+    ar( type );
+    if(type != bitsetChunksType)
+      throw Exception("Invalid bitset data representation");
+    for( std::size_t i = 0; i < N; i += 8 ) {
+      std::uint8_t chunk;
+      ar( chunk );
+      for( std::size_t b = 0; b < 8 && i + b < N; ++b )
+        bits[i + b] = (chunk & (0x80 >> b)) != 0;
+    }
+  }
+
   //! Saving VersionIdTag to ExtendableBinary archive
   template <class T> inline
   void CEREAL_SAVE_FUNCTION_NAME(ExtendableBinaryOutputArchive & ar, detail::VersionIdTag<T> const & version)
@@ -1409,12 +3307,25 @@ namespace cereal
       traits::detail::meta_bool_or<
           std::is_arithmetic<T>::value,
           std::is_same<T, std::nullptr_t>::value,
-          std::is_same<T, OmittedFieldTag>::value
+          std::is_same<T, OmittedFieldTag>::value,
+          extendable_binary_detail::is_packed_struct<T>::value
       > {};
+  template <class T, class A>
+  struct is_extendablebinary_empty_prologue_and_epilogue1<std::vector<T, A>> : extendable_binary_detail::is_packed_struct<T> {};
   template <class T>
   struct is_extendablebinary_empty_prologue_and_epilogue1<SizeTag<T>> : std::true_type {};
   template <class T>
   struct is_extendablebinary_empty_prologue_and_epilogue1<BinaryData<T>> : std::true_type {};
+  template <class T>
+  struct is_extendablebinary_empty_prologue_and_epilogue1<extendable_binary_detail::PackedArrayView<T>> : std::true_type {};
+  template <class T, class It, class Get>
+  struct is_extendablebinary_empty_prologue_and_epilogue1<extendable_binary_detail::IntegerArrayOutput<T, It, Get>> : std::true_type {};
+  template <class T, class Sink>
+  struct is_extendablebinary_empty_prologue_and_epilogue1<extendable_binary_detail::IntegerArrayInput<T, Sink>> : std::true_type {};
+  template <class Get>
+  struct is_extendablebinary_empty_prologue_and_epilogue1<extendable_binary_detail::BitArrayOutput<Get>> : std::true_type {};
+  template <class Chunk>
+  struct is_extendablebinary_empty_prologue_and_epilogue1<extendable_binary_detail::BitArrayInput<Chunk>> : std::true_type {};
 
   //! Prologue for arithmetic types for ExtendableBinary archives
   template <class T, traits::EnableIf<is_extendablebinary_empty_prologue_and_epilogue1<T>::value> = traits::sfinae> inline
@@ -1550,6 +3461,73 @@ namespace cereal
   };
 } // namespace cereal
 
+//! Saves type as packed struct in ExtendableBinary archive
+/*! Struct is saved as one field: its layout followed by raw memory, std::vector of such
+    structs is saved as one field with layout followed by memory of all elements.
+    Type has to be trivially copyable, default constructible and its serialization function
+    has to serialize all its arithmetic members (directly, in nested structs or std::array),
+    struct can't have padding. Layout is found by calling serialization function on
+    default constructed object. Other archives use serialization function as usual.
+
+    Macro has to be used in global namespace, before type is serialized:
+
+    @code{cpp}
+    struct Point3f
+    {
+      float x, y, z;
+
+      template <class Archive>
+      void serialize(Archive & ar) { ar(x, y, z); }
+    };
+
+    CEREAL_EXTENDABLE_BINARY_PACKED_STRUCT(Point3f)
+    @endcode */
+#define CEREAL_EXTENDABLE_BINARY_PACKED_STRUCT(T)                                              \
+  namespace cereal {                                                                           \
+    namespace extendable_binary_detail {                                                       \
+      template <> struct is_packed_struct<T> : std::true_type {};                              \
+    }                                                                                          \
+    template <> struct specialize<ExtendableBinaryOutputArchive, T,                            \
+                                  specialization::non_member_load_save> {};                    \
+    template <> struct specialize<ExtendableBinaryInputArchive, T,                             \
+                                  specialization::non_member_load_save> {};                    \
+  }
+
+//! Saves type with fused encoder in ExtendableBinary archive
+/*! All fields are encoded into stack buffer by straight-line code and written at once,
+    instead of going through archive one by one. Saved data is the same as without
+    the macro, so it can be used on one side only. Type's serialize function (member
+    or non member, optionally versioned) has to be a template and serialize only its own
+    arithmetic members (bool, integers up to 8 bytes, float and double), every one of
+    them once. Size of type can't exceed maxFusedStructSize bytes.
+    Fields are decoded directly when input archive reads from memory buffer.
+
+    Macro has to be used in global namespace, before type is serialized:
+
+    @code{cpp}
+    struct Sample
+    {
+      std::int64_t timestamp;
+      std::uint32_t id;
+      double value;
+
+      template <class Archive>
+      void serialize(Archive & ar) { ar(timestamp, id, value); }
+    };
+
+    CEREAL_EXTENDABLE_BINARY_FUSED_STRUCT(Sample)
+    @endcode */
+#define CEREAL_EXTENDABLE_BINARY_FUSED_STRUCT(T)                                               \
+  namespace cereal {                                                                           \
+    namespace extendable_binary_detail {                                                       \
+      template <> struct is_fused_struct<T> : std::true_type {};                               \
+    }                                                                                          \
+    template <> struct specialize<ExtendableBinaryOutputArchive, T,                            \
+                                  specialization::non_member_load_save> {};                    \
+    template <> struct specialize<ExtendableBinaryInputArchive, T,                             \
+                                  specialization::non_member_load_save> {};                    \
+  }
+
 // register archives for polymorphic support
 CEREAL_REGISTER_ARCHIVE(cereal::ExtendableBinaryOutputArchive)
 CEREAL_REGISTER_ARCHIVE(cereal::ExtendableBinaryInputArchive)
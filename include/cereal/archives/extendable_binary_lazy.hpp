@@ -0,0 +1,181 @@
+/*! \file extendable_binary_lazy.hpp
+    \brief Subobjects of extendable binary archives decoded on first access */
+/*
+  Copyright (c) 2016, Randolph Voorhies, Shane Grant, Michal Breiter
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT OR MICHAL BREITER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_ARCHIVES_EXTENDABLE_BINARY_LAZY_HPP_
+#define CEREAL_ARCHIVES_EXTENDABLE_BINARY_LAZY_HPP_
+
+#include <cereal/archives/extendable_binary.hpp>
+#include <cereal/types/array_view.hpp>
+#include <cstring>
+#include <sstream>
+
+namespace cereal
+{
+  // ######################################################################
+  //! A wrapper around field which is decoded when it's accessed first time
+  /*! Value is saved by its own ExtendableBinaryOutputArchive (with options of archive
+      saving wrapper) as array of bytes, so object ids of shared pointers, polymorphic type
+      ids and class versions are scoped to value. Pointers to the same object from inside
+      and outside of value are loaded as different objects. Wrapper is saved as regular
+      object, readers which don't know the field skip it without decoding.
+
+      Loading keeps only bytes of value, they are used in place when archive reads from
+      memory buffer. Wrapper loaded from memory buffer refers to that buffer and must not
+      outlive it, unless detach() was called before buffer is released.
+      Value is decoded by get(). Wrapper which was not changed after loading saves the same
+      bytes again without encoding value.
+
+      Loading of value with get() const is not thread safe.
+
+      @code{cpp}
+      struct Message
+      {
+        Header header;
+        cereal::lazy<Body> body;
+
+        template <class Archive>
+        void serialize( Archive & ar )
+        {
+          ar( header, body );
+        }
+      };
+
+      if( message.header.type == Type::Order )
+        process( message.body.get() );
+      @endcode
+
+      @tparam T type of value
+      \ingroup Utility */
+  template <class T>
+  class lazy
+  {
+    public:
+      //! Construct wrapper with default constructed value
+      lazy() : itsLoaded(true), itsEncoded(false) {}
+
+      //! Construct wrapper with value
+      /*! Explicit, so value isn't converted to wrapper silently */
+      explicit lazy(T value) : itsValue(std::move(value)), itsLoaded(true), itsEncoded(false) {}
+
+      //! Replaces value, saved bytes are released
+      lazy & operator=(T value)
+      {
+        itsValue = std::move(value);
+        itsLoaded = true;
+        itsEncoded = false;
+        itsData = ArrayView<char>();
+        return *this;
+      }
+
+      //! Gets value, decoding it if it wasn't decoded yet
+      /*! Throws Exception if saved value cannot be loaded */
+      T const & get() const
+      {
+        if(false == itsLoaded) {
+          T value;
+          ExtendableBinaryInputArchive ar( itsData.data(), itsData.size(), itsOptions );
+          ar( value );
+          itsValue = std::move(value);
+          itsLoaded = true;
+        }
+        return itsValue;
+      }
+
+      //! Gets value for modification, decoding it if it wasn't decoded yet
+      /*! Value is encoded again when wrapper is saved.
+          Throws Exception if saved value cannot be loaded */
+      T & get()
+      {
+        static_cast<lazy const &>(*this).get();
+        itsEncoded = false;
+        itsData = ArrayView<char>();
+        return itsValue;
+      }
+
+      //! Returns true if value was decoded or wasn't loaded from archive
+      bool loaded() const
+      {
+        return itsLoaded;
+      }
+
+      //! Copies saved bytes which point to memory buffer of input archive
+      /*! Buffer from which wrapper was loaded can be released afterwards */
+      void detach()
+      {
+        if(itsData.empty() || itsData.isCopy())
+          return;
+        ArrayView<char> copy;
+        std::memcpy( copy.allocate( itsData.size() ), itsData.data(), itsData.size() );
+        itsData = std::move(copy);
+      }
+
+    private:
+      template <class U> friend
+      void CEREAL_SAVE_FUNCTION_NAME( ExtendableBinaryOutputArchive & ar, lazy<U> const & wrapper );
+      template <class U> friend
+      void CEREAL_LOAD_FUNCTION_NAME( ExtendableBinaryInputArchive & ar, lazy<U> & wrapper );
+
+      mutable T itsValue;
+      mutable bool itsLoaded; //!< itsValue holds value
+      bool itsEncoded; //!< itsData holds saved bytes of value
+      ArrayView<char> itsData;
+      ExtendableBinaryInputArchive::Options itsOptions; //!< options of archive which loaded itsData
+  };
+
+  //! Saving lazy value to ExtendableBinary archive
+  /*! Bytes loaded earlier are saved again if value was not changed, otherwise value is
+      encoded by separate archive with options of ar. */
+  template <class T> inline
+  void CEREAL_SAVE_FUNCTION_NAME( ExtendableBinaryOutputArchive & ar, lazy<T> const & wrapper )
+  {
+    if(wrapper.itsEncoded) {
+      ar( wrapper.itsData );
+      return;
+    }
+    std::ostringstream os( std::ios::binary );
+    {
+      ExtendableBinaryOutputArchive valueAr( os, ar.getOptions() );
+      valueAr( wrapper.itsValue );
+    }
+    auto const encoded = os.str();
+    ar( ArrayView<char>( encoded ) );
+  }
+
+  //! Loading lazy value from ExtendableBinary archive, value is decoded by lazy::get()
+  template <class T> inline
+  void CEREAL_LOAD_FUNCTION_NAME( ExtendableBinaryInputArchive & ar, lazy<T> & wrapper )
+  {
+    ar( wrapper.itsData );
+    wrapper.itsOptions = ar.getOptions();
+    wrapper.itsValue = T();
+    wrapper.itsLoaded = false;
+    wrapper.itsEncoded = true;
+  }
+} // namespace cereal
+
+#endif // CEREAL_ARCHIVES_EXTENDABLE_BINARY_LAZY_HPP_
@@ -0,0 +1,359 @@
+/*! \file extendable_binary_parallel.hpp
+    \brief Parallel encoding of large containers for extendable binary archives */
+/*
+  Copyright (c) 2016, Randolph Voorhies, Shane Grant, Michal Breiter
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT OR MICHAL BREITER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_ARCHIVES_EXTENDABLE_BINARY_PARALLEL_HPP_
+#define CEREAL_ARCHIVES_EXTENDABLE_BINARY_PARALLEL_HPP_
+
+#include <cereal/archives/extendable_binary.hpp>
+#include <cereal/types/array_view.hpp>
+#include <cereal/types/vector.hpp>
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <future>
+#include <limits>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace cereal
+{
+  // ######################################################################
+  //! A wrapper around std::vector saved in chunks encoded in parallel
+  /*! Container is split into chunks of chunkElements elements. Every chunk is encoded by
+      its own ExtendableBinaryOutputArchive (with options of archive saving wrapper) on
+      worker thread, so object ids of shared pointers, polymorphic type ids and class versions
+      are tracked per chunk. Threads share only global registries of cereal (class versions,
+      polymorphic bindings), which are safe to use from many threads. Encoded chunks are
+      saved in order as arrays of bytes after table with number of elements of every chunk.
+      At most threads chunks are kept in memory at once.
+
+      Wrapper is saved as regular object, so it can be skipped by reader which doesn't know
+      the field. Elements are loaded with the same wrapper, chunks are decoded on threads
+      threads into elements of resized container. Elements keep their forward compatibility,
+      every chunk is separate archive. Only default constructible elements can be decoded
+      in parallel, elements loaded with load_and_construct are decoded one chunk after another.
+
+      Pointers in different chunks (or in chunk and outside of container) pointing to the same
+      object are saved and loaded as different objects. With length prefixed objects whole
+      saved container is kept in memory, as for any other object.
+
+      @code{cpp}
+      std::vector<Record> records;
+      archive( cereal::make_parallel_chunks( records ) );
+      @endcode
+
+      @tparam T reference to std::vector
+      \ingroup OtherTypes */
+  template <class T>
+  class ParallelChunks
+  {
+    private:
+      ParallelChunks & operator=( ParallelChunks const & ) = delete;
+
+    public:
+      //! Construct wrapper
+      /*! @param container_ saved or loaded container
+          @param chunkElements_ number of elements encoded in one chunk
+          @param threads_ max number of chunks encoded or decoded at once, 0 to use number of hardware threads */
+      ParallelChunks( T container_, std::size_t chunkElements_, unsigned threads_ ) :
+        container( container_ ),
+        chunkElements( std::max<std::size_t>( chunkElements_, 1 ) ),
+        threads( threads_ != 0 ? threads_ : std::max( std::thread::hardware_concurrency(), 1u ) )
+      { }
+
+      T container;
+      const std::size_t chunkElements;
+      const unsigned threads;
+  };
+
+  //! Creates wrapper saving vector in chunks encoded in parallel
+  /*! @param container saved or loaded vector
+      @param chunkElements number of elements encoded in one chunk, not used for loading
+      @param threads max number of chunks encoded or decoded at once, 0 to use number of hardware threads.
+                     Chunks of elements which are not default constructible are decoded one after another.
+      @relates ParallelChunks */
+  template <class T, class A> inline
+  ParallelChunks<std::vector<T, A> &> make_parallel_chunks( std::vector<T, A> & container,
+                                                           std::size_t chunkElements = 4096,
+                                                           unsigned threads = 0 )
+  {
+    return {container, chunkElements, threads};
+  }
+
+  //! Creates wrapper saving vector in chunks encoded in parallel
+  /*! @relates ParallelChunks */
+  template <class T, class A> inline
+  ParallelChunks<std::vector<T, A> const &> make_parallel_chunks( std::vector<T, A> const & container,
+                                                                 std::size_t chunkElements = 4096,
+                                                                 unsigned threads = 0 )
+  {
+    return {container, chunkElements, threads};
+  }
+
+  namespace extendable_binary_detail
+  {
+    //! Encodes elements [begin, end) of container as separate archive
+    template <class T, class A> inline
+    std::string encodeChunk( std::vector<T, A> const & container, std::size_t begin, std::size_t end,
+                             ExtendableBinaryOutputArchive::Options const & options )
+    {
+      std::ostringstream os( std::ios::binary );
+      {
+        ExtendableBinaryOutputArchive ar( os, options );
+        for( std::size_t ii = begin; ii < end; ++ii )
+          ar( container[ii] );
+      }
+      return os.str();
+    }
+
+    //! Loads elements of chunk saved with encodeChunk() to [begin, begin + count) of container
+    /*! Elements are loaded in place, container has to be resized already */
+    template <class T, class A> inline
+    void decodeChunk( std::vector<T, A> & container, std::size_t begin, std::uint64_t count,
+                      ArrayView<char> const & chunk, ExtendableBinaryInputArchive::Options const & options )
+    {
+      ExtendableBinaryInputArchive ar( chunk.data(), chunk.size(), options );
+      for( std::size_t ii = begin; ii < begin + count; ++ii )
+        ar( container[ii] );
+    }
+
+    //! Appends count elements of chunk saved with encodeChunk() to container
+    /*! Elements without default constructor are constructed with load_and_construct */
+    template <class T, class A> inline
+    void decodeChunkBack( std::vector<T, A> & container, std::uint64_t count,
+                          ArrayView<char> const & chunk, ExtendableBinaryInputArchive::Options const & options )
+    {
+      ExtendableBinaryInputArchive ar( chunk.data(), chunk.size(), options );
+      for( std::uint64_t ii = 0; ii < count; ++ii )
+        common_detail::loadBack( ar, container );
+    }
+
+    //! Loads chunks one after another, appending elements to container
+    /*! Space for all elements is reserved once, bounded like any size loaded from archive,
+        container grows geometrically beyond that */
+    template <class T, class A> inline
+    void loadChunks( ExtendableBinaryInputArchive & ar, std::vector<T, A> & container,
+                     std::vector<std::uint64_t> const & table )
+    {
+      size_type total = 0;
+      for( auto const count : table )
+        total = count < std::numeric_limits<size_type>::max() - total ? total + count : std::numeric_limits<size_type>::max();
+      common_detail::reserve( container, total );
+
+      for( auto const count : table )
+      {
+        ArrayView<char> chunk;
+        ar( chunk );
+        // every saved element takes at least one byte
+        if( count > chunk.size() )
+          throw Exception("Number of elements doesn't match size of chunk");
+        decodeChunkBack( container, count, chunk, ar.getOptions() );
+      }
+    }
+
+    //! Loads all chunks and decodes them on many threads into resized container
+    /*! Chunks are taken by threads one by one, so thread which finished its chunk
+        takes the next one not decoded yet. When archive reads from memory buffer
+        chunks are used in place, otherwise all of them are copied first.
+        Exception thrown by any thread is rethrown after all threads finish. */
+    template <class T, class A> inline
+    void loadChunksParallel( ExtendableBinaryInputArchive & ar, std::vector<T, A> & container,
+                             std::vector<std::uint64_t> const & table, unsigned threads, std::true_type )
+    {
+      // offsets of chunks in archive and in container
+      std::vector<ArrayView<char>> chunks( table.size() );
+      std::vector<std::size_t> begins( table.size() );
+      std::size_t size = 0;
+      for( std::size_t ii = 0; ii < table.size(); ++ii )
+      {
+        ar( chunks[ii] );
+        if( table[ii] > chunks[ii].size() )
+          throw Exception("Number of elements doesn't match size of chunk");
+        begins[ii] = size;
+        size += static_cast<std::size_t>( table[ii] );
+      }
+      container.clear();
+      container.resize( size );
+
+      auto const & options = ar.getOptions();
+      std::atomic<std::size_t> next( 0 );
+      std::atomic<bool> failed( false );
+      std::exception_ptr error;
+      std::mutex errorMutex;
+      auto worker = [&]()
+      {
+        for( std::size_t ii = next++; ii < chunks.size() && false == failed; ii = next++ )
+        {
+          try
+          {
+            decodeChunk( container, begins[ii], table[ii], chunks[ii], options );
+          }
+          catch( ... )
+          {
+            std::lock_guard<std::mutex> lock( errorMutex );
+            if( false == failed.exchange( true ) )
+              error = std::current_exception();
+          }
+        }
+      };
+
+      std::vector<std::thread> workers;
+      const std::size_t started = std::min<std::size_t>( threads, chunks.size() ) - 1;
+      try
+      {
+        for( std::size_t ii = 0; ii < started; ++ii )
+          workers.emplace_back( worker );
+      }
+      catch( ... )
+      {
+        // thread couldn't be started, remaining chunks are decoded by threads already running
+      }
+      worker();
+      for( auto & w : workers )
+        w.join();
+      if( error )
+        std::rethrow_exception( error );
+    }
+
+    //! Elements without default constructor can't be decoded into preallocated slots,
+    //! chunks are loaded one after another
+    template <class T, class A> inline
+    void loadChunksParallel( ExtendableBinaryInputArchive & ar, std::vector<T, A> & container,
+                             std::vector<std::uint64_t> const & table, unsigned, std::false_type )
+    {
+      loadChunks( ar, container, table );
+    }
+  } // namespace extendable_binary_detail
+
+  //! Saving vector in chunks encoded in parallel to ExtendableBinary archive
+  template <class T> inline
+  void CEREAL_SAVE_FUNCTION_NAME( ExtendableBinaryOutputArchive & ar, ParallelChunks<T> const & chunks )
+  {
+    auto const & container = chunks.container;
+    const std::size_t size = container.size();
+    const std::size_t count = size / chunks.chunkElements + ( size % chunks.chunkElements != 0 ? 1 : 0 );
+
+    std::vector<std::uint64_t> table( count, chunks.chunkElements );
+    if( count > 0 )
+      table.back() = size - ( count - 1 ) * chunks.chunkElements;
+    ar( table );
+
+    const auto options = ar.getOptions();
+    std::deque<std::future<std::string>> pending;
+    std::size_t next = 0;
+    auto launch = [&]()
+    {
+      const std::size_t begin = next * chunks.chunkElements;
+      const std::size_t end = std::min( size, begin + chunks.chunkElements );
+      pending.push_back( std::async( std::launch::async, [&container, begin, end, &options]()
+        {
+          return extendable_binary_detail::encodeChunk( container, begin, end, options );
+        } ) );
+      ++next;
+    };
+
+    // futures of std::async wait for their threads when destroyed, also when exception is thrown
+    while( next < count && pending.size() < chunks.threads )
+      launch();
+    while( false == pending.empty() )
+    {
+      const std::string chunk = pending.front().get();
+      pending.pop_front();
+      if( next < count )
+        launch();
+      ar( ArrayView<char>( chunk ) );
+    }
+  }
+
+  //! Loading vector saved in chunks from ExtendableBinary archive
+  /*! Chunks are decoded on many threads, or one after another if wrapper allows one thread
+      or elements are not default constructible.
+      Chunk is used in place when archive reads from memory buffer, otherwise it's copied first. */
+  template <class T, class A> inline
+  void CEREAL_LOAD_FUNCTION_NAME( ExtendableBinaryInputArchive & ar, ParallelChunks<std::vector<T, A> &> & chunks )
+  {
+    std::vector<std::uint64_t> table;
+    ar( table );
+
+    chunks.container.clear();
+    if( chunks.threads > 1 && table.size() > 1 )
+      extendable_binary_detail::loadChunksParallel( ar, chunks.container, table, chunks.threads,
+                                                    std::is_default_constructible<T>() );
+    else
+      extendable_binary_detail::loadChunks( ar, chunks.container, table );
+  }
+
+  // ######################################################################
+  //! Loads containers saved with make_parallel_chunks() decoding their chunks on many threads
+  /*! Offsets of all chunks are found first, container is resized to hold all elements
+      and every thread decodes whole chunks into their elements. Ids of shared pointers and
+      polymorphic types are scoped to chunk, threads share only global registries of cereal.
+      Elements have to be default constructible to be decoded in parallel, vectors of
+      elements loaded with load_and_construct are decoded on calling thread.
+
+      Chunks are used in place when archive reads from memory buffer, when it reads from
+      stream whole saved container is copied to memory first.
+
+      @code{cpp}
+      cereal::ExtendableBinaryInputArchive archive( data, size );
+      cereal::ParallelExtendableBinaryLoader loader;
+      loader( archive, records );
+      @endcode
+
+      \ingroup Archives */
+  class ParallelExtendableBinaryLoader
+  {
+    public:
+      //! Construct loader
+      /*! @param threads number of threads decoding chunks, 0 to use number of hardware threads */
+      explicit ParallelExtendableBinaryLoader( unsigned threads = 0 ) :
+        itsThreads( threads != 0 ? threads : std::max( std::thread::hardware_concurrency(), 1u ) )
+      { }
+
+      //! Loads container saved with make_parallel_chunks() as next field of archive
+      /*! Throws Exception if data is not valid or exception thrown by loading of any element */
+      template <class T, class A>
+      void operator()( ExtendableBinaryInputArchive & ar, std::vector<T, A> & container ) const
+      {
+        ar( make_parallel_chunks( container, 1, itsThreads ) );
+      }
+
+      //! Number of threads decoding chunks
+      unsigned threads() const
+      {
+        return itsThreads;
+      }
+
+    private:
+      const unsigned itsThreads;
+  };
+} // namespace cereal
+
+#endif // CEREAL_ARCHIVES_EXTENDABLE_BINARY_PARALLEL_HPP_
@@ -0,0 +1,360 @@
+/*! \file extendable_binary_records.hpp
+    \brief Files of independent extendable binary records with index for random access */
+/*
+  Copyright (c) 2016, Randolph Voorhies, Shane Grant, Michal Breiter
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT OR MICHAL BREITER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_ARCHIVES_EXTENDABLE_BINARY_RECORDS_HPP_
+#define CEREAL_ARCHIVES_EXTENDABLE_BINARY_RECORDS_HPP_
+
+#include <cereal/archives/extendable_binary.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/vector.hpp>
+#include <cstring>
+#include <memory>
+#include <unordered_map>
+
+namespace cereal
+{
+  namespace extendable_binary_detail
+  {
+    //! Marks end of file with records, written after offset of index
+    static const char recordsMagic[8] = {'X', 'B', 'R', 'E', 'C', 'I', 'D', 'X'};
+
+    //! Size of data at the end of file with records: offset of index and recordsMagic
+    enum { recordsTrailerSize = 8 + sizeof(recordsMagic) };
+
+    //! Encodes trailer of file with records, offset is saved as little endian
+    inline void encodeRecordsTrailer(std::uint64_t indexOffset, char * trailer)
+    {
+      for(std::size_t ii = 0; ii < 8; ++ii)
+        trailer[ii] = static_cast<char>( ( indexOffset >> ( 8 * ii ) ) & 0xff );
+      std::memcpy(trailer + 8, recordsMagic, sizeof(recordsMagic));
+    }
+
+    //! Decodes offset of index from trailer of file with records
+    /*! Throws Exception if trailer doesn't end with recordsMagic */
+    inline std::uint64_t decodeRecordsTrailer(const char * trailer)
+    {
+      if(std::memcmp(trailer + 8, recordsMagic, sizeof(recordsMagic)) != 0)
+        throw Exception("Index of records not found");
+      std::uint64_t indexOffset = 0;
+      for(std::size_t ii = 0; ii < 8; ++ii)
+        indexOffset |= static_cast<std::uint64_t>( static_cast<std::uint8_t>( trailer[ii] ) ) << ( 8 * ii );
+      return indexOffset;
+    }
+  } // namespace extendable_binary_detail
+
+  // ######################################################################
+  //! Writes independent records followed by index of their offsets
+  /*! Every record is complete ExtendableBinary archive with its own header, shared pointers,
+      polymorphic types and class versions are tracked per record. After the last record index
+      is written as another archive with offsets of records and their optional keys, file ends
+      with offset of index and magic bytes. Records can be read in any order with
+      ExtendableBinaryRecordReader, or one after another by ExtendableBinaryInputArchive reset
+      to offset of record.
+
+      Index is saved with the same options as records, compressIntegerArrays makes offsets
+      take less space.
+
+      @code{cpp}
+      std::ofstream os( "events.bin", std::ios::binary );
+      cereal::ExtendableBinaryRecordWriter writer( os );
+      for( auto const & event : events )
+        writer.write( event.name, event );
+      writer.finish();
+      @endcode
+
+      \ingroup Archives */
+  class ExtendableBinaryRecordWriter
+  {
+    public:
+      using Options = ExtendableBinaryOutputArchive::Options;
+
+      //! Construct, outputting to the provided stream
+      /*! Offsets of records are counted from the current position of stream.
+          @param stream The stream to output to. Should be opened with std::ios::binary flag.
+          @param options The ExtendableBinary specific options of records and index */
+      ExtendableBinaryRecordWriter(std::ostream & stream, Options const & options = Options::Default()) :
+        itsStream(stream),
+        itsArchive(stream, options),
+        itsSize(0),
+        itsFinished(false)
+      { }
+
+      //! Writes index if finish() was not called
+      /*! Errors are not reported here, finish() has to be used to check if index was written */
+      ~ExtendableBinaryRecordWriter() CEREAL_NOEXCEPT
+      {
+        if(itsFinished)
+          return;
+        try {
+          finish();
+        } catch(...) {
+        }
+      }
+
+      ExtendableBinaryRecordWriter(ExtendableBinaryRecordWriter const &) = delete;
+      ExtendableBinaryRecordWriter & operator=(ExtendableBinaryRecordWriter const &) = delete;
+
+      //! Writes record without key
+      /*! Record is written to stream before function returns. If saving of record throws,
+          record is not added to index and its data already written to stream is not used.
+          @return index of record */
+      template <class T>
+      std::size_t write(T const & record)
+      {
+        return writeRecord(nullptr, record);
+      }
+
+      //! Writes record which can be found by key
+      /*! @param key key of record, empty key is not indexed
+          @see write(T const &) */
+      template <class T>
+      std::size_t write(std::string const & key, T const & record)
+      {
+        return writeRecord(&key, record);
+      }
+
+      //! Gets number of written records
+      std::size_t size() const
+      {
+        return itsOffsets.size();
+      }
+
+      //! Writes index and trailer, no records can be written after it
+      /*! Throws Exception if data cannot be written to stream */
+      void finish()
+      {
+        if(itsFinished)
+          throw Exception("Index of records was already written");
+        itsFinished = true;
+        if(false == itsKeys.empty())
+          itsKeys.resize(itsOffsets.size());
+
+        const std::uint64_t indexOffset = itsSize;
+        itsArchive(itsOffsets, itsKeys);
+        itsArchive.flush();
+
+        char trailer[extendable_binary_detail::recordsTrailerSize];
+        extendable_binary_detail::encodeRecordsTrailer(indexOffset, trailer);
+        const auto writtenSize = static_cast<std::size_t>( itsStream.rdbuf()->sputn( trailer, sizeof(trailer) ) );
+        if(writtenSize != sizeof(trailer))
+          throw Exception("Failed to write index of records to output stream");
+        itsStream.flush();
+      }
+
+    private:
+      template <class T>
+      std::size_t writeRecord(std::string const * key, T const & record)
+      {
+        if(itsFinished)
+          throw Exception("Record can't be written after index");
+        try {
+          itsArchive(record);
+          itsArchive.flush();
+        } catch(...) {
+          // data already written stays in stream without entry in index
+          itsSize += itsArchive.writtenSize();
+          itsArchive.reset(itsStream);
+          throw;
+        }
+
+        itsOffsets.push_back(itsSize);
+        itsSize += itsArchive.savedSize();
+        if(key != nullptr && false == key->empty()) {
+          itsKeys.resize(itsOffsets.size());
+          itsKeys.back() = *key;
+        }
+        // header of next record or index
+        itsArchive.reset(itsStream);
+        return itsOffsets.size() - 1;
+      }
+
+      std::ostream & itsStream;
+      ExtendableBinaryOutputArchive itsArchive;
+      std::uint64_t itsSize; //!< bytes written so far
+      std::vector<std::uint64_t> itsOffsets;
+      std::vector<std::string> itsKeys; //!< empty if no record has key
+      bool itsFinished;
+  };
+
+  // ######################################################################
+  //! Reads records written by ExtendableBinaryRecordWriter in any order
+  /*! Index is loaded when reader is constructed. Every record is loaded by itself, earlier
+      records are not read. Stream has to be seekable, records are read after seeking to their
+      offset. Records in memory buffer are read in place.
+
+      @code{cpp}
+      cereal::ExtendableBinaryRecordReader reader( data, size );
+      Event event;
+      reader.read( reader.find( "login" ), event );
+      @endcode
+
+      \ingroup Archives */
+  class ExtendableBinaryRecordReader
+  {
+    public:
+      using Options = ExtendableBinaryInputArchive::Options;
+
+      //! Construct, loading index from the provided stream
+      /*! Records are expected from the current position of stream to its end.
+          Throws Exception if stream is not seekable or doesn't end with index.
+          @param stream The stream to read from. Should be opened with std::ios::binary flag.
+          @param options The ExtendableBinary specific options used for index and records */
+      ExtendableBinaryRecordReader(std::istream & stream, Options const & options = Options::Default()) :
+        itsStream(&stream),
+        itsData(nullptr),
+        itsStart(stream.tellg())
+      {
+        stream.seekg(0, std::ios::end);
+        const auto end = stream.tellg();
+        if(itsStart == std::streampos(-1) || end == std::streampos(-1) || end < itsStart)
+          throw Exception("Records can be read only from seekable stream");
+        const auto size = static_cast<std::uint64_t>(end - itsStart);
+        if(size < extendable_binary_detail::recordsTrailerSize)
+          throw Exception("Data is too small to contain index of records");
+
+        char trailer[extendable_binary_detail::recordsTrailerSize];
+        seek(size - sizeof(trailer));
+        if(stream.rdbuf()->sgetn(trailer, sizeof(trailer)) != static_cast<std::streamsize>(sizeof(trailer)))
+          throw Exception("Failed to read index of records from input stream");
+        itsIndexOffset = checkedIndexOffset(extendable_binary_detail::decodeRecordsTrailer(trailer), size);
+
+        seek(itsIndexOffset);
+        itsArchive.reset(new ExtendableBinaryInputArchive(stream, options));
+        loadIndex();
+      }
+
+      //! Construct, loading index from the provided memory buffer
+      /*! Throws Exception if data doesn't end with index.
+          @param data The beginning of records. Has to be valid for whole reader lifetime.
+          @param size The size of data in bytes
+          @param options The ExtendableBinary specific options used for index and records */
+      ExtendableBinaryRecordReader(const void * data, std::size_t size, Options const & options = Options::Default()) :
+        itsStream(nullptr),
+        itsData(reinterpret_cast<const char *>(data)),
+        itsStart(0)
+      {
+        if(size < extendable_binary_detail::recordsTrailerSize)
+          throw Exception("Data is too small to contain index of records");
+        const std::uint64_t indexOffset = extendable_binary_detail::decodeRecordsTrailer(
+            itsData + size - extendable_binary_detail::recordsTrailerSize);
+        itsIndexOffset = checkedIndexOffset(indexOffset, size);
+
+        itsArchive.reset(new ExtendableBinaryInputArchive(itsData + itsIndexOffset,
+            static_cast<std::size_t>(size - extendable_binary_detail::recordsTrailerSize - itsIndexOffset), options));
+        loadIndex();
+      }
+
+      //! Gets number of records
+      std::size_t size() const
+      {
+        return itsOffsets.size();
+      }
+
+      //! Gets index of first record with key, size() if there is no such record
+      std::size_t find(std::string const & key) const
+      {
+        auto const found = itsKeyIndex.find(key);
+        return found == itsKeyIndex.end() ? size() : found->second;
+      }
+
+      //! Gets key of record, empty if record was written without key
+      std::string const & key(std::size_t index) const
+      {
+        static const std::string empty;
+        return index < itsKeys.size() ? itsKeys[index] : empty;
+      }
+
+      //! Loads record
+      /*! Fields of record unknown to reader are skipped as in any other archive.
+          Throws Exception if index is out of range or record cannot be loaded.
+          @param index index of record, order in which records were written
+          @param record object to load record into */
+      template <class T>
+      void read(std::size_t index, T & record)
+      {
+        if(index >= size())
+          throw Exception("Record " + std::to_string(index) + " doesn't exist, number of records: " + std::to_string(size()));
+        const std::uint64_t offset = itsOffsets[index];
+        if(itsStream != nullptr) {
+          seek(offset);
+          itsArchive->reset(*itsStream);
+        } else {
+          const std::uint64_t end = index + 1 < size() ? itsOffsets[index + 1] : itsIndexOffset;
+          itsArchive->reset(itsData + offset, static_cast<std::size_t>(end - offset));
+        }
+        (*itsArchive)(record);
+      }
+
+    private:
+      //! Checks that index starts inside data of given size
+      static std::uint64_t checkedIndexOffset(std::uint64_t indexOffset, std::uint64_t size)
+      {
+        if(indexOffset > size - extendable_binary_detail::recordsTrailerSize)
+          throw Exception("Offset of index of records is too big");
+        return indexOffset;
+      }
+
+      //! Sets position of stream to offset from beginning of records
+      void seek(std::uint64_t offset)
+      {
+        itsStream->clear();
+        itsStream->seekg(itsStart + static_cast<std::streamoff>(offset));
+        if(itsStream->fail())
+          throw Exception("Failed to seek to offset " + std::to_string(offset) + " of records");
+      }
+
+      //! Loads offsets and keys of records from archive positioned at index
+      void loadIndex()
+      {
+        (*itsArchive)(itsOffsets, itsKeys);
+        std::uint64_t previous = 0;
+        for(auto const offset : itsOffsets) {
+          if(offset < previous || offset > itsIndexOffset)
+            throw Exception("Offsets of records are corrupted");
+          previous = offset;
+        }
+        if(false == itsKeys.empty() && itsKeys.size() != itsOffsets.size())
+          throw Exception("Number of keys doesn't match number of records");
+        for(std::size_t ii = 0; ii < itsKeys.size(); ++ii) {
+          if(false == itsKeys[ii].empty())
+            itsKeyIndex.emplace(itsKeys[ii], ii);
+        }
+      }
+
+      std::istream * itsStream; //!< stream with records, nullptr if records are in memory
+      const char * itsData; //!< memory with records, nullptr if records are read from stream
+      std::streampos itsStart; //!< position of first record in stream
+      std::uint64_t itsIndexOffset;
+      std::unique_ptr<ExtendableBinaryInputArchive> itsArchive; //!< reset to every read record
+      std::vector<std::uint64_t> itsOffsets;
+      std::vector<std::string> itsKeys; //!< empty if no record has key
+      std::unordered_map<std::string, std::size_t> itsKeyIndex;
+  };
+} // namespace cereal
+
+#endif // CEREAL_ARCHIVES_EXTENDABLE_BINARY_RECORDS_HPP_
@@ -243,6 +243,9 @@ namespace cereal
       void saveValue(double d)              { itsWriter.Double(d);                                                       }
       //! Saves a string to the current node
       void saveValue(std::string const & s) { itsWriter.String(s.c_str(), static_cast<rapidjson::SizeType>( s.size() )); }
+      //! Saves a string with a custom allocator (e.g. std::pmr::string) to the current node
+      template <class Alloc>
+      void saveValue(std::basic_string<char, std::char_traits<char>, Alloc> const & s) { itsWriter.String(s.c_str(), static_cast<rapidjson::SizeType>( s.size() )); }
       //! Saves a const char * to the current node
       void saveValue(char const * s)        { itsWriter.String(s);                                                       }
       //! Saves a nullptr to the current node
@@ -632,6 +635,15 @@ namespace cereal
       void loadValue(double & val)      { search(); val = itsIteratorStack.back().value().GetDouble(); ++itsIteratorStack.back(); }
       //! Loads a value from the current node - string overload
       void loadValue(std::string & val) { search(); val = itsIteratorStack.back().value().GetString(); ++itsIteratorStack.back(); }
+      //! Loads a value from the current node - string with a custom allocator (e.g. std::pmr::string) overload
+      template <class Alloc>
+      void loadValue(std::basic_string<char, std::char_traits<char>, Alloc> & val)
+      {
+        search();
+        auto const & value = itsIteratorStack.back().value();
+        val.assign( value.GetString(), value.GetStringLength() );
+        ++itsIteratorStack.back();
+      }
       //! Loads a nullptr from the current node
       void loadValue(std::nullptr_t&)   { search(); CEREAL_RAPIDJSON_ASSERT(itsIteratorStack.back().value().IsNull()); ++itsIteratorStack.back(); }
 
@@ -30,6 +30,7 @@
 #define CEREAL_ARCHIVES_PORTABLE_BINARY_HPP_
 
 #include <cereal/cereal.hpp>
+#include <cereal/details/byte_swap.hpp>
 #include <sstream>
 #include <limits>
 
@@ -52,8 +53,7 @@ namespace cereal
     template <std::size_t DataSize>
     inline void swap_bytes( std::uint8_t * data )
     {
-      for( std::size_t i = 0, end = DataSize / 2; i < end; ++i )
-        std::swap( data[i], data[DataSize - i - 1] );
+      detail::ByteSwap<DataSize>::swap( data, data );
     }
   } // end namespace portable_binary_detail
 
@@ -135,9 +135,22 @@ namespace cereal
 
         if( itsConvertEndianness )
         {
-          for( std::size_t i = 0; i < size; i += DataSize )
-            for( std::size_t j = 0; j < DataSize; ++j )
-              writtenSize += static_cast<std::size_t>( itsStream.rdbuf()->sputn( reinterpret_cast<const char*>( data ) + DataSize - j - 1 + i, 1 ) );
+          // swap in chunks of whole elements, write each chunk at once
+          std::uint8_t buffer[(1024 / DataSize + 1) * DataSize];
+          const std::size_t chunkElements = sizeof(buffer) / DataSize;
+          const std::uint8_t * src = reinterpret_cast<const std::uint8_t*>( data );
+          for( std::size_t left = size / DataSize; left > 0; )
+          {
+            const std::size_t elements = left < chunkElements ? left : chunkElements;
+            detail::swap_bytes_copy<DataSize>( buffer, src, elements );
+            const std::size_t chunkSize = elements * DataSize;
+            const std::size_t written = static_cast<std::size_t>( itsStream.rdbuf()->sputn( reinterpret_cast<const char*>( buffer ), chunkSize ) );
+            writtenSize += written;
+            if( written != chunkSize )
+              break;
+            src += chunkSize;
+            left -= elements;
+          }
         }
         else
           writtenSize = static_cast<std::size_t>( itsStream.rdbuf()->sputn( reinterpret_cast<const char*>( data ), size ) );
@@ -246,11 +259,7 @@ namespace cereal
 
         // flip bits if needed
         if( itsConvertEndianness )
-        {
-          std::uint8_t * ptr = reinterpret_cast<std::uint8_t*>( data );
-          for( std::size_t i = 0; i < size; i += DataSize )
-            portable_binary_detail::swap_bytes<DataSize>( ptr + i );
-        }
+          detail::swap_bytes_inplace<DataSize>( data, size / DataSize );
       }
 
     private:
@@ -42,6 +42,7 @@
 #include <cereal/macros.hpp>
 #include <cereal/details/traits.hpp>
 #include <cereal/details/helpers.hpp>
+#include <cereal/details/pointer_tables.hpp>
 #include <cereal/types/base_class.hpp>
 
 namespace cereal
@@ -322,15 +323,37 @@ namespace cereal
         // Handle null pointers by just returning 0
         if(addr == 0) return 0;
 
-        auto id = itsSharedPointerMap.find( addr );
-        if( id == itsSharedPointerMap.end() )
+        auto id = itsSharedPointerMap.insert( addr, itsCurrentPointerId );
+        if( id.second )
         {
-          auto ptrId = itsCurrentPointerId++;
-          itsSharedPointerMap.insert( {addr, ptrId} );
-          return ptrId | detail::msb_32bit; // mask MSB to be 1
+          ++itsCurrentPointerId;
+          return id.first | detail::msb_32bit; // mask MSB to be 1
         }
         else
-          return id->second;
+          return id.first;
+      }
+
+      //! Reserves space for tracking given number of shared pointers
+      /*! Registering up to count distinct pointers won't allocate memory.
+          @param count Expected number of distinct shared pointers */
+      inline void reserveSharedPointers( std::size_t count )
+      {
+        itsSharedPointerMap.reserve( count );
+      }
+
+      //! Forgets all tracked shared pointers, polymorphic types and class versions
+      /*! Data saved afterwards doesn't refer to data saved before, so it can be loaded
+          by input archive which was reset at the same position. Memory used by tracking
+          tables is kept, archive reused for many messages doesn't allocate it again.
+          Derived archive has to reset its own state. */
+      inline void resetTracking()
+      {
+        itsBaseClassSet.clear();
+        itsSharedPointerMap.clear();
+        itsCurrentPointerId = 1;
+        itsPolymorphicTypeMap.clear();
+        itsCurrentPolymorphicTypeId = 1;
+        itsVersionedTypes.clear();
       }
 
       //! Registers a polymorphic type name with the archive
@@ -509,6 +532,25 @@ namespace cereal
         return *self;
       }
 
+      //! Gets version of class from global version registry
+      /*! Registry is searched only once per type, result is kept in function local static.
+          Later calls don't lock registry mutex and don't hash type.
+          Registry is always locked, archives saving different types can run on many
+          threads even if cereal is not compiled with CEREAL_THREAD_SAFE.
+          @tparam T The type of the class being serialized */
+      template <class T> inline
+      static std::uint32_t getRegisteredClassVersion()
+      {
+        static const std::uint32_t version = []()
+        {
+          const auto hash = std::type_index(typeid(T)).hash_code();
+          auto & versions = detail::StaticObject<detail::Versions>::getInstance();
+          std::lock_guard<std::mutex> lock( versions.findMutex );
+          return versions.find( hash, detail::Version<T>::version );
+        }();
+        return version;
+      }
+
       //! Registers a class version with the archive and serializes it if necessary
       /*! If this is the first time this class has been serialized, we will record its
           version number and serialize that.
@@ -520,9 +562,7 @@ namespace cereal
       {
         static const auto hash = std::type_index(typeid(T)).hash_code();
         const auto insertResult = itsVersionedTypes.insert( hash );
-        const auto lock = detail::StaticObject<detail::Versions>::lock();
-        const auto version =
-          detail::StaticObject<detail::Versions>::getInstance().find( hash, detail::Version<T>::version );
+        const auto version = getRegisteredClassVersion<T>();
 
         if( insertResult.second ) // insertion took place, serialize the version number
           process( make_nvp<ArchiveType>("cereal_class_version", detail::VersionIdTag<T>(version)) );
@@ -545,10 +585,7 @@ namespace cereal
       template <class T> inline typename
       std::uint32_t registerClassVersionImpl(std::true_type)
       {
-        static const auto hash = std::type_index(typeid(T)).hash_code();
-        const auto lock = detail::StaticObject<detail::Versions>::lock();
-        const auto version =
-            detail::StaticObject<detail::Versions>::getInstance().find( hash, detail::Version<T>::version );
+        const auto version = getRegisteredClassVersion<T>();
         process( make_nvp<ArchiveType>("cereal_class_version", detail::VersionIdTag<T>(version)) );
         return version;
       }
@@ -623,7 +660,7 @@ namespace cereal
       std::unordered_set<traits::detail::base_class_id, traits::detail::base_class_id_hash> itsBaseClassSet;
 
       //! Maps from addresses to pointer ids
-      std::unordered_map<void const *, std::uint32_t> itsSharedPointerMap;
+      detail::OutputPointerTable itsSharedPointerMap;
 
       //! The id to be given to the next pointer
       std::uint32_t itsCurrentPointerId;
@@ -665,7 +702,7 @@ namespace cereal
         self(derived),
         itsBaseClassSet(),
         itsSharedPointerMap(),
-        itsPolymorphicTypeMap(),
+        itsPolymorphicTypes(),
         itsVersionedTypes(),
         wasLastFieldSerialized(FieldSerialized::YES)
       { }
@@ -721,11 +758,11 @@ namespace cereal
       {
         if(id == 0) return std::shared_ptr<void>(nullptr);
 
-        auto iter = itsSharedPointerMap.find( id );
-        if(iter == itsSharedPointerMap.end())
+        auto ptr = itsSharedPointerMap.find( id );
+        if(ptr == nullptr)
           throw Exception("Error while trying to deserialize a smart pointer. Could not find id " + std::to_string(id));
 
-        return iter->second;
+        return *ptr;
       }
 
       //! Registers a shared pointer to its unique identifier
@@ -737,7 +774,55 @@ namespace cereal
       inline void registerSharedPointer(std::uint32_t const id, std::shared_ptr<void> ptr)
       {
         std::uint32_t const stripped_id = id & ~detail::msb_32bit;
-        itsSharedPointerMap[stripped_id] = ptr;
+        itsSharedPointerMap.set( stripped_id, std::move(ptr) );
+      }
+
+      //! Reserves space for tracking given number of shared pointers
+      /*! Registering up to count pointers with consecutive ids won't allocate memory.
+          @param count Expected number of distinct shared pointers */
+      inline void reserveSharedPointers( std::size_t count )
+      {
+        itsSharedPointerMap.reserve( count );
+      }
+
+      //! Forgets all loaded shared pointers, polymorphic types and class versions
+      /*! Has to be called at the same position in data as OutputArchive::resetTracking
+          was called when saving. Memory used by tracking tables is kept, archive reused
+          for many messages doesn't allocate it again. Derived archive has to reset its own state. */
+      inline void resetTracking()
+      {
+        itsBaseClassSet.clear();
+        itsSharedPointerMap.clear();
+        itsPolymorphicTypes.clear();
+        itsVersionedTypes.clear();
+      }
+
+      //! Polymorphic type registered with the archive during loading
+      /*! @internal */
+      struct PolymorphicType
+      {
+        std::string name;               //!< name of the type
+        void const * binding = nullptr; //!< input binding for name, valid if resolved is set
+        bool registered = false;        //!< if name was loaded for this id
+        bool resolved = false;          //!< if binding was looked up already
+      };
+
+      //! Retrieves registered polymorphic type given a unique key for it
+      /*! Types are kept in table indexed by id. Binding found for type's name
+          can be cached in returned object, so later pointers of the same type
+          don't need to compare strings.
+
+          @internal
+          @param id The unique id that was serialized for the polymorphic type
+          @return The registered type */
+      inline PolymorphicType & getPolymorphicType(std::uint32_t const id)
+      {
+        std::uint32_t const stripped_id = id & ~detail::msb_32bit;
+        if(stripped_id >= itsPolymorphicTypes.size() || false == itsPolymorphicTypes[stripped_id].registered)
+        {
+          throw Exception("Error while trying to deserialize a polymorphic pointer. Could not find type id " + std::to_string(id));
+        }
+        return itsPolymorphicTypes[stripped_id];
       }
 
       //! Retrieves the string for a polymorphic type given a unique key for it
@@ -746,26 +831,35 @@ namespace cereal
 
           @param id The unique id that was serialized for the polymorphic type
           @return The string identifier for the type */
-      inline std::string getPolymorphicName(std::uint32_t const id)
+      inline std::string const & getPolymorphicName(std::uint32_t const id)
       {
-        auto name = itsPolymorphicTypeMap.find( id );
-        if(name == itsPolymorphicTypeMap.end())
-        {
-          throw Exception("Error while trying to deserialize a polymorphic pointer. Could not find type id " + std::to_string(id));
-        }
-        return name->second;
+        return getPolymorphicType(id).name;
       }
 
       //! Registers a polymorphic name string to its unique identifier
       /*! After a polymorphic type has been loaded for the first time, it should
           be registered with its loaded id for future references to it.
+          Ids are assigned consecutively when saving, id much bigger than
+          number of already registered types results in exception.
 
           @param id The unique identifier for the polymorphic type
           @param name The name associated with the tyep */
       inline void registerPolymorphicName(std::uint32_t const id, std::string const & name)
       {
         std::uint32_t const stripped_id = id & ~detail::msb_32bit;
-        itsPolymorphicTypeMap.insert( {stripped_id, name} );
+        if(stripped_id >= itsPolymorphicTypes.size())
+        {
+          if(stripped_id - itsPolymorphicTypes.size() > maxPolymorphicIdGap)
+            throw Exception("Invalid polymorphic type id " + std::to_string(stripped_id));
+          itsPolymorphicTypes.resize(stripped_id + 1);
+        }
+
+        auto & type = itsPolymorphicTypes[stripped_id];
+        if(false == type.registered)
+        {
+          type.name = name;
+          type.registered = true;
+        }
       }
 
       //! Indicates if last field was loaded
@@ -1081,10 +1175,13 @@ namespace cereal
       std::unordered_set<traits::detail::base_class_id, traits::detail::base_class_id_hash> itsBaseClassSet;
 
       //! Maps from pointer ids to metadata
-      std::unordered_map<std::uint32_t, std::shared_ptr<void>> itsSharedPointerMap;
+      detail::InputPointerTable itsSharedPointerMap;
+
+      //! Maximal distance between new polymorphic id and last known one
+      static const std::uint32_t maxPolymorphicIdGap = 64;
 
-      //! Maps from name ids to names
-      std::unordered_map<std::uint32_t, std::string> itsPolymorphicTypeMap;
+      //! Registered polymorphic types indexed by name id
+      std::vector<PolymorphicType> itsPolymorphicTypes;
 
       //! Maps from type hash codes to version numbers
       std::unordered_map<std::size_t, std::uint32_t> itsVersionedTypes;
@@ -0,0 +1,168 @@
+/*! \file byte_swap.hpp
+    \brief Bulk byte order swapping used by binary archives
+    \ingroup Internal */
+/*
+  Copyright (c) 2016, Randolph Voorhies, Shane Grant, Michal Breiter
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT OR MICHAL BREITER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_DETAILS_BYTE_SWAP_HPP_
+#define CEREAL_DETAILS_BYTE_SWAP_HPP_
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
+namespace cereal
+{
+  namespace detail
+  {
+    //! Reverses order of bytes in single element
+    /*! @internal */
+    template <std::size_t DataSize> struct ByteSwap
+    {
+      static inline void swap( std::uint8_t * dest, const std::uint8_t * src )
+      {
+        std::uint8_t tmp[DataSize];
+        for( std::size_t i = 0; i < DataSize; ++i )
+          tmp[i] = src[DataSize - i - 1];
+        std::memcpy( dest, tmp, DataSize );
+      }
+    };
+
+    template <> struct ByteSwap<1>
+    {
+      static inline void swap( std::uint8_t * dest, const std::uint8_t * src )
+      { *dest = *src; }
+    };
+
+#if defined(__GNUC__) || defined(__clang__)
+    //! Scalar swap with compiler intrinsic
+    /*! @internal */
+    template <class T, T(*Swap)(T)> struct ByteSwapBuiltin
+    {
+      static inline void swap( std::uint8_t * dest, const std::uint8_t * src )
+      {
+        T v;
+        std::memcpy( &v, src, sizeof(T) );
+        v = Swap( v );
+        std::memcpy( dest, &v, sizeof(T) );
+      }
+    };
+
+    inline std::uint16_t bswap16( std::uint16_t v ) { return __builtin_bswap16( v ); }
+    inline std::uint32_t bswap32( std::uint32_t v ) { return __builtin_bswap32( v ); }
+    inline std::uint64_t bswap64( std::uint64_t v ) { return __builtin_bswap64( v ); }
+
+    template <> struct ByteSwap<2> : ByteSwapBuiltin<std::uint16_t, bswap16> {};
+    template <> struct ByteSwap<4> : ByteSwapBuiltin<std::uint32_t, bswap32> {};
+    template <> struct ByteSwap<8> : ByteSwapBuiltin<std::uint64_t, bswap64> {};
+#endif
+
+#if defined(__AVX2__) || defined(__SSSE3__)
+    //! Shuffle mask reversing bytes of each DataSize element in 16 byte block
+    /*! @internal */
+    template <std::size_t DataSize>
+    inline __m128i byte_swap_mask()
+    {
+      alignas(16) std::uint8_t mask[16];
+      for( std::size_t i = 0; i < 16; ++i )
+        mask[i] = static_cast<std::uint8_t>( i - i % DataSize + DataSize - 1 - i % DataSize );
+      return _mm_load_si128( reinterpret_cast<const __m128i *>( mask ) );
+    }
+
+    //! Swaps bytes of whole 16 (or 32 with AVX2) byte blocks
+    /*! @return number of processed bytes
+        @internal */
+    template <std::size_t DataSize>
+    inline std::size_t swap_bytes_simd( std::uint8_t * dest, const std::uint8_t * src, std::size_t size )
+    {
+      const __m128i mask = byte_swap_mask<DataSize>();
+      std::size_t i = 0;
+#if defined(__AVX2__)
+      const __m256i mask256 = _mm256_broadcastsi128_si256( mask );
+      for( ; i + 32 <= size; i += 32 )
+      {
+        const __m256i v = _mm256_loadu_si256( reinterpret_cast<const __m256i *>( src + i ) );
+        _mm256_storeu_si256( reinterpret_cast<__m256i *>( dest + i ), _mm256_shuffle_epi8( v, mask256 ) );
+      }
+#endif
+      for( ; i + 16 <= size; i += 16 )
+      {
+        const __m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i *>( src + i ) );
+        _mm_storeu_si128( reinterpret_cast<__m128i *>( dest + i ), _mm_shuffle_epi8( v, mask ) );
+      }
+      return i;
+    }
+#endif
+
+    //! Copies count elements of DataSize bytes from src to dest reversing byte order of each element
+    /*! src and dest can point to the same memory, otherwise they cannot overlap.
+        For element sizes 2, 4, 8 and 16 SSSE3 or AVX2 shuffles are used when enabled
+        at compile time, rest of data is swapped one element at a time.
+        @param dest destination address
+        @param src source address
+        @param count number of elements
+        @tparam DataSize size of single element
+        @internal */
+    template <std::size_t DataSize>
+    inline void swap_bytes_copy( void * dest, const void * src, std::size_t count )
+    {
+      std::uint8_t * d = reinterpret_cast<std::uint8_t *>( dest );
+      const std::uint8_t * s = reinterpret_cast<const std::uint8_t *>( src );
+      const std::size_t size = count * DataSize;
+      if( DataSize == 1 )
+      {
+        if( d != s )
+          std::memcpy( d, s, size );
+        return;
+      }
+      std::size_t i = 0;
+#if defined(__AVX2__) || defined(__SSSE3__)
+      if( DataSize == 2 || DataSize == 4 || DataSize == 8 || DataSize == 16 )
+        i = swap_bytes_simd<DataSize>( d, s, size );
+#endif
+      for( ; i < size; i += DataSize )
+        ByteSwap<DataSize>::swap( d + i, s + i );
+    }
+
+    //! Reverses byte order of each element in place
+    /*! @param data address of first element
+        @param count number of elements
+        @tparam DataSize size of single element
+        @internal */
+    template <std::size_t DataSize>
+    inline void swap_bytes_inplace( void * data, std::size_t count )
+    {
+      swap_bytes_copy<DataSize>( data, data, count );
+    }
+  } // namespace detail
+} // namespace cereal
+
+#endif // CEREAL_DETAILS_BYTE_SWAP_HPP_
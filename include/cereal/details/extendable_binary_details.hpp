@@ -30,10 +30,21 @@
 #define CEREAL_DETAILS_EXTENDABLE_BINARY_DETAILS_HPP_
 
 #include <cereal/cereal.hpp>
+#include <cereal/details/byte_swap.hpp>
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <istream>
 #include <limits>
-#include <sstream>
-#include <queue>
-#include <assert.h>
+#include <memory>
+#include <vector>
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
 namespace cereal
 {
@@ -54,8 +65,7 @@ namespace cereal
     template <std::size_t DataSize>
     inline void swap_bytes( std::uint8_t * data )
     {
-      for( std::size_t i = 0, end = DataSize / 2; i < end; ++i )
-        std::swap( data[i], data[DataSize - i - 1] );
+      detail::ByteSwap<DataSize>::swap( data, data );
     }
 
     //! Describes type of saved field
@@ -89,11 +99,19 @@ namespace cereal
         /*!< packed array (1000 | size of elem)
             e.g. string */
             packed_array = 0x8,
-        /*!< struct (1001) */
+        /*!< packed struct (1001 | markers) @see PackedStructMarkers
+            Trivially copyable struct or array of them saved as raw memory.
+            Layout of struct is saved before data @see PackedLayout */
             packed_struct = 0x9,
         /*!< was last field in class (1010)
          (not optional fields, class id) */
             last_field = 0xa,
+        /*!< compressed integer array (1011 | signed | encoding) @see IntegerArrayEncoding
+            Number of elements and size of encoded data in bytes are saved as varints before data */
+            integer_array = 0xb,
+        /*!< bit array (1100)
+            Number of bits as varint followed by bits packed into bytes, least significant bit first */
+            bit_array = 0xc,
         LAST_RESERVED_UNUSED
     };
 
@@ -149,6 +167,71 @@ namespace cereal
       return static_cast<std::uint8_t>(l) & static_cast<std::uint8_t>(r);
     }
 
+    //! Markers for FieldType::packed_struct
+    /*! Max size is four bits */
+    enum class PackedStructMarkers : std::uint8_t
+    {
+        /*!< Single struct */
+            None = 0,
+        /*!< Array of structs, number of elements as varint is saved after layout */
+            IsArray = 0x1 << 0
+    };
+
+    inline std::uint8_t operator&(std::uint8_t l, PackedStructMarkers r)
+    {
+      return l & static_cast<std::uint8_t>(r);
+    }
+
+    //! Encodings of FieldType::integer_array
+    /*! Saved on two least significant bits of type tag */
+    enum class IntegerArrayEncoding : std::uint8_t
+    {
+        /*!< Every element saved as varint, zig-zag encoded for signed types */
+            varint = 0,
+        /*!< Frame of reference: minimal value as varint (zig-zag encoded for signed types),
+             one byte with number of bits per element and differences from minimal value
+             packed into that number of bits, least significant bits first */
+            bit_packed = 1,
+        /*!< First element and differences between consecutive elements saved as
+             zig-zag encoded varints, first element is zig-zag encoded only for signed types */
+            delta = 2
+    };
+
+    //! Markers for FieldType::integer_array
+    enum class IntegerArrayMarkers : std::uint8_t
+    {
+        /*!< Elements of array are signed */
+            IsSigned = 0x1 << 2,
+        /*!< Mask of bits used by IntegerArrayEncoding */
+            EncodingMask = 0x3
+    };
+
+    inline std::uint8_t operator&(std::uint8_t l, IntegerArrayMarkers r)
+    {
+      return l & static_cast<std::uint8_t>(r);
+    }
+
+    //! Flags saved in archive header
+    enum class HeaderFlags : std::uint8_t
+    {
+        /*!< Data is saved in little endian order */
+            LittleEndian = 0x1 << 0,
+        /*!< Data of every class_t and pointer object with fields is preceded by its length.
+             Length is saved as varint after object metadata, @see encodeObjectLength() */
+            LengthPrefixedObjects = 0x1 << 1,
+        /*!< Keys of ordered associative containers (std::set, std::map and multi variants) with integer keys and
+             std::vector of std::chrono::time_point are saved as size and one FieldType::integer_array field,
+             values of maps are saved after it as fields */
+            DeltaEncodedKeys = 0x1 << 2,
+        /*!< std::vector<bool> and std::bitset are saved as one FieldType::bit_array field */
+            PackedBits = 0x1 << 3
+    };
+
+    inline std::uint8_t operator&(std::uint8_t l, HeaderFlags r)
+    {
+      return l & static_cast<std::uint8_t>(r);
+    }
+
     //! max size of saved varint
     /*! enough to save uint64_t 8 */
     enum { maxVarintSize = 10 };
@@ -165,14 +248,151 @@ namespace cereal
       return std::make_pair(static_cast<FieldType>(fieldType), (0xf & input));
     }
 
-    //! Get number of bytes needed to save value.
-    /*! TODO can be done quicker http://stackoverflow.com/questions/2274428/how-to-determine-how-many-bytes-an-integer-needs
-       \param v value to check
+    //! Loads 8 bytes from memory as little endian value
+    inline std::uint64_t loadLittleEndian64(const std::uint8_t * data)
+    {
+      std::uint64_t word;
+      std::memcpy(&word, data, sizeof(word));
+      if(false == is_little_endian())
+        swap_bytes<sizeof(word)>(reinterpret_cast<std::uint8_t *>(&word));
+      return word;
+    }
+
+    //! Gets index of the lowest set bit, value cannot be 0
+    inline std::size_t countTrailingZeros(std::uint64_t value)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+      return static_cast<std::size_t>(__builtin_ctzll(value));
+#elif defined(_MSC_VER) && defined(_M_X64)
+      unsigned long index;
+      _BitScanForward64(&index, value);
+      return index;
+#else
+      std::size_t index = 0;
+      for(; (value & 1) == 0; value >>= 1)
+        ++index;
+      return index;
+#endif
+    }
+
+    //! Gets index of the highest set bit counted from the most significant one, value cannot be 0
+    inline std::size_t countLeadingZeros(std::uint64_t value)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+      return static_cast<std::size_t>(__builtin_clzll(value));
+#elif defined(_MSC_VER) && defined(_M_X64)
+      unsigned long index;
+      _BitScanReverse64(&index, value);
+      return 63 - index;
+#else
+      std::size_t count = 0;
+      for(; (value & 0x8000000000000000ULL) == 0; value <<= 1)
+        ++count;
+      return count;
+#endif
+    }
+
+    //! Gathers lower seven bits of each byte into continuous value
+    /*! @param word bytes of varint with continuation bits, not used bytes have to be 0 */
+    inline std::uint64_t compactVarintBits(std::uint64_t word)
+    {
+#if defined(__BMI2__)
+      return _pext_u64(word, 0x7f7f7f7f7f7f7f7fULL);
+#else
+      word &= 0x7f7f7f7f7f7f7f7fULL;
+      word = ((word & 0x7f007f007f007f00ULL) >> 1) | (word & 0x007f007f007f007fULL);
+      word = ((word & 0x3fff00003fff0000ULL) >> 2) | (word & 0x00003fff00003fffULL);
+      word = ((word & 0x0fffffff00000000ULL) >> 4) | (word & 0x000000000fffffffULL);
+      return word;
+#endif
+    }
+
+    //! Decodes varint from memory
+    /*! At least maxVarintSize bytes have to be available at data.
+        First eight bytes are loaded at once, end of varint is found
+        with terminating byte mask.
+        Throws Exception if varint is longer than maxVarintSize.
+        @param data address of varint
+        @param value decoded value
+        @return number of bytes used by varint */
+    inline std::size_t decodeVarint(const std::uint8_t * data, std::uint64_t & value)
+    {
+      const std::uint64_t word = loadLittleEndian64(data);
+      const std::uint64_t ends = ~word & 0x8080808080808080ULL;
+      if(ends != 0) {
+        const std::size_t endBit = countTrailingZeros(ends);
+        // keep only bytes up to end of varint
+        const std::uint64_t mask = endBit == 63 ? ~0ULL : (1ULL << (endBit + 1)) - 1;
+        value = compactVarintBits(word & mask);
+        return endBit / 8 + 1;
+      }
+      value = compactVarintBits(word) | (static_cast<std::uint64_t>(data[8] & 0x7f) << 56);
+      if(data[8] < 0x80)
+        return 9;
+      value |= static_cast<std::uint64_t>(data[9]) << 63;
+      if(data[9] < 0x80)
+        return 10;
+      throw Exception("Too big varint");
+    }
+
+    //! Encodes varint to memory
+    /*! At least maxVarintSize bytes have to be available at data.
+        @param value value to encode
+        @param data destination address
+        @return number of bytes used by varint */
+    inline std::size_t encodeVarint(std::uint64_t value, std::uint8_t * data)
+    {
+      std::size_t size = 0;
+      while (value > 0x7F) {
+        data[size] = (static_cast<std::uint8_t>(value) & 0x7f) | 0x80;
+        value >>= 7;
+        ++size;
+      }
+      data[size] = static_cast<std::uint8_t>(value) & 0x7f;
+      return size + 1;
+    }
+
+    //! Gets number of bytes used by value encoded with encodeVarint()
+    inline std::size_t encodedVarintSize(std::uint64_t value)
+    {
+      return value == 0 ? 1 : (63 - countLeadingZeros(value)) / 7 + 1;
+    }
+
+    //! Gets value saved before data of length prefixed object
+    /*! Least significant bit is set if object data contains definitions which can be referenced
+        later in stream (new shared object or polymorphic type name). Such objects have to be
+        read field by field even if they are skipped.
+        @param length size of object data in bytes, including FieldType::last_field marker
+        @param hasDefinitions if object data contains definitions */
+    inline std::uint64_t encodeObjectLength(std::uint64_t length, bool hasDefinitions)
+    {
+      return (length << 1) | (hasDefinitions ? 1 : 0);
+    }
+
+    //! Gets size of varint in memory without decoding it
+    /*! At least maxVarintSize bytes have to be available at data.
+        Throws Exception if varint is longer than maxVarintSize.
+        @param data address of varint
+        @return number of bytes used by varint */
+    inline std::size_t varintSize(const std::uint8_t * data)
+    {
+      const std::uint64_t ends = ~loadLittleEndian64(data) & 0x8080808080808080ULL;
+      if(ends != 0)
+        return countTrailingZeros(ends) / 8 + 1;
+      if(data[8] < 0x80)
+        return 9;
+      if(data[9] < 0x80)
+        return 10;
+      throw Exception("Too big varint");
+    }
+
+    //! Get number of bytes needed to save value bigger than 64 bits.
+    /*! \param v value to check
        \return number of bytes needed to save this value */
     template <class T> inline
-    std::uint8_t getHighestBit(T v)
+    typename std::enable_if<(sizeof(T) > sizeof(std::uint64_t)), std::uint8_t>::type
+    getHighestBit(T v)
     {
-      // TODO fix for big endian
       std::uint8_t n = 0;
       while( v != 0 ) {
         v >>= 8;
@@ -181,6 +401,18 @@ namespace cereal
       return n;
     }
 
+    //! Get number of bytes needed to save value.
+    /*! Values which fit in 64 bits are measured with single bit scan instead of a loop.
+       \param v value to check
+       \return number of bytes needed to save this value */
+    template <class T> inline
+    typename std::enable_if<(sizeof(T) <= sizeof(std::uint64_t)), std::uint8_t>::type
+    getHighestBit(T v)
+    {
+      const std::uint64_t value = static_cast<std::uint64_t>(v);
+      return value == 0 ? 0 : static_cast<std::uint8_t>((71 - countLeadingZeros(value)) / 8);
+    }
+
     //! Get number of bytes needed to save value.
     /*! Separate function is needed because of error "shift count >= width of type [-Werror,-Wshift-count-overflow]" */
     inline std::uint8_t getHighestBit(std::uint8_t)
@@ -279,6 +511,836 @@ namespace cereal
       }
     }
 
+    //! max size of packed struct in bytes
+    enum { maxPackedStructSize = 0xffff };
+
+    //! Kind of packed struct field, needed to swap bytes and to convert field to different size
+    enum class PackedFieldKind : std::uint8_t
+    {
+        unsigned_integer = 0,
+        signed_integer = 1,
+        floating_point = 2
+    };
+
+    //! Field of packed struct
+    struct PackedField
+    {
+      std::size_t offset; //!< offset of field from beginning of struct
+      std::uint8_t size; //!< size of field in bytes
+      PackedFieldKind kind;
+
+      bool operator==(PackedField const & other) const
+      { return offset == other.offset && size == other.size && kind == other.kind; }
+    };
+
+    //! Layout of packed struct saved before its data
+    /*! Saved as varint size of struct, varint number of fields, then for every field in
+        order of serialization one byte:
+        - bits 0-1: log2 of field size
+        - bits 2-3: PackedFieldKind
+        - bit 4: offset of field is saved as varint after this byte, otherwise field
+          directly follows field saved before it
+        Fields are matched by order of serialization when structs with different layout are loaded. */
+    struct PackedLayout
+    {
+      std::size_t size; //!< size of struct in bytes
+      std::vector<PackedField> fields; //!< fields in order of serialization
+
+      bool operator==(PackedLayout const & other) const
+      { return size == other.size && fields == other.fields; }
+    };
+
+    //! Marks types which are saved as packed structs in ExtendableBinary archive
+    /*! @see CEREAL_EXTENDABLE_BINARY_PACKED_STRUCT */
+    template <class T>
+    struct is_packed_struct : std::false_type {};
+
+    //! Gets byte describing field in PackedLayout
+    /*! @param field described field, size has to be 1, 2, 4 or 8
+        @param hasOffset if offset of field is saved after this byte */
+    inline std::uint8_t encodePackedField(PackedField const & field, bool hasOffset)
+    {
+      const std::uint8_t sizeLog2 = field.size == 1 ? 0 : field.size == 2 ? 1 : field.size == 4 ? 2 : 3;
+      return static_cast<std::uint8_t>(sizeLog2 | (static_cast<std::uint8_t>(field.kind) << 2) | (hasOffset ? 0x10 : 0));
+    }
+
+    //! Reads integer field of packed struct in host byte order
+    template <class T> inline
+    T loadPackedInteger(const std::uint8_t * src, std::size_t size)
+    {
+      T value = 0;
+      std::memcpy(reinterpret_cast<std::uint8_t *>(&value) + (is_little_endian() ? 0 : sizeof(T) - size), src, size);
+      return value;
+    }
+
+    //! Copies value of field between packed structs with different layouts
+    /*! Integers are converted between sizes, float and double are converted to each other.
+        Throws Exception if value doesn't fit to destination field or kinds of fields
+        can't be converted.
+        @param src address of source field in host byte order
+        @param from description of source field
+        @param dest address of destination field
+        @param to description of destination field */
+    inline void convertPackedField(const std::uint8_t * src, PackedField const & from,
+                                   std::uint8_t * dest, PackedField const & to)
+    {
+      if(from.kind == to.kind && from.size == to.size) {
+        std::memcpy(dest, src, to.size);
+        return;
+      }
+      const bool fromFloat = from.kind == PackedFieldKind::floating_point;
+      const bool toFloat = to.kind == PackedFieldKind::floating_point;
+      if(fromFloat != toFloat)
+        throw Exception("Packed struct field can't be converted between integer and floating point");
+      if(fromFloat) {
+        double value;
+        if(from.size == sizeof(float)) {
+          float f;
+          std::memcpy(&f, src, sizeof(f));
+          value = f;
+        } else {
+          std::memcpy(&value, src, sizeof(value));
+        }
+        if(to.size == sizeof(float)) {
+          const float f = static_cast<float>(value);
+          std::memcpy(dest, &f, sizeof(f));
+        } else {
+          std::memcpy(dest, &value, sizeof(value));
+        }
+        return;
+      }
+
+      // integers are converted through 64 bit value
+      const bool negative = from.kind == PackedFieldKind::signed_integer
+                            && (src[is_little_endian() ? from.size - 1 : 0] & 0x80) != 0;
+      std::uint64_t value = loadPackedInteger<std::uint64_t>(src, from.size);
+      if(negative && from.size < sizeof(value))
+        value |= ~std::uint64_t(0) << (8 * from.size); // sign extension
+      if(negative && to.kind == PackedFieldKind::unsigned_integer)
+        throw Exception("Negative value cannot be loaded to unsigned type");
+      if(to.size < sizeof(value)) {
+        // bits above destination size have to be copies of sign bit for signed, zeros for unsigned
+        const unsigned bits = 8u * to.size - (to.kind == PackedFieldKind::signed_integer ? 1u : 0u);
+        const std::uint64_t expected = negative ? ~std::uint64_t(0) >> bits : 0;
+        if((value >> bits) != expected)
+          throw Exception("Integer is to big to be loaded");
+      } else if(false == negative && to.kind == PackedFieldKind::signed_integer && (value >> 63) != 0) {
+        throw Exception("Integer is to big to be loaded");
+      }
+      std::memcpy(dest, reinterpret_cast<const std::uint8_t *>(&value) + (is_little_endian() ? 0 : sizeof(value) - to.size), to.size);
+    }
+
+    //! Marks types which are saved with fused encoder in ExtendableBinary archive
+    /*! @see CEREAL_EXTENDABLE_BINARY_FUSED_STRUCT */
+    template <class T>
+    struct is_fused_struct : std::false_type {};
+
+    //! max size of fused struct in bytes
+    /*! Fields are encoded into stack buffer twice the size of struct */
+    enum { maxFusedStructSize = 1024 };
+
+    //! Writes Size least significant bytes of value in given byte order
+    template <std::size_t Size, bool BigEndian> inline
+    void storeFusedBytes(std::uint64_t value, std::uint8_t * dest)
+    {
+      for(std::size_t i = 0; i < Size; ++i)
+        dest[i] = static_cast<std::uint8_t>(value >> (8 * (BigEndian ? Size - 1 - i : i)));
+    }
+
+    //! Reads size bytes of value saved in given byte order
+    /*! @param src address of value
+        @param size number of bytes of value, at most 8
+        @param available number of bytes which can be read from src, at least size */
+    template <bool BigEndian> inline
+    std::uint64_t loadFusedBytes(const std::uint8_t * src, std::size_t size, std::size_t available)
+    {
+      if(size == 0)
+        return 0;
+      if(available >= sizeof(std::uint64_t)) {
+        std::uint64_t word = loadLittleEndian64(src);
+        if(BigEndian) {
+          swap_bytes<sizeof(word)>(reinterpret_cast<std::uint8_t *>(&word));
+          return word >> (64 - 8 * size);
+        }
+        return size == sizeof(word) ? word : word & ((std::uint64_t(1) << (8 * size)) - 1);
+      }
+      std::uint64_t value = 0;
+      for(std::size_t i = 0; i < size; ++i)
+        value |= static_cast<std::uint64_t>(src[i]) << (8 * (BigEndian ? size - 1 - i : i));
+      return value;
+    }
+
+    //! Encodes integer field of fused struct, same bytes as integer saved on its own
+    /*! At least 1 + sizeof(T) bytes have to be available at dest.
+        @return number of written bytes */
+    template <bool BigEndian, class T> inline
+    typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, std::size_t>::type
+    encodeFusedField(T const & t, std::uint8_t * dest)
+    {
+      static_assert(sizeof(T) <= sizeof(std::uint64_t), "only integers up to 8 bytes are supported in fused struct");
+      using unsigned_type = typename std::make_unsigned<T>::type;
+      if( t <= 0xf && t >= 0 ) {
+        dest[0] = writeType(FieldType::integer_packed, static_cast<std::uint8_t>(t));
+        return 1;
+      }
+      const unsigned_type absolute = t >= 0 ? t : -static_cast<unsigned_type>(t);
+      const std::uint8_t size = getHighestBit(absolute);
+      dest[0] = writeType(t >= 0 ? FieldType::positive_integer : FieldType::negative_integer, size);
+      // value is moved to the most significant bytes, first size bytes are written
+      storeFusedBytes<sizeof(T), BigEndian>(BigEndian ? static_cast<std::uint64_t>(absolute) << (8 * (sizeof(T) - size))
+                                                      : static_cast<std::uint64_t>(absolute), dest + 1);
+      return 1u + size;
+    }
+
+    //! Encodes bool field of fused struct
+    template <bool BigEndian> inline
+    std::size_t encodeFusedField(bool const & t, std::uint8_t * dest)
+    {
+      dest[0] = writeType(FieldType::integer_packed, t ? 1 : 0);
+      return 1;
+    }
+
+    //! Encodes floating point field of fused struct, NaN is saved as quiet NaN
+    template <bool BigEndian, class T> inline
+    typename std::enable_if<std::is_floating_point<T>::value, std::size_t>::type
+    encodeFusedField(T const & t, std::uint8_t * dest)
+    {
+      static_assert(std::numeric_limits<T>::is_iec559, "Extendable binary only supports IEEE 754 standardized floating point");
+      using bits_type = typename std::conditional<sizeof(T) == sizeof(std::uint32_t), std::uint32_t, std::uint64_t>::type;
+      dest[0] = writeType(FieldType::floating_point, getTagSizeFromFloatType<T>());
+      const T value = t == t ? t : getqNaN<T>();
+      bits_type bits;
+      std::memcpy(&bits, &value, sizeof(bits));
+      storeFusedBytes<sizeof(T), BigEndian>(bits, dest + 1);
+      return 1 + sizeof(T);
+    }
+
+    //! Decodes integer field of fused struct
+    /*! Omitted field is not modified.
+        @param available number of bytes which can be read from src
+        @return number of read bytes, 0 if field has to be loaded by archive (unexpected type,
+                value doesn't fit or not enough data) */
+    template <bool BigEndian, class T> inline
+    typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, std::size_t>::type
+    decodeFusedField(T & t, const std::uint8_t * src, std::size_t available)
+    {
+      if(available == 0)
+        return 0;
+      const std::uint8_t info = src[0] & 0xf;
+      switch(static_cast<FieldType>(src[0] >> 4)) {
+        case FieldType::omitted_field:
+          return 1;
+        case FieldType::integer_packed:
+          t = static_cast<T>(info);
+          return 1;
+        case FieldType::positive_integer:
+        case FieldType::negative_integer: {
+          const bool negative = static_cast<FieldType>(src[0] >> 4) == FieldType::negative_integer;
+          if(info > sizeof(T) || available < 1u + info || (negative && std::is_unsigned<T>::value))
+            return 0;
+          const std::uint64_t value = loadFusedBytes<BigEndian>(src + 1, info, available - 1);
+          t = static_cast<T>(negative ? 0 - value : value);
+          return 1u + info;
+        }
+        default:
+          return 0;
+      }
+    }
+
+    //! Decodes bool field of fused struct, @see decodeFusedField()
+    template <bool BigEndian> inline
+    std::size_t decodeFusedField(bool & t, const std::uint8_t * src, std::size_t available)
+    {
+      if(available == 0)
+        return 0;
+      switch(static_cast<FieldType>(src[0] >> 4)) {
+        case FieldType::omitted_field:
+          return 1;
+        case FieldType::integer_packed:
+          t = (src[0] & 0xf) != 0;
+          return 1;
+        default:
+          return 0;
+      }
+    }
+
+    //! Decodes floating point field of fused struct, float and double are converted to each other
+    /*! @see decodeFusedField() */
+    template <bool BigEndian, class T> inline
+    typename std::enable_if<std::is_floating_point<T>::value, std::size_t>::type
+    decodeFusedField(T & t, const std::uint8_t * src, std::size_t available)
+    {
+      if(available == 0)
+        return 0;
+      switch(static_cast<FieldType>(src[0] >> 4)) {
+        case FieldType::omitted_field:
+          return 1;
+        case FieldType::floating_point: {
+          const std::uint8_t info = src[0] & 0xf;
+          if(info == 1 && available >= 1 + sizeof(float)) {
+            const std::uint32_t bits = static_cast<std::uint32_t>(loadFusedBytes<BigEndian>(src + 1, sizeof(bits), available - 1));
+            float value;
+            std::memcpy(&value, &bits, sizeof(value));
+            t = static_cast<T>(value);
+            return 1 + sizeof(float);
+          }
+          if(info == 2 && available >= 1 + sizeof(double)) {
+            const std::uint64_t bits = loadFusedBytes<BigEndian>(src + 1, sizeof(bits), available - 1);
+            double value;
+            std::memcpy(&value, &bits, sizeof(value));
+            t = static_cast<T>(value);
+            return 1 + sizeof(double);
+          }
+          return 0;
+        }
+        default:
+          return 0;
+      }
+    }
+
+    //! Maps signed integer to unsigned one, numbers with small absolute value get small codes
+    inline std::uint64_t encodeZigZag(std::int64_t value)
+    {
+      return (static_cast<std::uint64_t>(value) << 1) ^ (value < 0 ? ~std::uint64_t(0) : 0);
+    }
+
+    //! Reverse of encodeZigZag()
+    inline std::int64_t decodeZigZag(std::uint64_t value)
+    {
+      return static_cast<std::int64_t>((value >> 1) ^ (std::uint64_t(0) - (value & 1)));
+    }
+
+    //! Gets number of bytes used by value encoded as varint
+    inline std::size_t varintLength(std::uint64_t value)
+    {
+      std::size_t size = 1;
+      for(; value > 0x7f; value >>= 7)
+        ++size;
+      return size;
+    }
+
+    //! Gets number of bits needed to store value
+    inline unsigned bitWidth(std::uint64_t value)
+    {
+      unsigned width = 0;
+      for(; value != 0; value >>= 1)
+        ++width;
+      return width;
+    }
+
+    //! Decodes varint from memory which may end before maxVarintSize bytes
+    /*! Throws Exception if varint doesn't end in available bytes.
+        @param data address of varint
+        @param available number of bytes which can be read from data
+        @param value decoded value
+        @return number of bytes used by varint */
+    inline std::size_t decodeVarintBounded(const std::uint8_t * data, std::size_t available, std::uint64_t & value)
+    {
+      if(available >= maxVarintSize)
+        return decodeVarint(data, value);
+      std::uint8_t padded[maxVarintSize] = {};
+      std::memcpy(padded, data, available);
+      const std::size_t size = decodeVarint(padded, value);
+      if(size > available)
+        throw Exception("Integer array data is corrupted");
+      return size;
+    }
+
+    //! Integers of these types can be saved as FieldType::integer_array
+    template <class T>
+    struct is_compressible_integer : std::integral_constant<bool,
+      std::is_integral<T>::value && !std::is_same<T, bool>::value && sizeof(T) <= sizeof(std::uint64_t)> {};
+
+    //! Gets bits of integer extended to 64 bits, signed types are sign extended
+    template <class T> inline
+    std::uint64_t toArrayInteger(T value)
+    {
+      return std::is_signed<T>::value ? static_cast<std::uint64_t>(static_cast<std::int64_t>(value))
+                                      : static_cast<std::uint64_t>(value);
+    }
+
+    //! Checks if integer loaded from integer array can be stored in T
+    /*! @param value bits of integer, @see toArrayInteger()
+        @param isSigned if value is signed */
+    template <class T> inline
+    bool arrayIntegerFits(std::uint64_t value, bool isSigned)
+    {
+      if(isSigned && static_cast<std::int64_t>(value) < 0)
+        return std::is_signed<T>::value
+               && static_cast<std::int64_t>(value) >= static_cast<std::int64_t>(std::numeric_limits<T>::min());
+      return value <= static_cast<std::uint64_t>(std::numeric_limits<T>::max());
+    }
+
+    //! Converts integer loaded from integer array to T
+    /*! Throws Exception if value can't be stored in T */
+    template <class T> inline
+    T castArrayInteger(std::uint64_t value, bool isSigned)
+    {
+      if(false == arrayIntegerFits<T>(value, isSigned)) {
+        if(isSigned && static_cast<std::int64_t>(value) < 0 && std::is_unsigned<T>::value)
+          throw Exception("Negative value cannot be loaded to unsigned type");
+        throw Exception("Integer is to big to be loaded");
+      }
+      return static_cast<T>(value);
+    }
+
+    //! Properties of integer array used to choose its encoding
+    struct IntegerArrayStats
+    {
+      std::uint64_t min; //!< minimal value, @see toArrayInteger()
+      std::uint64_t range; //!< difference between maximal and minimal value
+      std::uint64_t varintBytes; //!< size of array encoded with IntegerArrayEncoding::varint
+      std::uint64_t deltaBytes; //!< size of array encoded with IntegerArrayEncoding::delta
+    };
+
+    //! Gets value of integer saved as varint by IntegerArrayEncoding::varint
+    template <class T> inline
+    std::uint64_t toArrayVarint(T value)
+    {
+      return std::is_signed<T>::value ? encodeZigZag(static_cast<std::int64_t>(value)) : static_cast<std::uint64_t>(value);
+    }
+
+    //! Gets difference between consecutive elements saved by IntegerArrayEncoding::delta
+    /*! @param value bits of integer, @see toArrayInteger()
+        @param previous bits of previous integer */
+    inline std::uint64_t toArrayDelta(std::uint64_t value, std::uint64_t previous)
+    {
+      return encodeZigZag(static_cast<std::int64_t>(value - previous));
+    }
+
+    //! Finds minimal and maximal value of array and sizes of its varint encodings in single pass
+    /*! @param first iterator to first element
+        @param count number of elements, has to be greater than 0
+        @param get gets integer from element */
+    template <class T, class It, class Get> inline
+    IntegerArrayStats getIntegerArrayStats(It first, std::size_t count, Get get)
+    {
+      T min = get(*first);
+      T max = min;
+      std::uint64_t varintBytes = 0;
+      std::uint64_t deltaBytes = varintLength(toArrayVarint(min));
+      std::uint64_t previous = toArrayInteger(min);
+      for(std::size_t i = 0; i < count; ++i, ++first) {
+        const T value = get(*first);
+        min = value < min ? value : min;
+        max = value > max ? value : max;
+        varintBytes += varintLength(toArrayVarint(value));
+        const std::uint64_t bits = toArrayInteger(value);
+        deltaBytes += i == 0 ? 0 : varintLength(toArrayDelta(bits, previous));
+        previous = bits;
+      }
+      return {toArrayInteger(min), toArrayInteger(max) - toArrayInteger(min), varintBytes, deltaBytes};
+    }
+
+    //! Number of values in block of IntegerArrayEncoding::bit_packed array
+    /*! Every full block ends on byte boundary */
+    enum { bitPackedBlockSize = 64 };
+
+    //! Size of buffer able to hold packed block with padding needed by packBits() and unpackBits()
+    enum { bitPackedBufferSize = bitPackedBlockSize * sizeof(std::uint64_t) + 2 * sizeof(std::uint64_t) };
+
+    //! Gets number of bytes used by count values packed with width bits each
+    inline std::uint64_t bitPackedSize(std::uint64_t count, unsigned width)
+    {
+      return (count * width + 7) / 8;
+    }
+
+    //! Packs up to bitPackedBlockSize values with width bits each
+    /*! Values are or'ed into dest, which has to be zeroed and have
+        bitPackedSize(count, width) + 9 bytes available. */
+    inline void packBits(const std::uint64_t * values, std::size_t count, unsigned width, std::uint8_t * dest)
+    {
+      for(std::size_t i = 0; i < count; ++i) {
+        const std::size_t bit = i * width;
+        const unsigned shift = bit & 7;
+        std::uint8_t * word = dest + bit / 8;
+        std::uint64_t packed = loadLittleEndian64(word) | (values[i] << shift);
+        if(false == is_little_endian())
+          swap_bytes<sizeof(packed)>(reinterpret_cast<std::uint8_t *>(&packed));
+        std::memcpy(word, &packed, sizeof(packed));
+        if(shift + width > 64)
+          word[8] = static_cast<std::uint8_t>(values[i] >> (64 - shift));
+      }
+    }
+
+    //! Unpacks up to bitPackedBlockSize values with width bits each
+    /*! bitPackedSize(count, width) + 9 bytes have to be readable at src */
+    inline void unpackBits(const std::uint8_t * src, std::size_t count, unsigned width, std::uint64_t * values)
+    {
+      const std::uint64_t mask = width == 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << width) - 1;
+      for(std::size_t i = 0; i < count; ++i) {
+        const std::size_t bit = i * width;
+        const unsigned shift = bit & 7;
+        std::uint64_t value = loadLittleEndian64(src + bit / 8) >> shift;
+        if(shift + width > 64)
+          value |= static_cast<std::uint64_t>(src[bit / 8 + 8]) << (64 - shift);
+        values[i] = value & mask;
+      }
+    }
+
+    //! Decodes array saved with IntegerArrayEncoding::varint or IntegerArrayEncoding::delta
+    /*! Throws Exception if data doesn't contain exactly count values or value doesn't fit to T.
+        @param src encoded data
+        @param size size of encoded data in bytes
+        @param count number of elements
+        @param isSigned if values are signed
+        @param isDelta if data is encoded with IntegerArrayEncoding::delta
+        @param sink called with every decoded element */
+    template <class T, class Sink> inline
+    void decodeVarintArray(const std::uint8_t * src, std::size_t size, std::size_t count, bool isSigned, bool isDelta, Sink & sink)
+    {
+      std::size_t pos = 0;
+      std::uint64_t previous = 0;
+      for(std::size_t i = 0; i < count; ++i) {
+        std::uint64_t value;
+        if(size - pos >= maxVarintSize)
+          pos += decodeVarint(src + pos, value);
+        else
+          pos += decodeVarintBounded(src + pos, size - pos, value);
+        if(isDelta && i > 0)
+          value = previous + static_cast<std::uint64_t>(decodeZigZag(value));
+        else if(isSigned)
+          value = static_cast<std::uint64_t>(decodeZigZag(value));
+        previous = value;
+        sink(castArrayInteger<T>(value, isSigned));
+      }
+      if(pos != size)
+        throw Exception("Integer array data is corrupted");
+    }
+
+    //! Decodes array saved with IntegerArrayEncoding::bit_packed
+    /*! Values are unpacked in blocks, last block is copied to padded buffer.
+        Throws Exception if size of data doesn't match count or value doesn't fit to T.
+        @param src encoded data
+        @param size size of encoded data in bytes
+        @param count number of elements
+        @param isSigned if values are signed
+        @param sink called with every decoded element */
+    template <class T, class Sink> inline
+    void decodeBitPackedArray(const std::uint8_t * src, std::size_t size, std::size_t count, bool isSigned, Sink & sink)
+    {
+      std::uint64_t min;
+      std::size_t pos = decodeVarintBounded(src, size, min);
+      if(pos == size)
+        throw Exception("Integer array data is corrupted");
+      const unsigned width = src[pos++];
+      if(width > 64 || bitPackedSize(count, width) != size - pos)
+        throw Exception("Integer array data is corrupted");
+      if(isSigned)
+        min = static_cast<std::uint64_t>(decodeZigZag(min));
+
+      // values don't have to be checked if whole range allowed by width fits to T
+      const std::uint64_t maxDelta = width == 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << width) - 1;
+      const std::uint64_t max = min + maxDelta;
+      const bool ordered = isSigned ? static_cast<std::int64_t>(max) >= static_cast<std::int64_t>(min) : max >= min;
+      const bool checked = !(ordered && arrayIntegerFits<T>(min, isSigned) && arrayIntegerFits<T>(max, isSigned));
+
+      std::uint64_t values[bitPackedBlockSize];
+      std::uint8_t padded[bitPackedBufferSize];
+      for(std::size_t i = 0; i < count; i += bitPackedBlockSize) {
+        const std::size_t blockCount = std::min<std::size_t>(bitPackedBlockSize, count - i);
+        const std::size_t blockSize = static_cast<std::size_t>(bitPackedSize(blockCount, width));
+        const std::uint8_t * block = src + pos;
+        if(size - pos < blockSize + 9) {
+          std::memset(padded, 0, sizeof(padded));
+          std::memcpy(padded, block, size - pos);
+          block = padded;
+        }
+        unpackBits(block, blockCount, width, values);
+        pos += blockSize;
+        if(checked) {
+          for(std::size_t j = 0; j < blockCount; ++j)
+            sink(castArrayInteger<T>(min + values[j], isSigned));
+        } else {
+          for(std::size_t j = 0; j < blockCount; ++j)
+            sink(static_cast<T>(min + values[j]));
+        }
+      }
+    }
+
+    //! Gets number of bytes used by count bits of FieldType::bit_array
+    inline std::uint64_t bitArraySize(std::uint64_t count)
+    {
+      return count / 8 + (count % 8 != 0 ? 1 : 0);
+    }
+
+    //! Packs count bits into bytes, 64 bits at a time
+    /*! @param get gets bit with given index
+        @param first index of first bit
+        @param count number of bits
+        @param dest destination, bitArraySize(count) bytes are written */
+    template <class Get> inline
+    void packBools(Get & get, std::size_t first, std::size_t count, std::uint8_t * dest)
+    {
+      for(std::size_t i = 0; i < count; i += 64, dest += 8) {
+        const std::size_t bits = std::min<std::size_t>(64, count - i);
+        std::uint64_t word = 0;
+        for(std::size_t b = 0; b < bits; ++b)
+          word |= static_cast<std::uint64_t>(get(first + i + b) ? 1 : 0) << b;
+        for(std::size_t k = 0, bytes = static_cast<std::size_t>(bitArraySize(bits)); k < bytes; ++k)
+          dest[k] = static_cast<std::uint8_t>(word >> (8 * k));
+      }
+    }
+
+    //! Unpacks count bits from bytes, 64 bits at a time
+    /*! @param src packed bits, bitArraySize(count) bytes are read
+        @param first index of first bit
+        @param count number of bits
+        @param set sets bit with given index */
+    template <class Set> inline
+    void unpackBools(const std::uint8_t * src, std::size_t first, std::size_t count, Set & set)
+    {
+      for(std::size_t i = 0; i < count; i += 64, src += 8) {
+        const std::size_t bits = std::min<std::size_t>(64, count - i);
+        std::uint64_t word = 0;
+        if(bits == 64) {
+          word = loadLittleEndian64(src);
+        } else {
+          for(std::size_t k = 0, bytes = static_cast<std::size_t>(bitArraySize(bits)); k < bytes; ++k)
+            word |= static_cast<std::uint64_t>(src[k]) << (8 * k);
+        }
+        for(std::size_t b = 0; b < bits; ++b)
+          set(first + i + b, ((word >> b) & 1) != 0);
+      }
+    }
+
+    //! size of write buffer kept by output archive
+    /*! Data is flushed to output stream when buffer is full */
+    enum { writeBufferSize = 4096 };
+
+    //! Class used as a write buffer in front of output stream
+    /*! Archive encodes type tags, varints and payloads directly into internal buffer.
+        Buffer is written to the stream with a single sputn call when it is full,
+        when flush() is called or when object is destroyed.
+        Data bigger than whole buffer is written to the stream directly.
+
+        Space for length of following data can be reserved with beginFrame() and filled
+        with endFrame(). Data starting from the first unfinished frame is kept in buffer,
+        buffer grows if needed.
+
+        Buffer without stream only counts written bytes, flushed and big data is discarded. */
+    class WriteBuffer
+    {
+      public:
+        //! Construct new buffer writing to stream
+        /*! @param stream stream to which buffered data will be written, nullptr if data is only counted */
+        WriteBuffer(std::ostream * stream) : itsStream(stream), itsPos(0), itsBase(0),
+                                             itsOpenFrames(0), itsFramesFrom(0), itsBuffer(writeBufferSize)
+        {}
+
+        //! Writes remaining data to stream
+        /*! Exceptions are not propagated, call flush() to check if data was written */
+        ~WriteBuffer() CEREAL_NOEXCEPT
+        {
+          try {
+            flush();
+          } catch(...) {
+          }
+        }
+
+        WriteBuffer(WriteBuffer const &) = delete;
+        WriteBuffer & operator=(WriteBuffer const &) = delete;
+
+        //! Gets address to which at least size bytes can be written
+        /*! Flushes buffer if there is not enough free space.
+            Written data has to be confirmed with commit().
+            @param size number of bytes to be written */
+        inline std::uint8_t * reserve(std::size_t size)
+        {
+          if(itsBuffer.size() - itsPos < size) {
+            makeRoom(size);
+          }
+          return itsBuffer.data() + itsPos;
+        }
+
+        //! Confirms that size bytes were written to address returned by reserve()
+        inline void commit(std::size_t size)
+        {
+          itsPos += size;
+        }
+
+        //! Writes single byte
+        inline void writeByte(std::uint8_t v)
+        {
+          if(itsPos == itsBuffer.size()) {
+            makeRoom(1);
+          }
+          itsBuffer[itsPos++] = v;
+        }
+
+        //! Writes size bytes of data
+        /*! Throws Exception if data cannot be written to stream */
+        inline void write(const void * data, std::size_t size)
+        {
+          if(itsBuffer.size() - itsPos >= size) {
+            std::memcpy(itsBuffer.data() + itsPos, data, size);
+            itsPos += size;
+            return;
+          }
+          flush();
+          if((itsOpenFrames == 0 || itsStream == nullptr) && size >= writeBufferSize) {
+            writeToStream(data, size);
+            itsBase += size;
+          } else {
+            makeRoom(size);
+            std::memcpy(itsBuffer.data() + itsPos, data, size);
+            itsPos += size;
+          }
+        }
+
+        //! Writes count elements of DataSize bytes each, swapping byte order of every element
+        template <std::size_t DataSize> inline
+        void writeSwapped(const void * data, std::size_t count)
+        {
+          if(itsStream == nullptr) {
+            // nothing to keep, bytes are only counted
+            itsBase += count * DataSize;
+            return;
+          }
+          const std::uint8_t * src = reinterpret_cast<const std::uint8_t*>(data);
+          while(count > 0) {
+            if(itsBuffer.size() - itsPos < DataSize) {
+              makeRoom(DataSize);
+            }
+            const std::size_t fit = std::min(count, (itsBuffer.size() - itsPos) / DataSize);
+            detail::swap_bytes_copy<DataSize>(itsBuffer.data() + itsPos, src, fit);
+            src += fit * DataSize;
+            itsPos += fit * DataSize;
+            count -= fit;
+          }
+        }
+
+        //! Writes buffered data to stream
+        /*! Data of unfinished frames is not written, it's kept until outermost frame is finished.
+            Buffer which only counts bytes doesn't keep any data.
+            Throws Exception if data cannot be written to stream */
+        inline void flush()
+        {
+          const std::size_t size = itsOpenFrames == 0 || itsStream == nullptr ? itsPos : itsFramesFrom - itsBase;
+          if(size > 0) {
+            const std::size_t kept = itsPos - size;
+            itsPos = 0;
+            writeToStream(itsBuffer.data(), size);
+            std::memmove(itsBuffer.data(), itsBuffer.data() + size, kept);
+            itsBase += size;
+            itsPos = kept;
+          }
+        }
+
+        //! Checks if bytes are only counted, buffer was created without stream
+        /*! Such buffer can be given number of bytes with count() instead of data */
+        inline bool countsOnly() const
+        {
+          return itsStream == nullptr;
+        }
+
+        //! Counts size bytes as written, only for buffer which countsOnly()
+        inline void count(std::size_t size)
+        {
+          itsBase += size;
+        }
+
+        //! Gets number of bytes written to buffer since it was created
+        inline std::uint64_t size() const
+        {
+          return itsBase + itsPos;
+        }
+
+        //! Gets number of bytes already written from buffer to stream
+        inline std::uint64_t written() const
+        {
+          return itsBase;
+        }
+
+        //! Starts writing to other stream, as if buffer was created again
+        /*! Data which was not written to previous stream yet is discarded, allocated memory is kept.
+            @param stream stream to which buffered data will be written, nullptr if data is only counted */
+        inline void reset(std::ostream * stream)
+        {
+          itsStream = stream;
+          itsPos = 0;
+          itsBase = 0;
+          itsOpenFrames = 0;
+          itsFramesFrom = 0;
+        }
+
+        //! Reserves space for varint written later with endFrame()
+        /*! Frames can be nested, they have to be finished in reverse order.
+            @return position of frame */
+        inline std::size_t beginFrame()
+        {
+          if(itsStream == nullptr) {
+            // frames only change counted size
+            ++itsOpenFrames;
+            itsBase += maxVarintSize;
+            return itsBase + itsPos - maxVarintSize;
+          }
+          reserve(maxVarintSize);
+          const std::size_t frame = itsBase + itsPos;
+          if(itsOpenFrames++ == 0) {
+            itsFramesFrom = frame;
+          }
+          itsPos += maxVarintSize;
+          return frame;
+        }
+
+        //! Gets number of bytes written after space reserved by beginFrame()
+        inline std::uint64_t frameLength(std::size_t frame) const
+        {
+          return itsBase + itsPos - frame - maxVarintSize;
+        }
+
+        //! Writes value to space reserved by beginFrame(), not used part of space is removed
+        /*! Data written after frame was started is moved to follow varint.
+            Throws Exception if data of frame was discarded after failed write */
+        inline void endFrame(std::size_t frame, std::uint64_t value)
+        {
+          if(itsStream == nullptr) {
+            itsBase -= maxVarintSize - encodedVarintSize(value);
+            --itsOpenFrames;
+            return;
+          }
+          if(frame < itsBase || itsPos < frame - itsBase + maxVarintSize) {
+            throw Exception("Data of unfinished object was discarded");
+          }
+          std::uint8_t * slot = itsBuffer.data() + (frame - itsBase);
+          const std::size_t size = encodeVarint(value, slot);
+          const std::size_t unused = maxVarintSize - size;
+          std::memmove(slot + size, slot + maxVarintSize, itsBuffer.data() + itsPos - slot - maxVarintSize);
+          itsPos -= unused;
+          --itsOpenFrames;
+        }
+
+      private:
+        //! Makes space for at least size bytes
+        /*! Buffer grows if it's kept for unfinished frames */
+        inline void makeRoom(std::size_t size)
+        {
+          flush();
+          if(itsBuffer.size() - itsPos < size) {
+            itsBuffer.resize(std::max(itsPos + size, 2 * itsBuffer.size()));
+          }
+        }
+
+        //! Writes data directly to the stream
+        inline void writeToStream(const void * data, std::size_t size)
+        {
+          if(itsStream == nullptr)
+            return;
+          const auto writtenSize = static_cast<std::size_t>( itsStream->rdbuf()->sputn( reinterpret_cast<const char*>( data ), size ) );
+          if(writtenSize != size)
+            throw Exception("Failed to write " + std::to_string(size) + " bytes to output stream! Wrote " + std::to_string(writtenSize));
+        }
+
+      private:
+        std::ostream * itsStream; //!< stream to write buffered data to, nullptr if data is only counted
+        std::size_t itsPos; //!< number of bytes used in itsBuffer
+        std::size_t itsBase; //!< number of bytes written to stream, position of itsBuffer's beginning
+        std::size_t itsOpenFrames; //!< number of frames started and not finished
+        std::size_t itsFramesFrom; //!< position of outermost unfinished frame
+        std::vector<std::uint8_t> itsBuffer; //!< buffered data not yet written to stream
+    };
+
     //! Struct to keep position of start and end in stream
     struct StreamPos
     {
@@ -286,171 +1348,527 @@ namespace cereal
       std::streamoff end;
     };
 
-    //! Class used as an adapter to queue of streams
-    /*! Two streams are managed. Main stream can be used only for reading and reading position
-        can move only forward. Position of reading for second stream can be moved freely.
-        For second stream queue of start and end positions is kept. New StreamPos can be added
-        when last StreamPos was not yet read fully. When StreamPos::end for top StreamPos is reached
-        reading from next StreamPos is continued. If there are no StreamPos on the queue data
-        is read from main stream.
+    //! Storage for data copied from skipped shared objects
+    /*! Data is appended to fixed size chunks, so appending never moves data which
+        is already stored and position is mapped to its chunk in constant time.
+        Positions are offsets from the beginning of first appended data.
+
+        Ranges of skipped objects are counted per chunk (see endRange()). Chunk is freed
+        when all ranges stored in it were released, that is when objects were loaded.
+        Chunks which can be still appended to are kept, they are freed when arena grows past
+        them or when unfinished range which uses them is finished. */
+    class SharedDataArena
+    {
+      public:
+        //! Construct empty arena
+        /*! @param maxSize max number of bytes kept in arena, Exception is thrown when exceeded */
+        explicit SharedDataArena(std::size_t maxSize)
+            : itsSize(0), itsHeld(0), itsPeakHeld(0), itsMaxSize(maxSize), itsOpenRanges(0), itsOpenFrom(0),
+              itsKeptFrom(0)
+        {}
+
+        //! Position of end of data
+        std::size_t size() const { return itsSize; }
+
+        //! Max number of bytes kept in arena at once, compared against max size
+        std::size_t peakHeld() const { return itsPeakHeld; }
+
+        //! Removes all data and ranges, positions start from zero again
+        /*! Chunks are freed, only space for their list is kept */
+        void clear()
+        {
+          itsChunks.clear();
+          itsSize = 0;
+          itsHeld = 0;
+          itsPeakHeld = 0;
+          itsOpenRanges = 0;
+          itsOpenFrom = 0;
+          itsKeptFrom = 0;
+        }
+
+        //! Copies size bytes from data to the end of arena
+        void append(const void * data, std::size_t size)
+        {
+          checkMaxSize(size);
+          const std::uint8_t * src = reinterpret_cast<const std::uint8_t *>(data);
+          while (size > 0) {
+            std::size_t available;
+            std::uint8_t * dest = tail(available);
+            const std::size_t n = std::min(size, available);
+            std::memcpy(dest, src, n);
+            itsSize += n;
+            itsHeld += n;
+            src += n;
+            size -= n;
+          }
+          itsPeakHeld = std::max(itsPeakHeld, itsHeld);
+        }
+
+        //! Reads size bytes from stream to the end of arena
+        /*! @return number of bytes read, less than size if stream ended */
+        std::size_t append(std::istream & stream, std::size_t size)
+        {
+          checkMaxSize(size);
+          std::size_t copied = 0;
+          while (copied < size) {
+            std::size_t available;
+            std::uint8_t * dest = tail(available);
+            const std::size_t wanted = std::min(size - copied, available);
+            const std::size_t n = static_cast<std::size_t>(
+                stream.rdbuf()->sgetn(reinterpret_cast<char *>(dest), static_cast<std::streamsize>(wanted)));
+            itsSize += n;
+            itsHeld += n;
+            copied += n;
+            if (n < wanted)
+              break;
+          }
+          itsPeakHeld = std::max(itsPeakHeld, itsHeld);
+          return copied;
+        }
+
+        //! Copies size bytes stored at pos to the end of arena
+        void append(std::size_t pos, std::size_t size)
+        {
+          checkMaxSize(size);
+          while (size > 0) {
+            std::size_t n;
+            const std::uint8_t * src = at(pos, n);
+            n = std::min(n, size);
+            append(src, n);
+            pos += n;
+            size -= n;
+          }
+        }
 
-        Additional functions for copying data from one stream to the other are provided (readToOtherStream()).
+        //! Copies size bytes stored at pos to data
+        void read(std::size_t pos, void * data, std::size_t size) const
+        {
+          std::uint8_t * dest = reinterpret_cast<std::uint8_t *>(data);
+          while (size > 0) {
+            std::size_t n;
+            const std::uint8_t * src = at(pos, n);
+            n = std::min(n, size);
+            std::memcpy(dest, src, n);
+            pos += n;
+            dest += n;
+            size -= n;
+          }
+        }
+
+        //! Starts range of new skipped object at the end of arena
+        /*! Ranges can be nested, chunks of not finished ranges are never freed.
+            @return start position of range */
+        std::size_t beginRange()
+        {
+          if (itsOpenRanges++ == 0)
+            itsOpenFrom = itsSize;
+          return itsSize;
+        }
+
+        //! Finishes range started with beginRange() at the end of arena
+        /*! Chunks of range are kept until range is released.
+            @return finished range */
+        StreamPos endRange(std::size_t start)
+        {
+          --itsOpenRanges;
+          StreamPos range{static_cast<std::streamoff>(start), static_cast<std::streamoff>(itsSize)};
+          forEachChunk(range, [this](std::size_t chunk) { ++itsChunks[chunk].ranges; });
+          freeReleased();
+          return range;
+        }
+
+        //! Releases finished range, its data won't be read anymore
+        void release(StreamPos const & range)
+        {
+          forEachChunk(range, [this](std::size_t chunk) {
+            if (--itsChunks[chunk].ranges == 0 && chunk < itsKeptFrom)
+              freeChunk(chunk);
+          });
+        }
+
+      private:
+        static const std::size_t chunkSize = 16 * 1024;
+
+        struct Chunk
+        {
+          std::unique_ptr<std::uint8_t[]> data;
+          std::size_t ranges; //!< number of not released ranges using chunk
+        };
+
+        //! Throws Exception if storing size additional bytes would exceed max size
+        void checkMaxSize(std::size_t size) const
+        {
+          if (size > itsMaxSize - itsHeld) {
+            throw Exception("Shared obiect shared data limit hit");
+          }
+        }
+
+        //! Gets writable space at the end of arena, allocates new chunk if needed
+        std::uint8_t * tail(std::size_t & available)
+        {
+          const std::size_t offset = itsSize % chunkSize;
+          if (offset == 0 && itsSize / chunkSize == itsChunks.size()) {
+            itsChunks.push_back(Chunk{std::unique_ptr<std::uint8_t[]>(new std::uint8_t[chunkSize]), 0});
+            freeReleased();
+          }
+          available = chunkSize - offset;
+          return itsChunks.back().data.get() + offset;
+        }
+
+        //! Gets address of data at pos and number of contiguous bytes stored after it
+        const std::uint8_t * at(std::size_t pos, std::size_t & available) const
+        {
+          if (pos >= itsSize)
+            throw Exception("Reading past the end of skipped shared object data");
+          const Chunk & chunk = itsChunks[pos / chunkSize];
+          if (!chunk.data)
+            throw Exception("Reading released skipped shared object data");
+          const std::size_t offset = pos % chunkSize;
+          available = std::min(chunkSize - offset, itsSize - pos);
+          return chunk.data.get() + offset;
+        }
+
+        //! Frees chunk if it was not freed yet
+        void freeChunk(std::size_t chunk)
+        {
+          if (itsChunks[chunk].data) {
+            itsChunks[chunk].data.reset();
+            itsHeld -= chunkSize;
+          }
+        }
+
+        //! Moves itsKeptFrom forward, frees chunks before it which have no ranges
+        /*! Has to be called when the last chunk changes or outermost range is finished.
+            Chunks whose ranges were released while they were kept are freed here. */
+        void freeReleased()
+        {
+          std::size_t keptFrom = itsChunks.empty() ? 0 : itsChunks.size() - 1;
+          if (itsOpenRanges > 0)
+            keptFrom = std::min(keptFrom, itsOpenFrom / chunkSize);
+          for (; itsKeptFrom < keptFrom; ++itsKeptFrom) {
+            if (itsChunks[itsKeptFrom].ranges == 0)
+              freeChunk(itsKeptFrom);
+          }
+        }
+
+        template <class F>
+        void forEachChunk(StreamPos const & range, F && f)
+        {
+          if (range.end <= range.start)
+            return;
+          const std::size_t last = static_cast<std::size_t>(range.end - 1) / chunkSize;
+          for (std::size_t chunk = static_cast<std::size_t>(range.start) / chunkSize; chunk <= last; ++chunk)
+            f(chunk);
+        }
+
+        std::vector<Chunk> itsChunks; //!< chunks, freed ones have null data
+        std::size_t itsSize; //!< position of end of data
+        std::size_t itsHeld; //!< number of bytes in chunks which were not freed
+        std::size_t itsPeakHeld; //!< max value reached by itsHeld
+        const std::size_t itsMaxSize; //!< max value of itsHeld
+        std::size_t itsOpenRanges; //!< number of ranges started and not finished
+        std::size_t itsOpenFrom; //!< start of outermost unfinished range
+        std::size_t itsKeptFrom; //!< first chunk which can't be freed - the last one or one used by unfinished range
+    };
+
+    //! Class used as an adapter to main stream and data of skipped shared objects
+    /*! Main stream can be used only for reading and reading position can move only forward.
+        Data of skipped shared objects is kept in SharedDataArena. Reading from its ranges
+        is done by pushing range on a stack. When end of range on top is reached reading
+        from previous range is continued. If there are no ranges on the stack data
+        is read from main stream. Range is released in arena when it's read fully.
+
+        Instead of main stream contiguous memory buffer can be used. In that case data is read
+        by moving pointer in buffer, see readMemory().
+
+        Additional functions for copying data from main stream to arena are provided (readToShared()).
      */
     class StreamAdapter
     {
       public:
-        //! Construct new object with main and secondary stream
+        //! Construct new object with main stream
         /*! @param stream main reading stream
-            @param sharedObjectStream secondary stream for which new reading positions could be given
-            @param maxBytesInSharedStream max size of data copied to other stream in readToOtherStream() method
+            @param maxBytesInSharedData max size of data copied from skipped shared objects
          */
-        StreamAdapter(std::istream & stream, std::stringstream & sharedObjectStream, std::size_t maxBytesInSharedStream)
-            : nowReading(nullptr), bytesLeft(0), endOfWritingStream(0), startOfStream(sharedObjectStream.tellg()),
-              mainStream(stream), backStream(sharedObjectStream), maxBytesSharedStream(maxBytesInSharedStream)
+        StreamAdapter(std::istream & stream, std::size_t maxBytesInSharedData)
+            : bytesLeft(0), mainStream(&stream), mainStreamPos(0), mainData(nullptr), mainDataBegin(nullptr),
+              mainDataEnd(nullptr), sharedData(maxBytesInSharedData)
         {}
 
-        //! Pushes new reading position on the stream
-        /*! @param streamPos new reading pos, saves reference which has to be valid for whole object lifetime
-            Throws if not enough bytes are read */
-        void pushReadingPos(StreamPos & streamPos)
+        //! Construct new object with main memory buffer
+        /*! @param data beginning of main memory buffer, has to be valid for whole object lifetime
+            @param size size of main memory buffer in bytes
+            @param maxBytesInSharedData max size of data copied from skipped shared objects
+         */
+        StreamAdapter(const void * data, std::size_t size, std::size_t maxBytesInSharedData)
+            : bytesLeft(0), mainStream(nullptr), mainStreamPos(0), mainData(reinterpret_cast<const std::uint8_t *>(data)),
+              mainDataBegin(mainData), mainDataEnd(reinterpret_cast<const std::uint8_t *>(data) + size),
+              sharedData(maxBytesInSharedData)
+        {}
+
+        //! Starts reading from other main stream, data of skipped shared objects is removed
+        /*! @param stream main reading stream */
+        void reset(std::istream & stream)
         {
-          if (nowReading == nullptr) {
-            // save backStream pos for restoration
-            endOfWritingStream = backStream.tellg();
-          } else {
+          resetShared();
+          mainStream = &stream;
+          mainStreamPos = 0;
+          mainData = mainDataBegin = mainDataEnd = nullptr;
+        }
+
+        //! Starts reading from other main memory buffer, data of skipped shared objects is removed
+        /*! @param data beginning of main memory buffer, has to be valid until next reset
+            @param size size of main memory buffer in bytes */
+        void reset(const void * data, std::size_t size)
+        {
+          resetShared();
+          mainStream = nullptr;
+          mainStreamPos = 0;
+          mainData = mainDataBegin = reinterpret_cast<const std::uint8_t *>(data);
+          mainDataEnd = mainDataBegin + size;
+        }
+
+        //! Pushes new reading range of skipped shared object data
+        /*! @param streamPos range finished with endSharedRange() */
+        void pushReadingPos(StreamPos const & streamPos)
+        {
+          if (false == readingShared.empty()) {
             // save current position when we get back to this level
-            backStreams.push(std::make_pair(backStream.tellg(), nowReading));
+            readingShared.back().pos = readPos;
           }
-          backStream.seekg(streamPos.start);
-          nowReading = &streamPos;
-          bytesLeft = streamPos.end - streamPos.start;
+          readPos = static_cast<std::size_t>(streamPos.start);
+          readingShared.push_back(SharedReading{streamPos, readPos});
+          bytesLeft = static_cast<std::size_t>(streamPos.end - streamPos.start);
         }
 
         //! Reads binary data from stream which is on top
         /*! @param data address to read to
             @param size size of data to read
             Size has to be less or equal to data available at the current stream position. That is:
-            - If using streamPos on queue - end of current streamPos
+            - If reading range of skipped object - end of that range
             - If using mainStream - end of mainStream
             Throws if not enough bytes are read. */
         inline std::size_t readBinary(void *const data, std::size_t size)
         {
           std::size_t readSize;
-          if (nowReading == nullptr) {
-            readSize = static_cast<std::size_t>( mainStream.rdbuf()->sgetn(reinterpret_cast<char *>( data ), size));
+          if (readingShared.empty()) {
+            if (mainStream == nullptr) {
+              readSize = std::min(size, static_cast<std::size_t>(mainDataEnd - mainData));
+              std::memcpy(data, mainData, readSize);
+              mainData += readSize;
+            } else {
+              readSize = static_cast<std::size_t>( mainStream->rdbuf()->sgetn(reinterpret_cast<char *>( data ), size));
+              mainStreamPos += readSize;
+            }
           } else {
             if (size > bytesLeft) {
               throw Exception("went to far reading skipped shared object stream");
             }
-            readSize = static_cast<std::size_t>( backStream.rdbuf()->sgetn(reinterpret_cast<char *>( data ), size));
-            bytesLeft -= readSize;
-            if (0 == bytesLeft) {
-              popStream();
-            }
+            sharedData.read(readPos, data, size);
+            readSize = size;
+            advanceShared(size);
           }
           return readSize;
         }
 
+        //! Gets size bytes directly from main memory buffer
+        /*! Reading position is moved by size bytes.
+            @param size number of bytes to read
+            @return address of data in memory buffer or nullptr if data is not read from memory buffer
+                    (main stream is used or skipped shared object is being read)
+            Throws Exception if there are less than size bytes left in buffer. */
+        inline const std::uint8_t * readMemory(std::size_t size)
+        {
+          if (false == readingShared.empty() || mainStream != nullptr) {
+            return nullptr;
+          }
+          if (static_cast<std::size_t>(mainDataEnd - mainData) < size) {
+            throw Exception("Failed to read " + std::to_string(size) + " bytes from input buffer! Left "
+                            + std::to_string(mainDataEnd - mainData));
+          }
+          const std::uint8_t * data = mainData;
+          mainData += size;
+          return data;
+        }
+
+        //! Gets remaining data in main memory buffer without moving reading position
+        /*! @param available set to number of bytes left in buffer
+            @return address of current reading position or nullptr if data is not read from memory buffer
+                    (main stream is used or skipped shared object is being read)
+            @see skipMemory() */
+        inline const std::uint8_t * peekMemory(std::size_t & available) const
+        {
+          if (false == readingShared.empty() || mainStream != nullptr) {
+            return nullptr;
+          }
+          available = static_cast<std::size_t>(mainDataEnd - mainData);
+          return mainData;
+        }
+
+        //! Moves reading position of main memory buffer
+        /*! size has to be less or equal to available size returned by peekMemory() */
+        inline void skipMemory(std::size_t size)
+        {
+          mainData += size;
+        }
+
         //! Discards size bytes from the input stream
         /*! @param size The number of bytes of data
             Throws if not enough bytes are read */
         inline void skipData(std::size_t size)
         {
-          bool streamError;
-          if (nowReading == nullptr) {
-            mainStream.ignore(size);
-            streamError = !mainStream; // we don't care about eof here
+          bool streamError = false;
+          if (readingShared.empty()) {
+            if (mainStream == nullptr) {
+              streamError = static_cast<std::size_t>(mainDataEnd - mainData) < size;
+              if (false == streamError) {
+                mainData += size;
+              }
+            } else {
+              mainStream->ignore(size);
+              streamError = !*mainStream; // we don't care about eof here
+              mainStreamPos += size;
+            }
           } else {
             if (size > bytesLeft) {
               throw Exception("went to far reading skipped shared object stream");
             }
-            backStream.ignore(size);
-            streamError = !backStream; // we don't care about eof here
-            bytesLeft -= size;
-            if (0 == bytesLeft) {
-              popStream();
-            }
+            advanceShared(size);
           }
           if (streamError)
             throw Exception("Failed to skip " + std::to_string(size) + " bytes from input stream!");
         }
 
-        //! Check if by adding size bytes limit for max copied data is hit
-        /*! @param size additional size bytes to read
-            @param stream Stream used for data copying
-            Throws Exception if limit would be hit */
-        inline void checkIfMaxSize(std::size_t size, std::ostream& stream)
+        //! Copies data which was already read to data of skipped shared objects
+        /*! Throws Exception if limit of copied data is hit */
+        inline void copyToShared(const void * data, std::size_t size)
         {
-          std::size_t posNow = static_cast<std::size_t>(stream.tellp());
-          if (posNow - startOfStream + size > maxBytesSharedStream) {
-            throw Exception("Shared obiect shared data limit hit");
-          }
+          sharedData.append(data, size);
         }
 
-        //! Reads size bytes from the input stream and copies them to other stream
+        //! Reads size bytes from the input stream and copies them to data of skipped shared objects
         /*! @param size The number of bytes to read and copy
-            @param stream Stream to copy data to
-            Throws Exception if not enough bytes are read */
-        inline void readToOtherStream(std::size_t size, std::ostream & stream)
-        {
-          checkIfMaxSize(size, stream);
-          auto copyN = [](std::istream & from, std::size_t sizeToCopy, std::ostream & to) {
-            auto start = std::istreambuf_iterator<char>(from);
-            auto end = std::istreambuf_iterator<char>();
-            auto dest = std::ostreambuf_iterator<char>(to);
-            for (; sizeToCopy > 0 && start != end; ++start, ++dest, --sizeToCopy) {
-              *dest = *start;
-            }
-            if (0 != sizeToCopy)
+            Throws Exception if not enough bytes are read or limit of copied data is hit */
+        inline void readToShared(std::size_t size)
+        {
+          if (readingShared.empty()) {
+            if (mainStream == nullptr) {
+              if (static_cast<std::size_t>(mainDataEnd - mainData) < size)
+                throw Exception("Failed to skip data from input stream!");
+              sharedData.append(mainData, size);
+              mainData += size;
+            } else if (sharedData.append(*mainStream, size) != size) {
               throw Exception("Failed to skip data from input stream!");
-          };
-
-          if (nowReading == nullptr) {
-            copyN(mainStream, size, stream);
+            } else {
+              mainStreamPos += size;
+            }
           } else {
-            // shouldn't be here, there is no point in copying data if we are reading from backStream
-            assert(false);
+            // skipped object nested in object which is read from skipped data
             if (size > bytesLeft) {
               throw Exception("went to far reading skipped shared object stream");
             }
-            copyN(mainStream, size, stream);
-            bytesLeft -= size;
-            if (0 == bytesLeft) {
-              popStream();
-            }
+            sharedData.append(readPos, size);
+            advanceShared(size);
           }
         }
 
+        //! Starts range of skipped shared object, following data copied with copyToShared() or readToShared() belongs to it
+        /*! @return start of range which has to be passed to endSharedRange() */
+        inline std::size_t beginSharedRange()
+        {
+          return sharedData.beginRange();
+        }
+
+        //! Finishes range started with beginSharedRange()
+        /*! @return range which can be read with pushReadingPos() */
+        inline StreamPos endSharedRange(std::size_t start)
+        {
+          return sharedData.endRange(start);
+        }
+
+        //! Releases range of skipped shared object which won't be read
+        inline void releaseSharedRange(StreamPos const & range)
+        {
+          sharedData.release(range);
+        }
+
+        //! Gets reading position in data which is read now
+        /*! Position is number of bytes read from main stream or memory buffer, or position in range
+            of skipped object if it's being read. Positions can be compared only if source() is the same. */
+        inline std::size_t position() const
+        {
+          if (false == readingShared.empty())
+            return readPos;
+          if (mainStream == nullptr)
+            return static_cast<std::size_t>(mainData - mainDataBegin);
+          return mainStreamPos;
+        }
+
+        //! Gets identifier of data which is read now, number of ranges of skipped objects being read
+        inline std::size_t source() const
+        {
+          return readingShared.size();
+        }
+
+        //! Gets max number of bytes of skipped shared objects data kept at once
+        inline std::size_t sharedDataPeak() const
+        {
+          return sharedData.peakHeld();
+        }
+
       private:
 
-        //! Finish reading current StreamPos
+        //! Forgets ranges being read and data of skipped shared objects
+        void resetShared()
+        {
+          readingShared.clear();
+          readPos = 0;
+          bytesLeft = 0;
+          sharedData.clear();
+        }
+
+        //! Moves reading position in range on top by size bytes
+        /*! Range is finished and released when its end is reached */
+        void advanceShared(std::size_t size)
+        {
+          readPos += size;
+          bytesLeft -= size;
+          if (0 == bytesLeft) {
+            popStream();
+          }
+        }
+
+        //! Finish reading current range
         void popStream()
         {
-          if (backStreams.empty()) {
-            // move backStream back where it was for writing
-            backStream.seekg(endOfWritingStream);
-            nowReading = nullptr;
-            bytesLeft = 0;
+          sharedData.release(readingShared.back().range);
+          readingShared.pop_back();
+          if (false == readingShared.empty()) {
+            const auto & next = readingShared.back();
+            readPos = next.pos;
+            bytesLeft = static_cast<std::size_t>(next.range.end) - readPos;
           } else {
-            const auto & next = backStreams.back();
-            backStream.seekg(next.first);
-            // we read something before so next.first has to be used
-            bytesLeft = next.second->end - next.first;
-            nowReading = next.second;
-            backStreams.pop();
+            bytesLeft = 0;
           }
         }
 
       private:
-        StreamPos *nowReading; //!< current reading stream position
-        std::size_t bytesLeft; //!< how many bytes are left for nowReading position
-        std::size_t endOfWritingStream; //!< end of writing backStream,
-                                        //!< will be restored when reading from other position is done
-        const std::size_t startOfStream; //!< start of stream at construction of object
-        std::queue<std::pair<std::size_t, StreamPos *>> backStreams;
-        std::istream & mainStream; //!< main reading stream
-        std::istream & backStream; //!< stream to keep data from skipped shared pointers
-        const std::size_t maxBytesSharedStream; //!< max allowed size of data copied to backStream
+        //! Range of skipped object being read
+        struct SharedReading
+        {
+          StreamPos range;
+          std::size_t pos; //!< position where reading has to be continued
+        };
+
+        std::vector<SharedReading> readingShared; //!< stack of ranges being read, top range is read now
+        std::size_t readPos = 0; //!< reading position in range on top
+        std::size_t bytesLeft; //!< how many bytes are left in range on top
+        std::istream * mainStream; //!< main reading stream, nullptr if memory buffer is used
+        std::size_t mainStreamPos; //!< number of bytes read from main stream
+        const std::uint8_t * mainData; //!< current reading position of main memory buffer
+        const std::uint8_t * mainDataBegin; //!< beginning of main memory buffer
+        const std::uint8_t * mainDataEnd; //!< end of main memory buffer
+        SharedDataArena sharedData; //!< data of skipped shared pointers
     };
   } // namespace extendable_binary_detail
 } // namespace cereal
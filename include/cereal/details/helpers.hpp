@@ -36,10 +36,15 @@
 #include <memory>
 #include <unordered_map>
 #include <stdexcept>
+#include <mutex>
 
 #include <cereal/macros.hpp>
 #include <cereal/details/static_object.hpp>
 
+#if CEREAL_HAS_PMR
+#include <memory_resource>
+#endif // CEREAL_HAS_PMR
+
 namespace cereal
 {
   // ######################################################################
@@ -241,10 +246,31 @@ namespace cereal
     {
       public:
         InputArchiveBase() = default;
+        #if CEREAL_HAS_PMR
+        InputArchiveBase( InputArchiveBase && other ) CEREAL_NOEXCEPT : itsMemoryResource( other.itsMemoryResource ) {}
+        InputArchiveBase & operator=( InputArchiveBase && other ) CEREAL_NOEXCEPT
+        {
+          itsMemoryResource = other.itsMemoryResource;
+          return *this;
+        }
+        #else // NOT CEREAL_HAS_PMR
         InputArchiveBase( InputArchiveBase && ) CEREAL_NOEXCEPT {}
         InputArchiveBase & operator=( InputArchiveBase && ) CEREAL_NOEXCEPT { return *this; }
+        #endif // NOT CEREAL_HAS_PMR
         virtual ~InputArchiveBase() CEREAL_NOEXCEPT = default;
 
+      #if CEREAL_HAS_PMR
+      protected:
+        //! Memory resource of MemoryResourceAdapter, so it's found without dynamic_cast
+        std::pmr::memory_resource * itsMemoryResource = nullptr;
+
+        //! Gets memory resource of archive, nullptr if archive is not wrapped by MemoryResourceAdapter
+        friend std::pmr::memory_resource * memoryResourceOf( InputArchiveBase const & ar )
+        {
+          return ar.itsMemoryResource;
+        }
+      #endif // CEREAL_HAS_PMR
+
       private:
         virtual void rtti() {}
     };
@@ -258,6 +284,87 @@ namespace cereal
     static const int32_t msb2_32bit = 0x40000000;
   }
 
+  #if CEREAL_HAS_PMR
+  // ######################################################################
+  //! Wraps an input archive and gives it a memory resource for loaded pointers
+  /*! Objects behind std::shared_ptr, and behind std::unique_ptr with a
+      memory_resource_delete deleter, are allocated from the resource
+      instead of with new.  Together with containers that use
+      std::pmr::polymorphic_allocator this allows a whole message to be
+      loaded into e.g. a std::pmr::monotonic_buffer_resource and released at once.
+
+      @code{.cpp}
+      std::pmr::monotonic_buffer_resource arena;
+      std::pmr::vector<std::shared_ptr<MyClass>> objects( &arena );
+
+      cereal::MemoryResourceAdapter<cereal::BinaryInputArchive> ar( arena, is );
+      ar( objects ); // the vector and the objects are allocated in arena
+      @endcode
+
+      The resource has to outlive all objects loaded into it.  The adapter
+      can't be combined with UserDataAdapter.
+
+      @relates get_memory_resource
+      @tparam Archive The archive to wrap */
+  template <class Archive>
+  class MemoryResourceAdapter : public Archive
+  {
+    public:
+      //! Construct the archive with a memory resource
+      /*! This will forward all arguments (other than the resource)
+          to the wrapped archive type.
+
+          @tparam Args The arguments to pass to the constructor of
+                       the archive. */
+      template <class ... Args>
+      MemoryResourceAdapter( std::pmr::memory_resource & resource, Args && ... args ) :
+        Archive( std::forward<Args>( args )... )
+      {
+        static_assert( std::is_base_of<detail::InputArchiveBase, Archive>::value,
+                       "MemoryResourceAdapter can only wrap input archives" );
+        this->itsMemoryResource = &resource;
+      }
+
+      //! The memory resource loaded pointers are allocated from
+      std::pmr::memory_resource & resource() const
+      {
+        return *this->itsMemoryResource;
+      }
+
+    private:
+      //! Overload the rtti function to enable dynamic_cast
+      void rtti() {}
+  };
+
+  namespace detail
+  {
+    //! Input archives keep memory resource of MemoryResourceAdapter in their base
+    template <class Archive> inline
+    std::pmr::memory_resource * get_memory_resource( Archive & ar, std::true_type )
+    {
+      return memoryResourceOf( ar );
+    }
+
+    //! Other archives can't be wrapped by MemoryResourceAdapter
+    template <class Archive> inline
+    std::pmr::memory_resource * get_memory_resource( Archive &, std::false_type )
+    {
+      return nullptr;
+    }
+  } // namespace detail
+
+  //! Retrieves the memory resource of an archive wrapped by MemoryResourceAdapter
+  /*! The resource is kept by the base of every input archive, so archives which are
+      not wrapped pay only for reading a null pointer.
+      @relates MemoryResourceAdapter
+      @return The memory resource or nullptr if the archive is not wrapped */
+  template <class Archive> inline
+  std::pmr::memory_resource * get_memory_resource( Archive & ar )
+  {
+    return detail::get_memory_resource( ar, std::is_base_of<detail::InputArchiveBase, Archive>() );
+  }
+  #endif // CEREAL_HAS_PMR
+
   // ######################################################################
   //! A wrapper around size metadata
   /*! This class provides a way for archives to have more flexibility over how
@@ -588,6 +695,8 @@ namespace cereal
     struct Versions
     {
       std::unordered_map<std::size_t, std::uint32_t> mapping;
+      //! Guards find(), which is called at run time from any thread, even without CEREAL_THREAD_SAFE
+      std::mutex findMutex;
 
       std::uint32_t find( std::size_t hash, std::uint32_t version )
       {
@@ -0,0 +1,209 @@
+/*! \file pointer_tables.hpp
+    \brief Tables tracking shared pointers in archives
+    \ingroup Internal */
+/*
+  Copyright (c) 2016, Randolph Voorhies, Shane Grant, Michal Breiter
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT OR MICHAL BREITER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_DETAILS_POINTER_TABLES_HPP_
+#define CEREAL_DETAILS_POINTER_TABLES_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace cereal
+{
+  namespace detail
+  {
+    //! Maps addresses of saved shared pointers to their ids
+    /*! Open addressed table with linear probing. Slots are kept in one vector,
+        inserting pointer doesn't allocate unless table has to grow.
+        Null address marks empty slot, it's never inserted.
+        @internal */
+    class OutputPointerTable
+    {
+      public:
+        OutputPointerTable() : itsSize(0) {}
+
+        //! Finds id of address or inserts given id if address is new
+        /*! @param addr address of pointed object, not null
+            @param id id used if address was not inserted before
+            @return id of address and true if it was inserted now */
+        std::pair<std::uint32_t, bool> insert( void const * addr, std::uint32_t id )
+        {
+          if( (itsSize + 1) * 2 > itsSlots.size() )
+            rehash( itsSlots.empty() ? std::size_t( minCapacity ) : itsSlots.size() * 2 );
+
+          std::size_t const mask = itsSlots.size() - 1;
+          for( std::size_t i = hash( addr ) & mask;; i = (i + 1) & mask )
+          {
+            Slot & slot = itsSlots[i];
+            if( slot.addr == addr )
+              return {slot.id, false};
+            if( slot.addr == nullptr )
+            {
+              slot.addr = addr;
+              slot.id = id;
+              ++itsSize;
+              return {id, true};
+            }
+          }
+        }
+
+        //! Makes space for count pointers, so inserting them won't allocate
+        void reserve( std::size_t count )
+        {
+          std::size_t capacity = minCapacity;
+          while( capacity < count * 2 )
+            capacity *= 2;
+          if( capacity > itsSlots.size() )
+            rehash( capacity );
+        }
+
+        //! Removes all pointers, memory is kept for reuse
+        void clear()
+        {
+          if( itsSize == 0 )
+            return;
+          for( auto & slot : itsSlots )
+            slot.addr = nullptr;
+          itsSize = 0;
+        }
+
+        //! Number of inserted pointers
+        std::size_t size() const { return itsSize; }
+
+      private:
+        struct Slot
+        {
+          void const * addr;
+          std::uint32_t id;
+        };
+
+        static const std::size_t minCapacity = 16;
+
+        //! Mixes address bits, low bits of address are usually zero due to alignment
+        static std::size_t hash( void const * addr )
+        {
+          std::uint64_t h = static_cast<std::uint64_t>( reinterpret_cast<std::uintptr_t>( addr ) ) * 0x9E3779B97F4A7C15ULL;
+          return static_cast<std::size_t>( h ^ (h >> 32) );
+        }
+
+        //! Moves all pointers to table with given capacity (power of 2)
+        void rehash( std::size_t capacity )
+        {
+          std::vector<Slot> old( capacity, Slot{nullptr, 0} );
+          old.swap( itsSlots );
+
+          std::size_t const mask = capacity - 1;
+          for( auto const & slot : old )
+          {
+            if( slot.addr == nullptr )
+              continue;
+            std::size_t i = hash( slot.addr ) & mask;
+            while( itsSlots[i].addr != nullptr )
+              i = (i + 1) & mask;
+            itsSlots[i] = slot;
+          }
+        }
+
+        std::vector<Slot> itsSlots; //!< power of 2 number of slots, or empty
+        std::size_t itsSize; //!< number of used slots
+    };
+
+    //! Maps ids of loaded shared pointers to pointers
+    /*! Ids are assigned consecutively when saving, so pointers are kept
+        in vector indexed by id. Id far beyond already known ones
+        (e.g. from corrupted data) is kept in separate map instead of
+        growing vector to arbitrary size. Registered pointer can be null,
+        so presence of id is tracked separately from pointer.
+        @internal */
+    class InputPointerTable
+    {
+      public:
+        //! Finds pointer registered for id
+        /*! @return registered pointer or nullptr if id was not registered */
+        std::shared_ptr<void> const * find( std::uint32_t id ) const
+        {
+          if( id < itsPointers.size() && itsPointers[id].occupied )
+            return &itsPointers[id].ptr;
+          if( itsSparse.empty() )
+            return nullptr;
+          auto iter = itsSparse.find( id );
+          return iter == itsSparse.end() ? nullptr : &iter->second;
+        }
+
+        //! Registers pointer for id, replacing previous one
+        void set( std::uint32_t id, std::shared_ptr<void> ptr )
+        {
+          if( id >= itsPointers.size() )
+          {
+            if( id - itsPointers.size() > maxGap )
+            {
+              itsSparse[id] = std::move( ptr );
+              return;
+            }
+            itsPointers.resize( id + 1 );
+          }
+          itsPointers[id].ptr = std::move( ptr );
+          itsPointers[id].occupied = true;
+        }
+
+        //! Makes space for count pointers, so registering them won't allocate
+        void reserve( std::size_t count )
+        {
+          itsPointers.reserve( count + 1 );
+        }
+
+        //! Releases all pointers, memory of table is kept for reuse
+        void clear()
+        {
+          itsPointers.clear();
+          itsSparse.clear();
+        }
+
+      private:
+        struct Slot
+        {
+          Slot() : occupied(false) {}
+
+          std::shared_ptr<void> ptr;
+          bool occupied; //!< true if pointer was registered for id
+        };
+
+        //! Maximal distance of id from already known ones to be kept in vector
+        static const std::uint32_t maxGap = 1024;
+
+        std::vector<Slot> itsPointers; //!< pointers indexed by id
+        std::unordered_map<std::uint32_t, std::shared_ptr<void>> itsSparse; //!< pointers with ids outside of vector
+    };
+  } // namespace detail
+} // namespace cereal
+
+#endif // CEREAL_DETAILS_POINTER_TABLES_HPP_
@@ -49,9 +49,13 @@
 #include <cereal/details/static_object.hpp>
 #include <cereal/types/memory.hpp>
 #include <cereal/types/string.hpp>
+#include <atomic>
+#include <forward_list>
 #include <functional>
 #include <typeindex>
 #include <map>
+#include <memory>
+#include <vector>
 
 //! Binds a polymorhic type to all registered archives
 /*! This binds a polymorphic type to all compatible registered archives that
@@ -74,6 +78,118 @@
 
 namespace cereal
 {
+  namespace detail
+  {
+    //! Read-mostly hash table over registry map
+    /*! Registries are ordered maps filled during static initialization. On first lookup
+        entries are copied to flat open addressed table which is then published atomically.
+        Later lookups don't lock and cost one hash and usually one key comparison.
+
+        Registration has to call invalidate(); table is rebuilt on next lookup.
+        Invalidated tables are kept until registry is destroyed, so concurrent
+        readers never see freed memory. As with registry map itself, lookups
+        concurrent with registration are not supported.
+
+        @tparam Key key type of registry map
+        @tparam Value value type of registry map, table keeps pointers to values in map
+        @tparam Hash hash function for Key
+        @internal */
+    template <class Key, class Value, class Hash = std::hash<Key>>
+    class FlatLookupTable
+    {
+      public:
+        FlatLookupTable() : itsCurrent(nullptr), itsRetired(nullptr) {}
+        FlatLookupTable( FlatLookupTable const & ) = delete;
+        FlatLookupTable & operator=( FlatLookupTable const & ) = delete;
+
+        ~FlatLookupTable()
+        {
+          invalidate();
+          while( itsRetired )
+          {
+            Table * older = itsRetired->older;
+            delete itsRetired;
+            itsRetired = older;
+          }
+        }
+
+        //! Finds value for key
+        /*! @param key key to find
+            @param map registry map, used only if table has to be built
+            @return pointer to value in registry map or nullptr if key is not registered */
+        template <class Map>
+        Value const * find( Key const & key, Map const & map ) const
+        {
+          Table const * table = itsCurrent.load( std::memory_order_acquire );
+          if( table == nullptr )
+          {
+            if( map.empty() )
+              return nullptr;
+            table = build( map );
+          }
+
+          for( std::size_t i = Hash()( key ) & table->mask;; i = (i + 1) & table->mask )
+          {
+            auto const & slot = table->slots[i];
+            if( slot.second == nullptr )
+              return nullptr;
+            if( slot.first == key )
+              return slot.second;
+          }
+        }
+
+        //! Drops current table, has to be called after registry map is modified
+        void invalidate()
+        {
+          Table * table = itsCurrent.exchange( nullptr, std::memory_order_acq_rel );
+          if( table )
+          {
+            table->older = itsRetired;
+            itsRetired = table;
+          }
+        }
+
+      private:
+        struct Table
+        {
+          std::vector<std::pair<Key, Value const *>> slots; //!< empty slot has nullptr value
+          std::size_t mask;
+          Table * older;
+        };
+
+        //! Copies registry map to new table and publishes it
+        /*! If other thread published table first, its table is used.
+            Map cannot be empty. */
+        template <class Map>
+        Table const * build( Map const & map ) const
+        {
+          std::size_t capacity = 2;
+          while( capacity < 2 * map.size() )
+            capacity *= 2;
+
+          std::unique_ptr<Table> table( new Table() );
+          table->slots.resize( capacity, std::make_pair( map.begin()->first, static_cast<Value const *>( nullptr ) ) );
+          table->mask = capacity - 1;
+          table->older = nullptr;
+          for( auto const & entry : map )
+          {
+            std::size_t i = Hash()( entry.first ) & table->mask;
+            while( table->slots[i].second != nullptr )
+              i = (i + 1) & table->mask;
+            table->slots[i] = std::make_pair( entry.first, &entry.second );
+          }
+
+          Table * expected = nullptr;
+          if( itsCurrent.compare_exchange_strong( expected, table.get(), std::memory_order_acq_rel ) )
+            return table.release();
+          return expected;
+        }
+
+        mutable std::atomic<Table *> itsCurrent; //!< table used for lookups
+        Table * itsRetired; //!< invalidated tables
+    };
+  } // namespace detail
+
   /* Polymorphic casting support */
   namespace detail
   {
@@ -115,6 +231,26 @@ namespace cereal
       //! Maps from base type index to a map from derived type index to caster
       std::map<std::type_index, std::map<std::type_index, std::vector<PolymorphicCaster const*>>> map;
 
+      //! (base, derived) pair used as key for cast path lookups
+      using CastKey = std::pair<std::type_index, std::type_index>;
+
+      //! Hash for CastKey
+      struct CastKeyHash
+      {
+        std::size_t operator()( CastKey const & key ) const
+        { return key.first.hash_code() * 31 + key.second.hash_code(); }
+      };
+
+      //! Flattened (base, derived) -> cast path mapping, filled from map
+      /*! Entries are never removed, lookup tables keep pointers to them */
+      std::map<CastKey, std::vector<PolymorphicCaster const*>> paths;
+
+      //! Storage of paths replaced in paths, kept alive for lookups which found them before
+      std::forward_list<std::vector<PolymorphicCaster const*>> retiredPaths;
+
+      //! Lookup table over paths, used when serializing
+      FlatLookupTable<CastKey, std::vector<PolymorphicCaster const*>, CastKeyHash> pathTable;
+
       //! Error message used for unregistered polymorphic casts
       #define UNREGISTERED_POLYMORPHIC_CAST_EXCEPTION(LoadSave)                                                                                                                \
         throw cereal::Exception("Trying to " #LoadSave " a registered polymorphic type with an unregistered polymorphic cast.\n"                                               \
@@ -150,21 +286,45 @@ namespace cereal
       template <class F> inline
       static std::vector<PolymorphicCaster const *> const & lookup( std::type_index const & baseIndex, std::type_index const & derivedIndex, F && exceptionFunc )
       {
-        // First phase of lookup - match base type index
+        auto const & casters = StaticObject<PolymorphicCasters>::getInstance();
+        auto const * path = casters.pathTable.find( CastKey( baseIndex, derivedIndex ), casters.paths );
+        if( path == nullptr )
+          exceptionFunc();
+
+        return *path;
+      }
+
+      //! Gets the mapping object directly from map, used during registration
+      /*! @return path of casters, empty if there is no registered mapping */
+      static std::vector<PolymorphicCaster const *> lookupMap( std::type_index const & baseIndex, std::type_index const & derivedIndex )
+      {
         auto const & baseMap = StaticObject<PolymorphicCasters>::getInstance().map;
         auto baseIter = baseMap.find( baseIndex );
         if( baseIter == baseMap.end() )
-          exceptionFunc();
+          return {};
 
-        // Second phase - find a match from base to derived
-        auto & derivedMap = baseIter->second;
-        auto derivedIter = derivedMap.find( derivedIndex );
-        if( derivedIter == derivedMap.end() )
-          exceptionFunc();
+        auto derivedIter = baseIter->second.find( derivedIndex );
+        if( derivedIter == baseIter->second.end() )
+          return {};
 
         return derivedIter->second;
       }
 
+      //! Copies path of casters between base and derived from map to flattened paths
+      /*! Has to be called with StaticObject<PolymorphicCasters> locked, after the path
+          in map was added or modified. Storage of previous path is retired, not freed. */
+      void updatePath( std::type_index const & baseIndex, std::type_index const & derivedIndex )
+      {
+        auto const & path = map.find( baseIndex )->second.find( derivedIndex )->second;
+        auto inserted = paths.emplace( CastKey( baseIndex, derivedIndex ), path );
+        if( inserted.second )
+          return;
+
+        retiredPaths.emplace_front();
+        retiredPaths.front().swap( inserted.first->second );
+        inserted.first->second = path;
+      }
+
       //! Performs a downcast to the derived type using a registered mapping
       template <class Derived> inline
       static const Derived * downcast( const void * dptr, std::type_info const & baseInfo )
@@ -222,13 +382,15 @@ namespace cereal
         auto & baseMap = StaticObject<PolymorphicCasters>::getInstance().map;
         auto baseKey = std::type_index(typeid(Base));
         auto lb = baseMap.lower_bound(baseKey);
+        auto & casters = StaticObject<PolymorphicCasters>::getInstance();
 
         {
           auto & derivedMap = baseMap.insert( lb, {baseKey, {}} )->second;
           auto derivedKey = std::type_index(typeid(Derived));
           auto lbd = derivedMap.lower_bound(derivedKey);
-          auto & derivedVec = derivedMap.insert( lbd, { std::move(derivedKey), {}} )->second;
+          auto & derivedVec = derivedMap.insert( lbd, { derivedKey, {}} )->second;
           derivedVec.push_back( this );
+          casters.updatePath( baseKey, derivedKey );
         }
 
         // Find all chainable unregistered relations
@@ -237,7 +399,7 @@ namespace cereal
           auto checkRelation = [](std::type_index const & baseInfo, std::type_index const & derivedInfo)
           {
             const bool exists = PolymorphicCasters::exists( baseInfo, derivedInfo );
-            return std::make_pair( exists, exists ? PolymorphicCasters::lookup( baseInfo, derivedInfo, [](){} ) :
+            return std::make_pair( exists, exists ? PolymorphicCasters::lookupMap( baseInfo, derivedInfo ) :
                                                     std::vector<PolymorphicCaster const *>{} );
           };
 
@@ -282,7 +444,10 @@ namespace cereal
         {
           auto & derivedMap = baseMap.find( it.first )->second;
           derivedMap[it.second.first] = it.second.second;
+          casters.updatePath( it.first, it.second.first );
         }
+
+        casters.pathTable.invalidate();
       }
 
       //! Performs the proper downcast with the templated types
@@ -361,6 +526,14 @@ namespace cereal
 
       //! A map of serializers for pointers of all registered types
       std::map<std::type_index, Serializers> map;
+
+      //! Lookup table over map, used when serializing
+      FlatLookupTable<std::type_index, Serializers> table;
+
+      //! Finds serializers for type
+      /*! @return serializers or nullptr if type is not registered */
+      Serializers const * find( std::type_index const & key ) const
+      { return table.find( key, map ); }
     };
 
     //! An empty noop deleter
@@ -393,6 +566,14 @@ namespace cereal
 
       //! A map of serializers for pointers of all registered types
       std::map<std::string, Serializers> map;
+
+      //! Lookup table over map, used when serializing
+      FlatLookupTable<std::string, Serializers> table;
+
+      //! Finds serializers for type name
+      /*! @return serializers or nullptr if name is not registered */
+      Serializers const * find( std::string const & key ) const
+      { return table.find( key, map ); }
     };
 
     // forward decls for archives from cereal.hpp
@@ -442,6 +623,7 @@ namespace cereal
           };
 
         map.insert( lb, { std::move(key), std::move(serializers) } );
+        StaticObject<InputBindingMap<Archive>>::getInstance().table.invalidate();
       }
     };
 
@@ -465,7 +647,7 @@ namespace cereal
         // If the msb of the id is 1, then the type name is new, and we should serialize it
         if( id & detail::msb_32bit )
         {
-          std::string namestring(name);
+          static const std::string namestring(name);
           ar( CEREAL_NVP_("polymorphic_name", make_polymorphic_key_tag(namestring)) );
         }
       }
@@ -530,6 +712,7 @@ namespace cereal
       OutputBindingCreator()
       {
         auto & map = StaticObject<OutputBindingMap<Archive>>::getInstance().map;
+        auto lock = StaticObject<OutputBindingMap<Archive>>::lock();
         auto key = std::type_index(typeid(T));
         auto lb = map.lower_bound(key);
 
@@ -565,6 +748,7 @@ namespace cereal
           };
 
         map.insert( { std::move(key), std::move(serializers) } );
+        StaticObject<OutputBindingMap<Archive>>::getInstance().table.invalidate();
       }
     };
 
@@ -1349,6 +1349,9 @@ namespace cereal
                      "} \n\n" );
       static T * load_andor_construct()
       { return ::cereal::access::construct<T>(); }
+
+      static T * load_andor_construct( void * storage )
+      { return ::cereal::access::construct<T>( storage ); }
     };
 
     // member non-versioned
@@ -56,6 +56,28 @@
 #define CEREAL_THREAD_SAFE 0
 #endif // CEREAL_THREAD_SAFE
 
+#ifndef CEREAL_RESERVE_LIMIT
+//! The maximum number of bytes a container reserves before loading its elements
+/*! Container sizes are read from the archive and a corrupted or malicious archive
+    can claim any size. Containers reserve space for at most this many bytes
+    worth of elements up front and grow as usual while the elements are loaded. */
+#define CEREAL_RESERVE_LIMIT (1 << 20)
+#endif // CEREAL_RESERVE_LIMIT
+
+#ifndef CEREAL_HAS_PMR
+//! Whether polymorphic allocators (std::pmr) are available
+/*! Enables MemoryResourceAdapter and memory_resource_delete.
+    Requires C++17 and the <memory_resource> header. */
+#if defined(__has_include)
+  #if __has_include(<memory_resource>) && (__cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L))
+    #define CEREAL_HAS_PMR 1
+  #endif
+#endif
+#ifndef CEREAL_HAS_PMR
+  #define CEREAL_HAS_PMR 0
+#endif
+#endif // CEREAL_HAS_PMR
+
 // ######################################################################
 #ifndef CEREAL_SERIALIZE_FUNCTION_NAME
 //! The serialization/deserialization function name to search for.
@@ -118,4 +140,12 @@
   #endif // end !defined(CEREAL_HAS_NOEXCEPT)
 #endif // ifndef CEREAL_NOEXCEPT
 
+// ######################################################################
+// Work around MSVC not having alignof
+#if defined(_MSC_VER) && _MSC_VER < 1900
+#define CEREAL_ALIGNOF __alignof
+#else // not MSVC 2013 or older
+#define CEREAL_ALIGNOF alignof
+#endif // end MSVC check
+
 #endif // CEREAL_MACROS_HPP_
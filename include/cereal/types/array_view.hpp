@@ -0,0 +1,169 @@
+/*! \file array_view.hpp
+    \brief Non-owning views of strings and arrays of arithmetic types
+    \ingroup OtherTypes */
+/*
+  Copyright (c) 2016, Randolph Voorhies, Shane Grant, Michal Breiter
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT OR MICHAL BREITER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_TYPES_ARRAY_VIEW_HPP_
+#define CEREAL_TYPES_ARRAY_VIEW_HPP_
+
+#include <cereal/cereal.hpp>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace cereal
+{
+  //! Non-owning view of contiguous array of arithmetic type
+  /*! Saved in the same way as std::vector and std::basic_string of the same element type,
+      so data saved from these types can be loaded to view and the other way round.
+
+      Archives which can read from memory buffer (e.g. ExtendableBinaryInputArchive constructed
+      with pointer and size) can load view pointing directly into input buffer. In that case
+      buffer has to outlive the view. When data cannot be used in place (stream input, different
+      endianness, misaligned data) it is copied to storage owned by the view.
+
+      @tparam T type of element
+      \ingroup OtherTypes */
+  template <class T>
+  class ArrayView
+  {
+    static_assert(std::is_arithmetic<T>::value, "ArrayView supports only arithmetic types");
+
+    public:
+      using value_type = T;
+      using const_iterator = const T *;
+
+      //! Construct empty view
+      ArrayView() : itsData(nullptr), itsSize(0) {}
+
+      //! Construct view of size elements starting at data
+      ArrayView(const T * data, std::size_t size) : itsData(data), itsSize(size) {}
+
+      //! Construct view of string
+      template <class Traits, class Alloc>
+      ArrayView(std::basic_string<T, Traits, Alloc> const & str) : itsData(str.data()), itsSize(str.size()) {}
+
+      //! Construct view of vector
+      template <class Alloc>
+      ArrayView(std::vector<T, Alloc> const & vec) : itsData(vec.data()), itsSize(vec.size()) {}
+
+      ArrayView(ArrayView const & other) : itsData(other.itsData), itsSize(other.itsSize), itsCopy(other.itsCopy)
+      {
+        if(other.isCopy())
+          itsData = itsCopy.data();
+      }
+
+      ArrayView(ArrayView && other) CEREAL_NOEXCEPT
+        : itsData(other.itsData), itsSize(other.itsSize), itsCopy(std::move(other.itsCopy))
+      {
+        // moved vector keeps its buffer
+        other.itsData = nullptr;
+        other.itsSize = 0;
+      }
+
+      ArrayView & operator=(ArrayView other) CEREAL_NOEXCEPT
+      {
+        itsData = other.itsData;
+        itsSize = other.itsSize;
+        itsCopy = std::move(other.itsCopy);
+        return *this;
+      }
+
+      const T * data() const { return itsData; }
+      std::size_t size() const { return itsSize; }
+      bool empty() const { return itsSize == 0; }
+      const T & operator[](std::size_t i) const { return itsData[i]; }
+      const_iterator begin() const { return itsData; }
+      const_iterator end() const { return itsData + itsSize; }
+
+      //! Returns true if view owns copy of data instead of pointing to external memory
+      bool isCopy() const { return itsData != nullptr && itsData == itsCopy.data(); }
+
+      //! Makes view point to external memory, releases owned copy
+      void assign(const T * data, std::size_t size)
+      {
+        itsCopy.clear();
+        itsCopy.shrink_to_fit();
+        itsData = data;
+        itsSize = size;
+      }
+
+      //! Makes view point to owned storage for size elements
+      /*! @return address of storage to be filled */
+      T * allocate(std::size_t size)
+      {
+        itsCopy.resize(size);
+        itsData = itsCopy.data();
+        itsSize = size;
+        return itsCopy.data();
+      }
+
+    private:
+      const T * itsData; //!< first element of view
+      std::size_t itsSize; //!< number of elements
+      std::vector<T> itsCopy; //!< owned data if data couldn't be used in place
+  };
+
+  //! View of a string
+  using StringView = ArrayView<char>;
+
+  //! Equality of viewed elements
+  template <class T> inline
+  bool operator==(ArrayView<T> const & l, ArrayView<T> const & r)
+  {
+    return l.size() == r.size() && std::equal(l.begin(), l.end(), r.begin());
+  }
+
+  template <class T> inline
+  bool operator!=(ArrayView<T> const & l, ArrayView<T> const & r)
+  {
+    return !(l == r);
+  }
+
+  //! Saving for ArrayView, same as for std::vector of arithmetic type
+  template <class Archive, class T> inline
+  typename std::enable_if<traits::is_output_serializable<BinaryData<T>, Archive>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME(Archive & ar, ArrayView<T> const & view)
+  {
+    ar( make_size_tag( static_cast<size_type>(view.size()) ) );
+    ar( binary_data( view.data(), view.size() * sizeof(T) ) );
+  }
+
+  //! Loading for ArrayView, data is copied to storage owned by view
+  /*! Archives which support loading in place provide more specialized overload */
+  template <class Archive, class T> inline
+  typename std::enable_if<traits::is_input_serializable<BinaryData<T>, Archive>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME(Archive & ar, ArrayView<T> & view)
+  {
+    size_type size;
+    ar( make_size_tag( size ) );
+    T * data = view.allocate( static_cast<std::size_t>( size ) );
+    ar( binary_data( data, static_cast<std::size_t>( size ) * sizeof(T) ) );
+  }
+} // namespace cereal
+
+#endif // CEREAL_TYPES_ARRAY_VIEW_HPP_
@@ -31,9 +31,45 @@
 #define CEREAL_TYPES_COMMON_HPP_
 
 #include <cereal/cereal.hpp>
+#include <tuple>
+#include <utility>
 
 namespace cereal
 {
+  namespace memory_detail
+  {
+    //! A struct that acts as a wrapper around calling load_andor_construct
+    /*! The purpose of this is to allow a load_and_construct call to properly enter into the
+        'data' NVP of the ptr_wrapper
+        @internal */
+    template <class Archive, class T>
+    struct LoadAndConstructLoadWrapper
+    {
+      LoadAndConstructLoadWrapper( T * ptr ) :
+        construct( ptr )
+      { }
+
+      //! Constructor for embedding an early call for restoring shared_from_this
+      template <class F>
+      LoadAndConstructLoadWrapper( T * ptr, F && sharedFromThisFunc ) :
+        construct( ptr, sharedFromThisFunc )
+      { }
+
+      inline void CEREAL_SERIALIZE_FUNCTION_NAME( Archive & ar )
+      {
+        ::cereal::detail::Construct<T, Archive>::load_andor_construct( ar, construct );
+      }
+
+      //! Whether load_and_construct has already constructed the object
+      bool constructed() const
+      {
+        return construct.itsValid;
+      }
+
+      ::cereal::construct<T> construct;
+    };
+  } // namespace memory_detail
+
   namespace common_detail
   {
     //! Serialization for arrays if BinaryData is supported and we are arithmetic
@@ -86,6 +122,237 @@ namespace cereal
         using type = StrippedT;
         using base_type = typename enum_underlying_type<StrippedT, value>::type;
     };
+
+    //! Checks if container elements of type T have to be loaded with load_and_construct
+    /*! Types that are default constructible are loaded in place, as they always were.
+        @internal */
+    template <class T, class Archive>
+    struct uses_load_and_construct : std::integral_constant<bool,
+      traits::has_load_and_construct<T, Archive>::value && !std::is_default_constructible<T>::value> {};
+
+    //! Number of elements a container may reserve for a size loaded from an archive
+    /*! The size is limited to CEREAL_RESERVE_LIMIT bytes so that a hostile size can't
+        allocate memory before any element has been loaded.
+        @internal */
+    template <class T> inline
+    std::size_t reserveSize( size_type size )
+    {
+      static const size_type limit = CEREAL_RESERVE_LIMIT / sizeof(T) > 0 ? CEREAL_RESERVE_LIMIT / sizeof(T) : 1;
+      return static_cast<std::size_t>( size < limit ? size : limit );
+    }
+
+    //! Reserves space for a size loaded from an archive, for containers that have reserve()
+    /*! @internal */
+    template <class Container> inline
+    auto reserve( Container & container, size_type size, int ) -> decltype( container.reserve( std::size_t() ) )
+    {
+      container.reserve( reserveSize<typename Container::value_type>( size ) );
+    }
+
+    //! Containers without reserve() grow as they are loaded
+    /*! @internal */
+    template <class Container> inline
+    void reserve( Container &, size_type, long )
+    { }
+
+    //! Reserves space for a size loaded from an archive, if the container supports it
+    /*! @internal */
+    template <class Container> inline
+    void reserve( Container & container, size_type size )
+    {
+      reserve( container, size, 0 );
+    }
+
+    //! Constructs a T that uses the allocator of the container it will be moved into
+    /*! This keeps e.g. std::pmr::string keys in the memory resource of their map,
+        so moving them into the map doesn't copy them.
+        @internal */
+    template <class T, class Alloc> inline
+    typename std::enable_if<std::uses_allocator<T, Alloc>::value && std::is_constructible<T, Alloc const &>::value, T>::type
+    constructWithAllocator( Alloc const & alloc )
+    {
+      return T( alloc );
+    }
+
+    //! Default constructs a T that doesn't use the container's allocator
+    /*! @internal */
+    template <class T, class Alloc> inline
+    typename std::enable_if<!std::uses_allocator<T, Alloc>::value || !std::is_constructible<T, Alloc const &>::value, T>::type
+    constructWithAllocator( Alloc const & )
+    {
+      return T();
+    }
+
+    //! Holds a value loaded from an archive until it is moved into a container
+    /*! Archives load into target(), the loaded value is accessed with get().
+        @internal */
+    template <class Archive, class T, bool Construct = uses_load_and_construct<T, Archive>::value>
+    struct LoadedValue
+    {
+      LoadedValue() : value() { }
+
+      //! Constructs the value with the allocator of the destination container, if it uses one
+      template <class Alloc>
+      explicit LoadedValue( Alloc const & alloc ) : value( constructWithAllocator<T>( alloc ) ) { }
+
+      T & target() { return value; }
+      T & get() { return value; }
+
+      T value;
+    };
+
+    //! Holds a value constructed by load_and_construct
+    /*! @internal */
+    template <class Archive, class T>
+    struct LoadedValue<Archive, T, true>
+    {
+      LoadedValue() : wrapper( reinterpret_cast<T *>( &storage ) ) { }
+
+      template <class Alloc>
+      explicit LoadedValue( Alloc const & ) : LoadedValue() { }
+      LoadedValue( LoadedValue const & ) = delete;
+      LoadedValue & operator=( LoadedValue const & ) = delete;
+
+      ~LoadedValue()
+      {
+        if( wrapper.constructed() )
+          reinterpret_cast<T *>( &storage )->~T();
+      }
+
+      memory_detail::LoadAndConstructLoadWrapper<Archive, T> & target() { return wrapper; }
+
+      //! @throw Exception if load_and_construct didn't construct the value
+      T & get() { return *wrapper.construct.ptr(); }
+
+      typename std::aligned_storage<sizeof(T), CEREAL_ALIGNOF(T)>::type storage;
+      memory_detail::LoadAndConstructLoadWrapper<Archive, T> wrapper;
+    };
+
+    //! Emplaces elements before a position of a sequence container
+    /*! @internal */
+    template <class Container>
+    struct EmplaceBefore
+    {
+      using value_type = typename Container::value_type;
+
+      template <class ... Args>
+      typename Container::iterator operator()( Args && ... args )
+      {
+        return container.emplace( position, std::forward<Args>( args )... );
+      }
+
+      Container & container;
+      typename Container::iterator position;
+    };
+
+    //! Emplaces elements after a position of a std::forward_list
+    /*! @internal */
+    template <class Container>
+    struct EmplaceAfter
+    {
+      using value_type = typename Container::value_type;
+
+      template <class ... Args>
+      typename Container::iterator operator()( Args && ... args )
+      {
+        return container.emplace_after( position, std::forward<Args>( args )... );
+      }
+
+      Container & container;
+      typename Container::iterator position;
+    };
+
+    //! Emplaces a default constructed element and loads it in place
+    /*! @internal */
+    template <class Archive, class Emplace> inline
+    typename std::enable_if<!uses_load_and_construct<typename Emplace::value_type, Archive>::value,
+                            decltype( std::declval<Emplace &>()() )>::type
+    loadElement( Archive & ar, Emplace emplace )
+    {
+      auto it = emplace();
+      ar( *it );
+      return it;
+    }
+
+    //! Loads an element with load_and_construct and moves it into the container
+    /*! @internal */
+    template <class Archive, class Emplace> inline
+    typename std::enable_if<uses_load_and_construct<typename Emplace::value_type, Archive>::value,
+                            decltype( std::declval<Emplace &>()() )>::type
+    loadElement( Archive & ar, Emplace emplace )
+    {
+      LoadedValue<Archive, typename Emplace::value_type> value;
+      ar( value.target() );
+      return emplace( std::move( value.get() ) );
+    }
+
+    //! Emplaces a loaded element at the end of a sequence container
+    /*! @internal */
+    template <class Archive, class Container> inline
+    void loadBack( Archive & ar, Container & container )
+    {
+      loadElement( ar, EmplaceBefore<Container>{ container, container.end() } );
+    }
+
+    //! Emplaces a key with a default constructed value and loads the value in place
+    /*! If the key is already present the value is loaded and discarded, leaving the
+        element loaded first in the map.
+        @internal */
+    template <class Archive, class Map, class Key> inline
+    typename std::enable_if<!uses_load_and_construct<typename Map::mapped_type, Archive>::value, typename Map::iterator>::type
+    loadMapValue( Archive & ar, Map & map, typename Map::iterator hint, Key && key )
+    {
+      auto const size = map.size();
+      #ifdef CEREAL_OLDER_GCC
+      auto it = map.insert( hint, std::make_pair( std::forward<Key>( key ), typename Map::mapped_type() ) );
+      #else // NOT CEREAL_OLDER_GCC
+      auto it = map.emplace_hint( hint, std::piecewise_construct,
+                                  std::forward_as_tuple( std::forward<Key>( key ) ), std::forward_as_tuple() );
+      #endif // NOT CEREAL_OLDER_GCC
+
+      if( map.size() != size )
+        ar( make_nvp<Archive>("value", it->second) );
+      else
+      {
+        LoadedValue<Archive, typename Map::mapped_type> discarded( map.get_allocator() );
+        ar( make_nvp<Archive>("value", discarded.target()) );
+      }
+      return it;
+    }
+
+    //! Loads a value with load_and_construct and moves it into the map together with the key
+    /*! @internal */
+    template <class Archive, class Map, class Key> inline
+    typename std::enable_if<uses_load_and_construct<typename Map::mapped_type, Archive>::value, typename Map::iterator>::type
+    loadMapValue( Archive & ar, Map & map, typename Map::iterator hint, Key && key )
+    {
+      LoadedValue<Archive, typename Map::mapped_type> value( map.get_allocator() );
+      ar( make_nvp<Archive>("value", value.target()) );
+      #ifdef CEREAL_OLDER_GCC
+      return map.insert( hint, std::make_pair( std::forward<Key>( key ), std::move( value.get() ) ) );
+      #else // NOT CEREAL_OLDER_GCC
+      return map.emplace_hint( hint, std::forward<Key>( key ), std::move( value.get() ) );
+      #endif // NOT CEREAL_OLDER_GCC
+    }
+
+    //! Loads a MapItem and emplaces it into a map
+    /*! Reads the same "key" and "value" NVPs as MapItem, but the value is loaded
+        directly into the map element instead of into a temporary.
+        @internal */
+    template <class Map>
+    struct MapItemLoader
+    {
+      template <class Archive> inline
+      void CEREAL_SERIALIZE_FUNCTION_NAME( Archive & ar )
+      {
+        LoadedValue<Archive, typename Map::key_type> key( map.get_allocator() );
+        ar( make_nvp<Archive>("key", key.target()) );
+        hint = loadMapValue( ar, map, hint, std::move( key.get() ) );
+      }
+
+      Map & map;
+      typename Map::iterator hint;
+    };
   }
 
   //! Saving for enum types
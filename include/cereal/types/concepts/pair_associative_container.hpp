@@ -53,20 +53,11 @@ namespace cereal
     ar( make_size_tag( size ) );
 
     map.clear();
+    common_detail::reserve( map, size );
 
-    auto hint = map.begin();
+    common_detail::MapItemLoader<Map<Args...>> item{ map, map.begin() };
     for( size_t i = 0; i < size; ++i )
-    {
-      typename Map<Args...>::key_type key;
-      typename Map<Args...>::mapped_type value;
-
-      ar( make_map_item(key, value) );
-      #ifdef CEREAL_OLDER_GCC
-      hint = map.insert( hint, std::make_pair(std::move(key), std::move(value)) );
-      #else // NOT CEREAL_OLDER_GCC
-      hint = map.emplace_hint( hint, std::move( key ), std::move( value ) );
-      #endif // NOT CEREAL_OLDER_GCC
-    }
+      ar( item );
   }
 } // namespace cereal
 
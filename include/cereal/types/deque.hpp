@@ -52,10 +52,10 @@ namespace cereal
     size_type size;
     ar( make_size_tag( size ) );
 
-    deque.resize( static_cast<size_t>( size ) );
+    deque.clear();
 
-    for( auto & i : deque )
-      ar( i );
+    for( size_type i = 0; i < size; ++i )
+      common_detail::loadBack( ar, deque );
   }
 } // namespace cereal
 
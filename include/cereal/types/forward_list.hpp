@@ -58,10 +58,11 @@ namespace cereal
     size_type size;
     ar( make_size_tag( size ) );
 
-    forward_list.resize( static_cast<size_t>( size ) );
+    forward_list.clear();
 
-    for( auto & i : forward_list )
-      ar( i );
+    auto position = forward_list.before_begin();
+    for( size_type i = 0; i < size; ++i )
+      position = common_detail::loadElement( ar, common_detail::EmplaceAfter<std::forward_list<T, A>>{ forward_list, position } );
   }
 } // namespace cereal
 
@@ -52,10 +52,10 @@ namespace cereal
     size_type size;
     ar( make_size_tag( size ) );
 
-    list.resize( static_cast<size_t>( size ) );
+    list.clear();
 
-    for( auto & i : list )
-      ar( i );
+    for( size_type i = 0; i < size; ++i )
+      common_detail::loadBack( ar, list );
   }
 } // namespace cereal
 
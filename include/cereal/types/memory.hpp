@@ -34,15 +34,40 @@
 #include <memory>
 #include <cstring>
 
-// Work around MSVC not having alignof
-#if defined(_MSC_VER) && _MSC_VER < 1900
-#define CEREAL_ALIGNOF __alignof
-#else // not MSVC 2013 or older
-#define CEREAL_ALIGNOF alignof
-#endif // end MSVC check
+#if CEREAL_HAS_PMR
+#include <memory_resource>
+#endif // CEREAL_HAS_PMR
 
 namespace cereal
 {
+  #if CEREAL_HAS_PMR
+  //! Deleter for objects allocated from a std::pmr::memory_resource
+  /*! A std::unique_ptr with this deleter is loaded into the memory resource of a
+      MemoryResourceAdapter.  Without a resource the object is allocated with new
+      and the deleter uses std::default_delete, same as for std::unique_ptr<T>. */
+  template <class T>
+  struct memory_resource_delete
+  {
+    memory_resource_delete() = default;
+
+    explicit memory_resource_delete( std::pmr::memory_resource * r ) : resource( r ) {}
+
+    void operator()( T * t ) const
+    {
+      if( !resource )
+      {
+        std::default_delete<T>()( t );
+        return;
+      }
+
+      t->~T();
+      resource->deallocate( t, sizeof(T), alignof(T) );
+    }
+
+    std::pmr::memory_resource * resource = nullptr; //!< The resource t was allocated from, or nullptr
+  };
+  #endif // CEREAL_HAS_PMR
+
   namespace memory_detail
   {
     //! A wrapper class to notify cereal that it is ok to serialize the contained pointer
@@ -65,30 +90,179 @@ namespace cereal
       return {std::forward<T>(t)};
     }
 
-    //! A struct that acts as a wrapper around calling load_andor_construct
-    /*! The purpose of this is to allow a load_and_construct call to properly enter into the
-        'data' NVP of the ptr_wrapper
+    #if CEREAL_HAS_PMR
+    //! Uninitialized storage for a T allocated from a memory resource
+    /*! The storage is deallocated unless it is released
         @internal */
-    template <class Archive, class T>
-    struct LoadAndConstructLoadWrapper
+    template <class T>
+    class ResourceStorage
     {
-      LoadAndConstructLoadWrapper( T * ptr ) :
-        construct( ptr )
-      { }
+      public:
+        explicit ResourceStorage( std::pmr::memory_resource & resource ) :
+          itsResource( resource ),
+          itsPtr( resource.allocate( sizeof(T), alignof(T) ) )
+        { }
+
+        ResourceStorage( ResourceStorage const & ) = delete;
+        ResourceStorage & operator=( ResourceStorage const & ) = delete;
 
-      //! Constructor for embedding an early call for restoring shared_from_this
-      template <class F>
-      LoadAndConstructLoadWrapper( T * ptr, F && sharedFromThisFunc ) :
-        construct( ptr, sharedFromThisFunc )
-      { }
+        ~ResourceStorage()
+        {
+          if( itsPtr )
+            itsResource.deallocate( itsPtr, sizeof(T), alignof(T) );
+        }
 
-      inline void CEREAL_SERIALIZE_FUNCTION_NAME( Archive & ar )
+        T * get() const { return static_cast<T *>( itsPtr ); }
+        T * release() { return static_cast<T *>( std::exchange( itsPtr, nullptr ) ); }
+
+      private:
+        std::pmr::memory_resource & itsResource;
+        void * itsPtr;
+    };
+    #endif // CEREAL_HAS_PMR
+
+    //! Default constructs the object behind a std::shared_ptr that is being loaded
+    /*! The object is allocated from the resource of a MemoryResourceAdapter, if the archive has one
+        @internal */
+    template <class Archive, class T> inline
+    void constructShared( Archive & ar, std::shared_ptr<T> & ptr )
+    {
+      #if CEREAL_HAS_PMR
+      if( auto resource = get_memory_resource( ar ) )
       {
-        ::cereal::detail::Construct<T, Archive>::load_andor_construct( ar, construct );
+        ResourceStorage<T> storage( *resource );
+        ::cereal::detail::Construct<T, Archive>::load_andor_construct( storage.get() );
+        ptr.reset( storage.release(), memory_resource_delete<T>( resource ), std::pmr::polymorphic_allocator<T>( resource ) );
+        return;
       }
+      #else // NOT CEREAL_HAS_PMR
+      (void)ar;
+      #endif // NOT CEREAL_HAS_PMR
 
-      ::cereal::construct<T> construct;
-    };
+      ptr.reset( ::cereal::detail::Construct<T, Archive>::load_andor_construct() );
+    }
+
+    //! Allocates uninitialized storage for a std::shared_ptr that is loaded with load_and_construct
+    /*! The storage is allocated from the resource of a MemoryResourceAdapter, if the archive has one.
+        @return A flag that has to be set once the object is constructed, so that the deleter destroys it
+        @internal */
+    template <class Archive, class T> inline
+    std::shared_ptr<bool> allocateShared( Archive & ar, std::shared_ptr<T> & ptr )
+    {
+      #if CEREAL_HAS_PMR
+      if( auto resource = get_memory_resource( ar ) )
+      {
+        auto valid = std::allocate_shared<bool>( std::pmr::polymorphic_allocator<bool>( resource ), false );
+
+        ptr.reset( ResourceStorage<T>( *resource ).release(),
+            [=]( T * t )
+            {
+              if( *valid )
+                t->~T();
+
+              resource->deallocate( t, sizeof(T), alignof(T) );
+            }, std::pmr::polymorphic_allocator<T>( resource ) );
+
+        return valid;
+      }
+      #else // NOT CEREAL_HAS_PMR
+      (void)ar;
+      #endif // NOT CEREAL_HAS_PMR
+
+      // Storage type for the pointer - since we can't default construct this type,
+      // we'll allocate it using std::aligned_storage and use a custom deleter
+      using ST = typename std::aligned_storage<sizeof(T), CEREAL_ALIGNOF(T)>::type;
+
+      // Valid flag - set to true once construction finishes
+      //  This prevents us from calling the destructor on
+      //  uninitialized data.
+      auto valid = std::make_shared<bool>( false );
+
+      // Allocate our storage, which we will treat as
+      //  uninitialized until initialized with placement new
+      ptr.reset( reinterpret_cast<T *>( new ST() ),
+          [=]( T * t )
+          {
+            if( *valid )
+              t->~T();
+
+            delete reinterpret_cast<ST *>( t );
+          } );
+
+      return valid;
+    }
+
+    //! Default constructs the object behind a std::unique_ptr that is being loaded
+    /*! @internal */
+    template <class Archive, class T, class D> inline
+    void constructUnique( Archive &, std::unique_ptr<T, D> & ptr )
+    {
+      ptr.reset( ::cereal::detail::Construct<T, Archive>::load_andor_construct() );
+    }
+
+    //! Loads the object behind a std::unique_ptr with load_and_construct
+    /*! @internal */
+    template <class Archive, class T, class D> inline
+    void loadAndConstructUnique( Archive & ar, std::unique_ptr<T, D> & ptr )
+    {
+      // Storage type for the pointer - since we can't default construct this type,
+      // we'll allocate it using std::aligned_storage
+      using ST = typename std::aligned_storage<sizeof(T), CEREAL_ALIGNOF(T)>::type;
+
+      // Allocate storage - note the ST type so that deleter is correct if
+      //                    an exception is thrown before we are initialized
+      std::unique_ptr<ST> stPtr( new ST() );
+
+      // Use wrapper to enter into "data" nvp of ptr_wrapper
+      memory_detail::LoadAndConstructLoadWrapper<Archive, T> loadWrapper( reinterpret_cast<T *>( stPtr.get() ) );
+
+      // Initialize storage
+      ar( CEREAL_NVP_("data", loadWrapper) );
+
+      // Transfer ownership to correct unique_ptr type
+      ptr.reset( reinterpret_cast<T *>( stPtr.release() ) );
+    }
+
+    #if CEREAL_HAS_PMR
+    //! Default constructs the object behind a std::unique_ptr with memory_resource_delete
+    /*! The object is allocated from the resource of a MemoryResourceAdapter, if the archive has one
+        @internal */
+    template <class Archive, class T> inline
+    void constructUnique( Archive & ar, std::unique_ptr<T, memory_resource_delete<T>> & ptr )
+    {
+      auto resource = get_memory_resource( ar );
+      if( !resource )
+      {
+        ptr = std::unique_ptr<T, memory_resource_delete<T>>( ::cereal::detail::Construct<T, Archive>::load_andor_construct() );
+        return;
+      }
+
+      ResourceStorage<T> storage( *resource );
+      ::cereal::detail::Construct<T, Archive>::load_andor_construct( storage.get() );
+      ptr = std::unique_ptr<T, memory_resource_delete<T>>( storage.release(), memory_resource_delete<T>( resource ) );
+    }
+
+    //! Loads the object behind a std::unique_ptr with memory_resource_delete with load_and_construct
+    /*! The object is allocated from the resource of a MemoryResourceAdapter, if the archive has one
+        @internal */
+    template <class Archive, class T> inline
+    void loadAndConstructUnique( Archive & ar, std::unique_ptr<T, memory_resource_delete<T>> & ptr )
+    {
+      auto resource = get_memory_resource( ar );
+      if( !resource )
+      {
+        std::unique_ptr<T> loaded;
+        loadAndConstructUnique( ar, loaded );
+        ptr = std::unique_ptr<T, memory_resource_delete<T>>( loaded.release() );
+        return;
+      }
+
+      ResourceStorage<T> storage( *resource );
+      memory_detail::LoadAndConstructLoadWrapper<Archive, T> loadWrapper( storage.get() );
+      ar( CEREAL_NVP_("data", loadWrapper) );
+      ptr = std::unique_ptr<T, memory_resource_delete<T>>( storage.release(), memory_resource_delete<T>( resource ) );
+    }
+    #endif // CEREAL_HAS_PMR
 
     //! A helper struct for saving and restoring the state of types that derive from
     //! std::enable_shared_from_this
@@ -286,25 +460,9 @@ namespace cereal
 
     if( id & detail::msb_32bit )
     {
-      // Storage type for the pointer - since we can't default construct this type,
-      // we'll allocate it using std::aligned_storage and use a custom deleter
-      using ST = typename std::aligned_storage<sizeof(T), CEREAL_ALIGNOF(T)>::type;
-
-      // Valid flag - set to true once construction finishes
-      //  This prevents us from calling the destructor on
-      //  uninitialized data.
-      auto valid = std::make_shared<bool>( false );
-
       // Allocate our storage, which we will treat as
       //  uninitialized until initialized with placement new
-      ptr.reset( reinterpret_cast<T *>( new ST() ),
-          [=]( T * t )
-          {
-            if( *valid )
-              t->~T();
-
-            delete reinterpret_cast<ST *>( t );
-          } );
+      auto valid = memory_detail::allocateShared( ar, ptr );
 
       // Register the pointer
       ar.registerSharedPointer( id, ptr );
@@ -333,7 +491,7 @@ namespace cereal
 
     if( id & detail::msb_32bit )
     {
-      ptr.reset( detail::Construct<T, Archive>::load_andor_construct() );
+      memory_detail::constructShared( ar, ptr );
       ar.registerSharedPointer( id, ptr );
       ar( CEREAL_NVP_("data", *ptr) );
     }
@@ -373,24 +531,7 @@ namespace cereal
     auto & ptr = wrapper.ptr;
 
     if( isValid )
-    {
-      // Storage type for the pointer - since we can't default construct this type,
-      // we'll allocate it using std::aligned_storage
-      using ST = typename std::aligned_storage<sizeof(T), CEREAL_ALIGNOF(T)>::type;
-
-      // Allocate storage - note the ST type so that deleter is correct if
-      //                    an exception is thrown before we are initialized
-      std::unique_ptr<ST> stPtr( new ST() );
-
-      // Use wrapper to enter into "data" nvp of ptr_wrapper
-      memory_detail::LoadAndConstructLoadWrapper<Archive, T> loadWrapper( reinterpret_cast<T *>( stPtr.get() ) );
-
-      // Initialize storage
-      ar( CEREAL_NVP_("data", loadWrapper) );
-
-      // Transfer ownership to correct unique_ptr type
-      ptr.reset( reinterpret_cast<T *>( stPtr.release() ) );
-    }
+      memory_detail::loadAndConstructUnique( ar, ptr );
     else
       ptr.reset( nullptr );
   }
@@ -408,7 +549,7 @@ namespace cereal
 
     if( isValid )
     {
-      ptr.reset( detail::Construct<T, Archive>::load_andor_construct() );
+      memory_detail::constructUnique( ar, ptr );
       ar( CEREAL_NVP_( "data", *ptr ) );
     }
     else
@@ -421,5 +562,4 @@ namespace cereal
 // automatically include polymorphic support
 #include <cereal/types/polymorphic.hpp>
 
-#undef CEREAL_ALIGNOF
 #endif // CEREAL_TYPES_SHARED_PTR_HPP_
\ No newline at end of file
@@ -189,42 +189,60 @@ namespace cereal
                               "you are using was included (and registered with CEREAL_REGISTER_ARCHIVE) prior to calling CEREAL_REGISTER_TYPE.\n"   \
                               "If your type is already registered and you still see this error, you may need to use CEREAL_REGISTER_DYNAMIC_INIT.");
 
+    //! Finds input binding for polymorphic type id already registered with the archive
+    /*! Result is cached in the archive, name is compared with registered
+        bindings only once for every id.
+        @return binding or nullptr if type is not registered for loading
+        @internal */
+    template<class Archive> inline
+    typename ::cereal::detail::InputBindingMap<Archive>::Serializers const * findInputBinding(Archive & ar, std::uint32_t const nameid)
+    {
+      using Serializers = typename ::cereal::detail::InputBindingMap<Archive>::Serializers;
+
+      auto & type = ar.getPolymorphicType(nameid);
+      if(false == type.resolved)
+      {
+        type.binding = detail::StaticObject<detail::InputBindingMap<Archive>>::getInstance().find(type.name);
+        type.resolved = true;
+      }
+      return static_cast<Serializers const *>(type.binding);
+    }
+
     //! Get an input binding from the given archive by deserializing the type meta data
     /*! @internal */
     template<class Archive> inline
-    typename ::cereal::detail::InputBindingMap<Archive>::Serializers getInputBinding(Archive & ar, std::uint32_t const nameid)
+    typename ::cereal::detail::InputBindingMap<Archive>::Serializers const & getInputBinding(Archive & ar, std::uint32_t const nameid)
     {
       // If the nameid is zero, we serialized a null pointer
       if(nameid == 0)
       {
-        typename ::cereal::detail::InputBindingMap<Archive>::Serializers emptySerializers;
-        emptySerializers.shared_ptr = [](void*, std::shared_ptr<void> & ptr, std::type_info const &) { ptr.reset(); };
-        emptySerializers.unique_ptr = [](void*, std::unique_ptr<void, ::cereal::detail::EmptyDeleter<void>> & ptr, std::type_info const &) { ptr.reset( nullptr ); };
+        static const auto emptySerializers = []()
+        {
+          typename ::cereal::detail::InputBindingMap<Archive>::Serializers serializers;
+          serializers.shared_ptr = [](void*, std::shared_ptr<void> & ptr, std::type_info const &) { ptr.reset(); };
+          serializers.unique_ptr = [](void*, std::unique_ptr<void, ::cereal::detail::EmptyDeleter<void>> & ptr, std::type_info const &) { ptr.reset( nullptr ); };
+          return serializers;
+        }();
         return emptySerializers;
       }
 
-      std::string name;
       if(nameid & detail::msb_32bit)
       {
+        std::string name;
         ar( CEREAL_NVP_("polymorphic_name", detail::make_polymorphic_key_tag(name)) );
         ar.registerPolymorphicName(nameid, name);
       }
-      else
-        name = ar.getPolymorphicName(nameid);
-
-      auto const & bindingMap = detail::StaticObject<detail::InputBindingMap<Archive>>::getInstance().map;
 
-      auto binding = bindingMap.find(name);
-      if(binding == bindingMap.end())
-        UNREGISTERED_POLYMORPHIC_EXCEPTION(load, name)
-      return binding->second;
+      auto const * binding = findInputBinding(ar, nameid);
+      if(binding == nullptr)
+        UNREGISTERED_POLYMORPHIC_EXCEPTION(load, ar.getPolymorphicName(nameid))
+      return *binding;
     }
 
-    //! Returns if given name was registered for polymorphic loading
+    //! Returns if type with given id was registered for polymorphic loading
     template <class Archive> inline
-    bool hasPolymorphicBinding(const std::string& name) {
-      auto const & bindingMap = detail::StaticObject<detail::InputBindingMap<Archive>>::getInstance().map;
-      return bindingMap.end() != bindingMap.find(name);
+    bool hasPolymorphicBinding(Archive & ar, std::uint32_t const nameid) {
+      return nullptr != findInputBinding(ar, nameid);
     }
 
     //! Serialize a shared_ptr if the 2nd msb in the nameid is set, and if we can actually construct the pointee
@@ -322,13 +340,11 @@ namespace cereal
     // of an abstract object
     //  this implies we need to do the lookup
 
-    auto const & bindingMap = detail::StaticObject<detail::OutputBindingMap<Archive>>::getInstance().map;
-
-    auto binding = bindingMap.find(std::type_index(ptrinfo));
-    if(binding == bindingMap.end())
+    auto const * binding = detail::StaticObject<detail::OutputBindingMap<Archive>>::getInstance().find(std::type_index(ptrinfo));
+    if(binding == nullptr)
       UNREGISTERED_POLYMORPHIC_EXCEPTION(save, cereal::util::demangle(ptrinfo.name()))
 
-    binding->second.shared_ptr(&ar, ptr.get(), tinfo);
+    binding->shared_ptr(&ar, ptr.get(), tinfo);
   }
 
   //! Saving std::shared_ptr for polymorphic types, not abstract
@@ -357,13 +373,11 @@ namespace cereal
       return;
     }
 
-    auto const & bindingMap = detail::StaticObject<detail::OutputBindingMap<Archive>>::getInstance().map;
-
-    auto binding = bindingMap.find(std::type_index(ptrinfo));
-    if(binding == bindingMap.end())
+    auto const * binding = detail::StaticObject<detail::OutputBindingMap<Archive>>::getInstance().find(std::type_index(ptrinfo));
+    if(binding == nullptr)
       UNREGISTERED_POLYMORPHIC_EXCEPTION(save, cereal::util::demangle(ptrinfo.name()))
 
-    binding->second.shared_ptr(&ar, ptr.get(), tinfo);
+    binding->shared_ptr(&ar, ptr.get(), tinfo);
   }
 
   //! Loading std::shared_ptr for polymorphic types
@@ -378,7 +392,7 @@ namespace cereal
     if(polymorphic_detail::serialize_wrapper(ar, ptr, nameid))
       return;
 
-    auto binding = polymorphic_detail::getInputBinding(ar, nameid);
+    auto const & binding = polymorphic_detail::getInputBinding(ar, nameid);
     std::shared_ptr<void> result;
     binding.shared_ptr(&ar, result, typeid(T));
     ptr = std::static_pointer_cast<T>(result);
@@ -421,13 +435,11 @@ namespace cereal
     // of an abstract object
     //  this implies we need to do the lookup
 
-    auto const & bindingMap = detail::StaticObject<detail::OutputBindingMap<Archive>>::getInstance().map;
-
-    auto binding = bindingMap.find(std::type_index(ptrinfo));
-    if(binding == bindingMap.end())
+    auto const * binding = detail::StaticObject<detail::OutputBindingMap<Archive>>::getInstance().find(std::type_index(ptrinfo));
+    if(binding == nullptr)
       UNREGISTERED_POLYMORPHIC_EXCEPTION(save, cereal::util::demangle(ptrinfo.name()))
 
-    binding->second.unique_ptr(&ar, ptr.get(), tinfo);
+    binding->unique_ptr(&ar, ptr.get(), tinfo);
   }
 
   //! Saving std::unique_ptr for polymorphic types, not abstract
@@ -456,13 +468,11 @@ namespace cereal
       return;
     }
 
-    auto const & bindingMap = detail::StaticObject<detail::OutputBindingMap<Archive>>::getInstance().map;
-
-    auto binding = bindingMap.find(std::type_index(ptrinfo));
-    if(binding == bindingMap.end())
+    auto const * binding = detail::StaticObject<detail::OutputBindingMap<Archive>>::getInstance().find(std::type_index(ptrinfo));
+    if(binding == nullptr)
       UNREGISTERED_POLYMORPHIC_EXCEPTION(save, cereal::util::demangle(ptrinfo.name()))
 
-    binding->second.unique_ptr(&ar, ptr.get(), tinfo);
+    binding->unique_ptr(&ar, ptr.get(), tinfo);
   }
 
   //! Loading std::unique_ptr, case when user provides load_and_construct for polymorphic types
@@ -477,7 +487,7 @@ namespace cereal
     if(polymorphic_detail::serialize_wrapper(ar, ptr, nameid))
       return;
 
-    auto binding = polymorphic_detail::getInputBinding(ar, nameid);
+    auto const & binding = polymorphic_detail::getInputBinding(ar, nameid);
     std::unique_ptr<void, ::cereal::detail::EmptyDeleter<void>> result;
     binding.unique_ptr(&ar, result, typeid(T));
     ptr.reset(static_cast<T*>(result.release()));
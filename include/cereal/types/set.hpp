@@ -59,13 +59,13 @@ namespace cereal
       auto hint = set.begin();
       for( size_type i = 0; i < size; ++i )
       {
-        typename SetT::key_type key;
+        common_detail::LoadedValue<Archive, typename SetT::key_type> key( set.get_allocator() );
 
-        ar( key );
+        ar( key.target() );
         #ifdef CEREAL_OLDER_GCC
-        hint = set.insert( hint, std::move( key ) );
+        hint = set.insert( hint, std::move( key.get() ) );
         #else // NOT CEREAL_OLDER_GCC
-        hint = set.emplace_hint( hint, std::move( key ) );
+        hint = set.emplace_hint( hint, std::move( key.get() ) );
         #endif // NOT CEREAL_OLDER_GCC
       }
     }
@@ -55,14 +55,14 @@ namespace cereal
       ar( make_size_tag( size ) );
 
       set.clear();
-      set.reserve( static_cast<std::size_t>( size ) );
+      common_detail::reserve( set, size );
 
       for( size_type i = 0; i < size; ++i )
       {
-        typename SetT::key_type key;
+        common_detail::LoadedValue<Archive, typename SetT::key_type> key( set.get_allocator() );
 
-        ar( key );
-        set.emplace( std::move( key ) );
+        ar( key.target() );
+        set.emplace( std::move( key.get() ) );
       }
     }
   }
@@ -78,9 +78,10 @@ namespace cereal
     size_type size;
     ar( make_size_tag( size ) );
 
-    vector.resize( static_cast<std::size_t>( size ) );
-    for(auto && v : vector)
-      ar( v );
+    vector.clear();
+    common_detail::reserve( vector, size );
+    for( size_type i = 0; i < size; ++i )
+      common_detail::loadBack( ar, vector );
   }
 
   //! Serialization for bool vector types
@@ -99,12 +100,13 @@ namespace cereal
     size_type size;
     ar( make_size_tag( size ) );
 
-    vector.resize( static_cast<std::size_t>( size ) );
-    for(auto && v : vector)
+    vector.clear();
+    common_detail::reserve( vector, size );
+    for( size_type i = 0; i < size; ++i )
     {
       bool b;
       ar( b );
-      v = b;
+      vector.push_back( b );
     }
   }
 } // namespace cereal
@@ -30,6 +30,7 @@
 #include "common.hpp"
 #include <boost/test/unit_test.hpp>
 #include <fstream>
+#include <cereal/types/array_view.hpp>
 
 
 #define CEREAL_TEST_CHECK_EQUAL_INTEGER                  \
@@ -531,3 +532,372 @@ BOOST_AUTO_TEST_CASE(extendable_binary_archive_endian_conversions_lb) {
         cereal::ExtendableBinaryOutputArchive::Options().littleEndian(), false);
   }
 }
+
+template<class IArchive, class OArchive>
+void test_buffered_output(typename IArchive::Options const & iOptions, typename OArchive::Options const & oOptions)
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  // bigger than write buffer, saved in chunks
+  std::vector<std::int32_t> o_vector(3 * cereal::extendable_binary_detail::writeBufferSize + 3);
+  for (auto & elem : o_vector)
+    elem = random_value<std::int32_t>(gen);
+  std::vector<std::uint64_t> o_integers(2 * cereal::extendable_binary_detail::writeBufferSize);
+  for (auto & elem : o_integers)
+    elem = random_value<std::uint64_t>(gen);
+
+  std::ostringstream os;
+  {
+    OArchive oar(os, oOptions);
+    oar(o_vector);
+    for (auto const & elem : o_integers)
+      oar(elem);
+    // data is written only after flush
+    oar.flush();
+    BOOST_CHECK_GT(os.str().size(), o_vector.size() * sizeof(std::int32_t));
+  }
+
+  std::vector<std::int32_t> i_vector;
+  std::vector<std::uint64_t> i_integers(o_integers.size());
+
+  std::istringstream is(os.str());
+  {
+    IArchive iar(is, iOptions);
+    iar(i_vector);
+    for (auto & elem : i_integers)
+      iar(elem);
+  }
+
+  BOOST_CHECK_EQUAL_COLLECTIONS(i_vector.begin(), i_vector.end(), o_vector.begin(), o_vector.end());
+  BOOST_CHECK_EQUAL_COLLECTIONS(i_integers.begin(), i_integers.end(), o_integers.begin(), o_integers.end());
+}
+
+BOOST_AUTO_TEST_CASE(extendable_binary_buffered_output)
+{
+  test_buffered_output<cereal::ExtendableBinaryInputArchive, cereal::ExtendableBinaryOutputArchive>(
+      cereal::ExtendableBinaryInputArchive::Options(),
+      cereal::ExtendableBinaryOutputArchive::Options().littleEndian());
+  test_buffered_output<cereal::ExtendableBinaryInputArchive, cereal::ExtendableBinaryOutputArchive>(
+      cereal::ExtendableBinaryInputArchive::Options(),
+      cereal::ExtendableBinaryOutputArchive::Options().bigEndian());
+}
+
+template<class IArchive, class OArchive>
+void test_memory_input(typename IArchive::Options const & iOptions, typename OArchive::Options const & oOptions)
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  std::vector<std::string> o_strings(10);
+  for (auto & elem : o_strings)
+    elem = random_basic_string<char>(gen);
+  std::map<std::uint32_t, std::int64_t> o_map;
+  for (std::size_t i = 0; i < 100; ++i)
+    o_map.emplace(random_value<std::uint32_t>(gen), random_value<std::int64_t>(gen));
+  std::vector<double> o_doubles(100);
+  for (auto & elem : o_doubles)
+    elem = random_value<double>(gen);
+  const auto o_shared = std::make_shared<std::uint64_t>(random_value<std::uint64_t>(gen));
+
+  std::ostringstream os;
+  {
+    OArchive oar(os, oOptions);
+    oar(o_strings, o_map, o_doubles, o_shared, o_shared);
+  }
+  const std::string saved = os.str();
+
+  std::vector<std::string> i_strings;
+  std::map<std::uint32_t, std::int64_t> i_map;
+  std::vector<double> i_doubles;
+  std::shared_ptr<std::uint64_t> i_shared1, i_shared2;
+  {
+    IArchive iar(saved.data(), saved.size(), iOptions);
+    iar(i_strings, i_map, i_doubles, i_shared1, i_shared2);
+  }
+
+  BOOST_CHECK_EQUAL_COLLECTIONS(i_strings.begin(), i_strings.end(), o_strings.begin(), o_strings.end());
+  BOOST_CHECK(i_map == o_map);
+  BOOST_CHECK_EQUAL_COLLECTIONS(i_doubles.begin(), i_doubles.end(), o_doubles.begin(), o_doubles.end());
+  BOOST_REQUIRE(i_shared1);
+  BOOST_CHECK_EQUAL(*i_shared1, *o_shared);
+  BOOST_CHECK_EQUAL(i_shared1, i_shared2);
+
+  // truncated buffer has to result in exception
+  for (std::size_t size = 0; size < saved.size(); ++size) {
+    BOOST_CHECK_THROW(
+      {
+        IArchive iar(saved.data(), size, iOptions);
+        iar(i_strings, i_map, i_doubles, i_shared1, i_shared2);
+      }, cereal::Exception);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(extendable_binary_memory_input)
+{
+  test_memory_input<cereal::ExtendableBinaryInputArchive, cereal::ExtendableBinaryOutputArchive>(
+      cereal::ExtendableBinaryInputArchive::Options(),
+      cereal::ExtendableBinaryOutputArchive::Options().littleEndian());
+  test_memory_input<cereal::ExtendableBinaryInputArchive, cereal::ExtendableBinaryOutputArchive>(
+      cereal::ExtendableBinaryInputArchive::Options(),
+      cereal::ExtendableBinaryOutputArchive::Options().bigEndian());
+}
+
+BOOST_AUTO_TEST_CASE(extendable_binary_varint_memory)
+{
+  // all varint sizes, both in the middle and at the end of buffer
+  std::vector<std::uint64_t> o_values;
+  for (std::size_t bits = 0; bits <= 64; bits += 7) {
+    o_values.push_back(bits == 0 ? 0 : (std::uint64_t(1) << (bits - 1)));
+    o_values.push_back(bits == 0 ? 0 : (std::uint64_t(1) << bits) - 1);
+  }
+  o_values.push_back(std::numeric_limits<std::uint64_t>::max());
+
+  for (std::size_t last = 0; last < o_values.size(); ++last) {
+    std::ostringstream os;
+    {
+      cereal::ExtendableBinaryOutputArchive oar(os);
+      for (auto const & elem : o_values)
+        oar.saveVarint(elem);
+      oar.saveVarint(o_values[last]);
+    }
+    const std::string saved = os.str();
+
+    std::vector<std::uint64_t> i_values(o_values.size());
+    std::uint64_t i_last;
+    {
+      cereal::ExtendableBinaryInputArchive iar(saved.data(), saved.size());
+      for (auto & elem : i_values)
+        iar.loadVarint(elem);
+      iar.loadVarint(i_last);
+    }
+    BOOST_CHECK_EQUAL_COLLECTIONS(i_values.begin(), i_values.end(), o_values.begin(), o_values.end());
+    BOOST_CHECK_EQUAL(i_last, o_values[last]);
+
+    {
+      cereal::ExtendableBinaryInputArchive iar(saved.data(), saved.size());
+      for (std::size_t i = 0; i < o_values.size(); ++i)
+        iar.skipVarint();
+      iar.loadVarint(i_last);
+      BOOST_CHECK_EQUAL(i_last, o_values[last]);
+      BOOST_CHECK_THROW(iar.skipVarint(), cereal::Exception);
+    }
+  }
+
+  // more than maxVarintSize bytes
+  std::string tooBig(1 + 2 * cereal::extendable_binary_detail::maxVarintSize, static_cast<char>(0x80));
+  tooBig[0] = 1;
+  for (std::size_t size : {tooBig.size(), std::size_t(2 + cereal::extendable_binary_detail::maxVarintSize)}) {
+    std::uint64_t value;
+    cereal::ExtendableBinaryInputArchive iar(tooBig.data(), size);
+    BOOST_CHECK_THROW(iar.loadVarint(value), cereal::Exception);
+    cereal::ExtendableBinaryInputArchive iar2(tooBig.data(), size);
+    BOOST_CHECK_THROW(iar2.skipVarint(), cereal::Exception);
+    std::istringstream is(tooBig.substr(0, size));
+    cereal::ExtendableBinaryInputArchive iar3(is);
+    BOOST_CHECK_THROW(iar3.loadVarint(value), cereal::Exception);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(extendable_binary_array_view)
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  std::vector<std::string> o_strings(20);
+  for (auto & elem : o_strings)
+    elem = random_basic_string<char>(gen);
+  std::vector<double> o_doubles(100);
+  for (auto & elem : o_doubles)
+    elem = random_value<double>(gen);
+
+  for (auto littleEndian : {true, false}) {
+    std::ostringstream os;
+    {
+      auto options = littleEndian ? cereal::ExtendableBinaryOutputArchive::Options().littleEndian()
+                                  : cereal::ExtendableBinaryOutputArchive::Options().bigEndian();
+      cereal::ExtendableBinaryOutputArchive oar(os, options);
+      oar(o_strings, o_doubles);
+    }
+    const bool sameEndian = littleEndian == (cereal::extendable_binary_detail::is_little_endian() != 0);
+
+    // copy to buffer aligned for double, then load with one byte offset to test misaligned data
+    for (std::size_t offset : {0, 1}) {
+      const std::string saved = os.str();
+      std::vector<double> buffer(saved.size() / sizeof(double) + 2);
+      char * begin = reinterpret_cast<char *>(buffer.data()) + offset;
+      std::memcpy(begin, saved.data(), saved.size());
+
+      std::vector<cereal::StringView> i_strings;
+      cereal::ArrayView<double> i_doubles;
+      {
+        cereal::ExtendableBinaryInputArchive iar(begin, saved.size());
+        iar(i_strings, i_doubles);
+      }
+
+      BOOST_REQUIRE_EQUAL(i_strings.size(), o_strings.size());
+      for (std::size_t i = 0; i < o_strings.size(); ++i) {
+        BOOST_CHECK_EQUAL(std::string(i_strings[i].begin(), i_strings[i].end()), o_strings[i]);
+        // chars never need swapping or alignment
+        BOOST_CHECK(!i_strings[i].isCopy());
+        BOOST_CHECK(i_strings[i].data() >= begin && i_strings[i].data() < begin + saved.size());
+      }
+      BOOST_CHECK_EQUAL_COLLECTIONS(i_doubles.begin(), i_doubles.end(), o_doubles.begin(), o_doubles.end());
+      // misaligned or swapped data is copied
+      if (!sameEndian)
+        BOOST_CHECK(i_doubles.isCopy());
+      if (!i_doubles.isCopy()) {
+        BOOST_CHECK(reinterpret_cast<const char *>(i_doubles.data()) >= begin);
+        BOOST_CHECK_EQUAL(reinterpret_cast<std::uintptr_t>(i_doubles.data()) % alignof(double), 0u);
+      }
+
+      // views are loaded as copies from stream, and can be saved back as original types
+      std::istringstream is(saved);
+      {
+        cereal::ExtendableBinaryInputArchive iar(is);
+        iar(i_strings, i_doubles);
+      }
+      BOOST_CHECK(i_doubles.isCopy());
+      std::ostringstream os2;
+      {
+        auto options = littleEndian ? cereal::ExtendableBinaryOutputArchive::Options().littleEndian()
+                                    : cereal::ExtendableBinaryOutputArchive::Options().bigEndian();
+        cereal::ExtendableBinaryOutputArchive oar(os2, options);
+        oar(i_strings, i_doubles);
+      }
+      BOOST_CHECK(os2.str() == saved);
+    }
+  }
+}
+
+namespace
+{
+  template <std::size_t N>
+  void check_packed_bits(std::mt19937 & gen, std::vector<bool> const & o_vector)
+  {
+    std::bitset<N> o_bitset;
+    for (std::size_t i = 0; i < N; ++i)
+      o_bitset[i] = random_value<int>(gen) % 3 == 0;
+
+    for (auto littleEndian : {true, false}) {
+      std::ostringstream os;
+      {
+        auto options = littleEndian ? cereal::ExtendableBinaryOutputArchive::Options().littleEndian()
+                                    : cereal::ExtendableBinaryOutputArchive::Options().bigEndian();
+        cereal::ExtendableBinaryOutputArchive oar(os, options.packedBits(true));
+        oar(o_bitset, o_vector);
+      }
+      const std::string saved = os.str();
+      // header, bitset object and vector object with bit array and end marker
+      const std::size_t bitArrays = 2 + 2 * cereal::extendable_binary_detail::maxVarintSize
+                                    + (N + 7) / 8 + (o_vector.size() + 7) / 8;
+      BOOST_CHECK_LE(saved.size(), 1 + 2 * 2 + bitArrays);
+
+      std::bitset<N> i_bitset;
+      std::vector<bool> i_vector = {true};
+      {
+        cereal::ExtendableBinaryInputArchive iar(saved.data(), saved.size());
+        iar(i_bitset, i_vector);
+      }
+      BOOST_CHECK(i_bitset == o_bitset);
+      BOOST_CHECK(i_vector == o_vector);
+
+      std::istringstream is(saved);
+      {
+        cereal::ExtendableBinaryInputArchive iar(is);
+        iar(i_bitset, i_vector);
+      }
+      BOOST_CHECK(i_bitset == o_bitset);
+      BOOST_CHECK(i_vector == o_vector);
+
+      // bitset of different size
+      std::bitset<N + 1> i_bigger;
+      cereal::ExtendableBinaryInputArchive iar(saved.data(), saved.size());
+      BOOST_CHECK_THROW(iar(i_bigger), cereal::Exception);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(extendable_binary_packed_bits)
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  for (std::size_t size : {0, 1, 8, 63, 64, 65, 1000, 100000}) {
+    std::vector<bool> o_vector(size);
+    for (std::size_t i = 0; i < size; ++i)
+      o_vector[i] = random_value<int>(gen) % 2 == 0;
+    check_packed_bits<1>(gen, o_vector);
+    check_packed_bits<64>(gen, o_vector);
+    check_packed_bits<100>(gen, o_vector);
+    check_packed_bits<40000>(gen, o_vector);
+  }
+
+  // truncated data
+  std::vector<bool> o_vector(1000, true);
+  std::ostringstream os;
+  {
+    cereal::ExtendableBinaryOutputArchive oar(os, cereal::ExtendableBinaryOutputArchive::Options().packedBits(true));
+    oar(o_vector);
+  }
+  const std::string saved = os.str();
+  std::vector<bool> i_vector;
+  cereal::ExtendableBinaryInputArchive iar(saved.data(), saved.size() - 10);
+  BOOST_CHECK_THROW(iar(i_vector), cereal::Exception);
+}
+
+struct FlagsNew
+{
+  std::uint32_t id;
+  std::vector<bool> flags;
+  std::bitset<200> mask;
+
+  template <class Archive>
+  void serialize(Archive & ar)
+  {
+    ar(id, flags, mask, id);
+  }
+};
+
+struct FlagsOld
+{
+  std::uint32_t id;
+  std::uint32_t id2;
+
+  template <class Archive>
+  void serialize(Archive & ar)
+  {
+    ar(id, cereal::OmittedFieldTag(), cereal::OmittedFieldTag(), id2);
+  }
+};
+
+BOOST_AUTO_TEST_CASE(extendable_binary_packed_bits_skip)
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  std::vector<FlagsNew> o_objects(10);
+  for (auto & object : o_objects) {
+    object.id = random_value<std::uint32_t>(gen);
+    object.flags.resize(random_value<std::uint16_t>(gen) % 3000, true);
+    object.mask.set(object.id % 200);
+  }
+  for (bool packedBits : {false, true}) {
+    std::ostringstream os;
+    {
+      cereal::ExtendableBinaryOutputArchive oar(os, cereal::ExtendableBinaryOutputArchive::Options().packedBits(packedBits));
+      oar(o_objects);
+    }
+    std::vector<FlagsOld> i_objects;
+    std::istringstream is(os.str());
+    {
+      cereal::ExtendableBinaryInputArchive iar(is);
+      iar(i_objects);
+    }
+    BOOST_REQUIRE_EQUAL(i_objects.size(), o_objects.size());
+    for (std::size_t i = 0; i < i_objects.size(); ++i) {
+      BOOST_CHECK_EQUAL(i_objects[i].id, o_objects[i].id);
+      BOOST_CHECK_EQUAL(i_objects[i].id2, o_objects[i].id);
+    }
+  }
+}
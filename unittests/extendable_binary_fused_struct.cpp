@@ -0,0 +1,336 @@
+/*! \file extendable_binary_fused_struct.cpp
+    \brief Tests for fused structs in extendable binary archive
+    \ingroup tests */
+/*
+  Copyright (c) 2016, Michal Breiter
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT OR MICHAL BREITER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <boost/test/unit_test.hpp>
+
+/** all supported field types, serialized with every supported syntax */
+struct Record
+{
+  bool b;
+  char c;
+  std::int8_t i8;
+  std::uint8_t u8;
+  std::int16_t i16;
+  std::uint16_t u16;
+  std::int32_t i32;
+  std::uint32_t u32;
+  std::int64_t i64;
+  std::uint64_t u64;
+  float f;
+  double d;
+
+  template <class Archive>
+  void serialize(Archive & ar)
+  {
+    ar(b, c, CEREAL_NVP(i8), u8);
+    ar & i16 & u16;
+    ar(cereal::make_nvp("i32", i32), u32, i64, u64);
+    ar(f, d);
+  }
+
+  bool operator==(Record const & o) const
+  {
+    return b == o.b && c == o.c && i8 == o.i8 && u8 == o.u8 && i16 == o.i16 && u16 == o.u16 &&
+           i32 == o.i32 && u32 == o.u32 && i64 == o.i64 && u64 == o.u64 &&
+           (f == o.f || (f != f && o.f != o.f)) && (d == o.d || (d != d && o.d != o.d));
+  }
+
+  bool operator!=(Record const & o) const
+  { return !(*this == o); }
+
+  friend std::ostream & operator<<(std::ostream & os, Record const & r)
+  { return os << r.i8 + 0 << " " << r.i16 << " " << r.i32 << " " << r.i64 << " " << r.u64 << " " << r.f << " " << r.d; }
+};
+
+struct FusedRecord : Record {};
+CEREAL_EXTENDABLE_BINARY_FUSED_STRUCT(FusedRecord)
+
+/** non member versioned serialize, like in benchmarks */
+struct Counters
+{
+  int f1;
+  int f2;
+  int f3;
+};
+
+template <class Archive>
+void serialize(Archive & ar, Counters & c, unsigned int version)
+{
+  ar & c.f1;
+  ar & c.f2;
+  if(version > 1)
+    ar & c.f3;
+}
+
+struct PlainCounters : Counters {};
+CEREAL_CLASS_VERSION(PlainCounters, 2)
+struct FusedCounters : Counters {};
+CEREAL_EXTENDABLE_BINARY_FUSED_STRUCT(FusedCounters)
+CEREAL_CLASS_VERSION(FusedCounters, 2)
+
+/** narrow fields, loaded from wider ones */
+struct Narrow
+{
+  std::int8_t value;
+  float ratio;
+
+  template <class Archive>
+  void serialize(Archive & ar)
+  {
+    ar(value, ratio);
+  }
+};
+CEREAL_EXTENDABLE_BINARY_FUSED_STRUCT(Narrow)
+
+/** newer version of Narrow, wider fields and one more field */
+struct Wide
+{
+  std::int64_t value;
+  double ratio;
+  std::uint32_t extra;
+
+  template <class Archive>
+  void serialize(Archive & ar)
+  {
+    ar(value, ratio, extra);
+  }
+};
+
+/** struct serializing the same member twice */
+struct Twice
+{
+  std::uint64_t value;
+
+  template <class Archive>
+  void serialize(Archive & ar)
+  {
+    ar(value, value);
+  }
+};
+CEREAL_EXTENDABLE_BINARY_FUSED_STRUCT(Twice)
+
+template <class T>
+T random_record(std::mt19937 & gen)
+{
+  T r;
+  r.b = random_value<std::uint8_t>(gen) % 2 == 1;
+  r.c = random_value<char>(gen);
+  r.i8 = random_value<std::int8_t>(gen);
+  r.u8 = random_value<std::uint8_t>(gen);
+  r.i16 = random_value<std::int16_t>(gen);
+  r.u16 = random_value<std::uint16_t>(gen);
+  r.i32 = random_value<std::int32_t>(gen);
+  r.u32 = random_value<std::uint32_t>(gen);
+  r.i64 = random_value<std::int64_t>(gen) >> (random_value<std::uint8_t>(gen) % 64);
+  r.u64 = random_value<std::uint64_t>(gen) >> (random_value<std::uint8_t>(gen) % 64);
+  r.f = random_value<float>(gen);
+  r.d = random_value<double>(gen);
+  return r;
+}
+
+template <class T>
+std::vector<T> test_records(std::mt19937 & gen)
+{
+  std::vector<T> records(100);
+  for (auto & r : records)
+    r = random_record<T>(gen);
+  // values saved in type tag, limits and NaN
+  for (int i = 0; i < 16; ++i) {
+    records[i].i8 = records[i].u8 = static_cast<std::uint8_t>(i);
+    records[i].i32 = records[i].i64 = -i;
+  }
+  records[16].i8 = std::numeric_limits<std::int8_t>::min();
+  records[16].i16 = std::numeric_limits<std::int16_t>::min();
+  records[16].i32 = std::numeric_limits<std::int32_t>::min();
+  records[16].i64 = std::numeric_limits<std::int64_t>::min();
+  records[16].u64 = std::numeric_limits<std::uint64_t>::max();
+  records[17].f = std::numeric_limits<float>::quiet_NaN();
+  records[17].d = -std::numeric_limits<double>::quiet_NaN();
+  return records;
+}
+
+template <class T>
+std::string save_records(std::vector<T> const & records, cereal::ExtendableBinaryOutputArchive::Options const & options)
+{
+  std::ostringstream os;
+  {
+    cereal::ExtendableBinaryOutputArchive oar(os, options);
+    auto shared = std::make_shared<T>(records.back());
+    oar(records, records.front(), shared, shared);
+  }
+  return os.str();
+}
+
+template <class T>
+std::vector<T> convert_records(std::vector<FusedRecord> const & records)
+{
+  std::vector<T> result;
+  for (auto const & r : records) {
+    T t;
+    static_cast<Record &>(t) = r;
+    result.push_back(t);
+  }
+  return result;
+}
+
+std::vector<cereal::ExtendableBinaryOutputArchive::Options> fused_options()
+{
+  using Options = cereal::ExtendableBinaryOutputArchive::Options;
+  return {Options().littleEndian(), Options().bigEndian(),
+          Options().littleEndian().lengthPrefixedObjects(true), Options().bigEndian().lengthPrefixedObjects(true)};
+}
+
+BOOST_AUTO_TEST_CASE( extendable_binary_fused_struct_bytes )
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  const auto fused = test_records<FusedRecord>(gen);
+  const auto plain = convert_records<Record>(fused);
+
+  for (auto const & options : fused_options()) {
+    const std::string savedFused = save_records(fused, options);
+    const std::string savedPlain = save_records(plain, options);
+    BOOST_CHECK(savedFused == savedPlain);
+
+    std::ostringstream osFused;
+    std::ostringstream osPlain;
+    {
+      cereal::ExtendableBinaryOutputArchive oarFused(osFused, options);
+      cereal::ExtendableBinaryOutputArchive oarPlain(osPlain, options);
+      for (int i = 0; i < 3; ++i) {
+        FusedCounters f;
+        PlainCounters p;
+        f.f1 = p.f1 = i;
+        f.f2 = p.f2 = -1000 * i;
+        f.f3 = p.f3 = std::numeric_limits<int>::max() - i;
+        oarFused(f);
+        oarPlain(p);
+      }
+    }
+    BOOST_CHECK(osFused.str() == osPlain.str());
+  }
+}
+
+BOOST_AUTO_TEST_CASE( extendable_binary_fused_struct )
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  const auto o_records = test_records<FusedRecord>(gen);
+
+  for (auto const & options : fused_options()) {
+    const std::string saved = save_records(o_records, options);
+    for (bool memoryInput : {false, true}) {
+      std::vector<FusedRecord> i_records;
+      FusedRecord i_front;
+      std::shared_ptr<FusedRecord> i_shared1;
+      std::shared_ptr<FusedRecord> i_shared2;
+      std::vector<Record> i_plain;
+      if (memoryInput) {
+        cereal::ExtendableBinaryInputArchive iar(saved.data(), saved.size());
+        iar(i_records, i_front, i_shared1, i_shared2);
+        cereal::ExtendableBinaryInputArchive iarPlain(saved.data(), saved.size());
+        iarPlain(i_plain);
+      } else {
+        std::istringstream is(saved);
+        cereal::ExtendableBinaryInputArchive iar(is);
+        iar(i_records, i_front, i_shared1, i_shared2);
+      }
+
+      BOOST_CHECK_EQUAL_COLLECTIONS(i_records.begin(), i_records.end(), o_records.begin(), o_records.end());
+      BOOST_CHECK_EQUAL(i_front, o_records.front());
+      BOOST_REQUIRE(i_shared1);
+      BOOST_CHECK_EQUAL(*i_shared1, o_records.back());
+      BOOST_CHECK_EQUAL(i_shared1, i_shared2);
+      if (memoryInput)
+        BOOST_CHECK_EQUAL_COLLECTIONS(i_plain.begin(), i_plain.end(), o_records.begin(), o_records.end());
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( extendable_binary_fused_struct_versioned )
+{
+  std::ostringstream os;
+  {
+    cereal::ExtendableBinaryOutputArchive oar(os);
+    PlainCounters p;
+    p.f1 = 1;
+    p.f2 = -2;
+    p.f3 = 300;
+    oar(p);
+  }
+  const std::string saved = os.str();
+  FusedCounters f{};
+  cereal::ExtendableBinaryInputArchive iar(saved.data(), saved.size());
+  iar(f);
+  BOOST_CHECK_EQUAL(f.f1, 1);
+  BOOST_CHECK_EQUAL(f.f2, -2);
+  BOOST_CHECK_EQUAL(f.f3, 300);
+}
+
+BOOST_AUTO_TEST_CASE( extendable_binary_fused_struct_compatibility )
+{
+  for (bool lengthPrefixed : {false, true}) {
+    const auto options = cereal::ExtendableBinaryOutputArchive::Options().lengthPrefixedObjects(lengthPrefixed);
+    std::ostringstream os;
+    {
+      cereal::ExtendableBinaryOutputArchive oar(os, options);
+      oar(Wide{-100, 0.5, 7}, Wide{100, 1.5, 8}, Wide{1000, 2.5, 9});
+    }
+    const std::string saved = os.str();
+
+    // wider fields are converted, unknown field is skipped
+    Narrow i_first{};
+    Narrow i_second{};
+    Narrow i_third{};
+    {
+      cereal::ExtendableBinaryInputArchive iar(saved.data(), saved.size());
+      iar(i_first, i_second);
+      BOOST_CHECK_THROW(iar(i_third), cereal::Exception); // value doesn't fit
+    }
+    BOOST_CHECK_EQUAL(i_first.value, -100);
+    BOOST_CHECK_EQUAL(i_first.ratio, 0.5f);
+    BOOST_CHECK_EQUAL(i_second.value, 100);
+    BOOST_CHECK_EQUAL(i_second.ratio, 1.5f);
+
+    // data truncated in the last object
+    for (std::size_t cut : {4, 8, 12}) {
+      cereal::ExtendableBinaryInputArchive iar(saved.data(), saved.size() - cut);
+      iar(i_first, i_second);
+      BOOST_CHECK_THROW(iar(i_third), cereal::Exception);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( extendable_binary_fused_struct_twice )
+{
+  std::ostringstream os;
+  cereal::ExtendableBinaryOutputArchive oar(os);
+  BOOST_CHECK_THROW(oar(Twice{1ull << 60}), cereal::Exception);
+}
@@ -0,0 +1,442 @@
+/*! \file extendable_binary_integer_array.cpp
+    \brief Tests for compressed integer arrays and delta encoded keys in extendable binary archive
+    \ingroup tests */
+/*
+  Copyright (c) 2016, Michal Breiter
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT OR MICHAL BREITER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <boost/test/unit_test.hpp>
+#include <cereal/types/array_view.hpp>
+
+namespace
+{
+  cereal::ExtendableBinaryOutputArchive::Options compressed(bool littleEndian = true)
+  {
+    auto options = littleEndian ? cereal::ExtendableBinaryOutputArchive::Options().littleEndian()
+                                : cereal::ExtendableBinaryOutputArchive::Options().bigEndian();
+    return options.compressIntegerArrays(true);
+  }
+
+  template <class T>
+  std::vector<T> random_integers(std::mt19937 & gen, std::size_t size, T min, T max)
+  {
+    std::uniform_int_distribution<T> dist(min, max);
+    std::vector<T> result(size);
+    for (auto & elem : result)
+      elem = dist(gen);
+    return result;
+  }
+
+  template <class T>
+  std::string save_compressed(T const & t, bool compress = true, bool littleEndian = true)
+  {
+    std::ostringstream os;
+    {
+      cereal::ExtendableBinaryOutputArchive oar(os, compressed(littleEndian).compressIntegerArrays(compress));
+      oar(t);
+    }
+    return os.str();
+  }
+
+  template <class T>
+  void check_round_trip(std::vector<T> const & o_vector)
+  {
+    for (bool littleEndian : {true, false}) {
+      const std::string saved = save_compressed(o_vector, true, littleEndian);
+      std::vector<T> i_vector;
+      {
+        cereal::ExtendableBinaryInputArchive iar(saved.data(), saved.size());
+        iar(i_vector);
+      }
+      BOOST_CHECK_EQUAL_COLLECTIONS(i_vector.begin(), i_vector.end(), o_vector.begin(), o_vector.end());
+      std::istringstream is(saved);
+      {
+        cereal::ExtendableBinaryInputArchive iar(is);
+        iar(i_vector);
+      }
+      BOOST_CHECK_EQUAL_COLLECTIONS(i_vector.begin(), i_vector.end(), o_vector.begin(), o_vector.end());
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( extendable_binary_integer_array )
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  for (std::size_t size : {0, 1, 63, 64, 65, 1000}) {
+    // small ids in wide type
+    check_round_trip(random_integers<std::uint64_t>(gen, size, 0, 1000));
+    // values close to each other, far from zero
+    check_round_trip(random_integers<std::uint64_t>(gen, size, 1ull << 62, (1ull << 62) + 100));
+    check_round_trip(random_integers<std::int64_t>(gen, size, -100, 100));
+    check_round_trip(random_integers<std::int32_t>(gen, size, std::numeric_limits<std::int32_t>::min(), -1000000));
+    check_round_trip(random_integers<std::int16_t>(gen, size, -3, 3));
+    check_round_trip(random_integers<std::uint32_t>(gen, size, 0, std::numeric_limits<std::uint32_t>::max()));
+    check_round_trip(random_integers<std::int64_t>(gen, size, std::numeric_limits<std::int64_t>::min(), std::numeric_limits<std::int64_t>::max()));
+    check_round_trip(std::vector<std::uint64_t>(size, 42));
+  }
+
+  // few big values, rest small
+  auto skewed = random_integers<std::uint64_t>(gen, 500, 0, 10);
+  skewed[100] = std::numeric_limits<std::uint64_t>::max();
+  check_round_trip(skewed);
+
+  // all bit widths
+  for (unsigned width = 1; width <= 64; ++width) {
+    const std::uint64_t max = width == 64 ? std::numeric_limits<std::uint64_t>::max() : (std::uint64_t(1) << width) - 1;
+    auto values = random_integers<std::uint64_t>(gen, 130, 0, max);
+    values[0] = max;
+    check_round_trip(values);
+  }
+
+  // std::array and other types are not affected
+  std::array<std::uint64_t, 100> o_array;
+  for (auto & elem : o_array)
+    elem = random_value<std::uint8_t>(gen);
+  const std::vector<double> o_doubles = {1.5, -2, 1e100};
+  const std::string o_string = random_basic_string<char>(gen);
+  std::ostringstream os;
+  {
+    cereal::ExtendableBinaryOutputArchive oar(os, compressed());
+    oar(o_array, o_doubles, o_string);
+  }
+  std::array<std::uint64_t, 100> i_array;
+  std::vector<double> i_doubles;
+  std::string i_string;
+  std::istringstream is(os.str());
+  {
+    cereal::ExtendableBinaryInputArchive iar(is);
+    iar(i_array, i_doubles, i_string);
+  }
+  BOOST_CHECK_EQUAL_COLLECTIONS(i_array.begin(), i_array.end(), o_array.begin(), o_array.end());
+  BOOST_CHECK_EQUAL_COLLECTIONS(i_doubles.begin(), i_doubles.end(), o_doubles.begin(), o_doubles.end());
+  BOOST_CHECK_EQUAL(i_string, o_string);
+}
+
+BOOST_AUTO_TEST_CASE( extendable_binary_integer_array_size )
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  const auto ids = random_integers<std::uint64_t>(gen, 1000, 0, 1000);
+  const std::size_t raw = save_compressed(ids, false).size();
+  // ten bits per id
+  BOOST_CHECK_LE(save_compressed(ids).size(), raw - ids.size() * sizeof(std::uint64_t) + 1250 + 4);
+
+  // random data is saved as raw memory
+  const auto noise = random_integers<std::uint64_t>(gen, 1000, 0, std::numeric_limits<std::uint64_t>::max());
+  BOOST_CHECK(save_compressed(noise) == save_compressed(noise, false));
+
+  // varints are used if some values are much bigger than others
+  auto skewed = random_integers<std::uint32_t>(gen, 1000, 0, 100);
+  skewed[0] = std::numeric_limits<std::uint32_t>::max();
+  BOOST_CHECK_LE(save_compressed(skewed).size(), raw - ids.size() * sizeof(std::uint64_t) + 1000 + 5 + 4);
+}
+
+BOOST_AUTO_TEST_CASE( extendable_binary_integer_array_other_types )
+{
+  // integer arrays can be loaded to integers of different size
+  const std::vector<std::uint64_t> o_small = {1, 2, 3, 60000, 4};
+  const std::vector<std::int32_t> o_negative = {-1, 5, -30000};
+  const std::string saved = save_compressed(o_small) + save_compressed(o_negative).substr(1);
+
+  std::vector<std::uint16_t> i_small;
+  std::vector<std::int16_t> i_negative;
+  {
+    cereal::ExtendableBinaryInputArchive iar(saved.data(), saved.size());
+    iar(i_small, i_negative);
+  }
+  BOOST_CHECK_EQUAL_COLLECTIONS(i_small.begin(), i_small.end(), o_small.begin(), o_small.end());
+  BOOST_CHECK_EQUAL_COLLECTIONS(i_negative.begin(), i_negative.end(), o_negative.begin(), o_negative.end());
+
+  // value doesn't fit
+  {
+    std::vector<std::int8_t> i_tooSmall;
+    cereal::ExtendableBinaryInputArchive iar(saved.data(), saved.size());
+    BOOST_CHECK_THROW(iar(i_tooSmall), cereal::Exception);
+  }
+  // negative value to unsigned type
+  {
+    std::vector<std::uint64_t> i_first;
+    std::vector<std::uint32_t> i_unsigned;
+    cereal::ExtendableBinaryInputArchive iar(saved.data(), saved.size());
+    iar(i_first);
+    BOOST_CHECK_THROW(iar(i_unsigned), cereal::Exception);
+  }
+  // not integer type
+  {
+    std::vector<float> i_float;
+    cereal::ExtendableBinaryInputArchive iar(saved.data(), saved.size());
+    BOOST_CHECK_THROW(iar(i_float), cereal::Exception);
+  }
+
+  // views are loaded as copies
+  cereal::ArrayView<std::uint64_t> i_view;
+  {
+    cereal::ExtendableBinaryInputArchive iar(saved.data(), saved.size());
+    iar(i_view);
+  }
+  BOOST_CHECK(i_view.isCopy());
+  BOOST_CHECK_EQUAL_COLLECTIONS(i_view.begin(), i_view.end(), o_small.begin(), o_small.end());
+}
+
+BOOST_AUTO_TEST_CASE( extendable_binary_integer_array_corrupted )
+{
+  const std::vector<std::uint64_t> o_ids(100, 7);
+  const std::vector<std::uint64_t> o_varints = {1, 1000000000000, 2, 3, 4, 5, 6, 7, 8};
+  for (auto const & o_vector : {o_ids, o_varints}) {
+    const std::string saved = save_compressed(o_vector);
+    for (std::size_t size = 1; size < saved.size(); ++size) {
+      std::vector<std::uint64_t> i_vector;
+      cereal::ExtendableBinaryInputArchive iar(saved.data(), size);
+      BOOST_CHECK_THROW(iar(i_vector), cereal::Exception);
+    }
+  }
+}
+
+struct IdsNew
+{
+  std::uint32_t id;
+  std::vector<std::uint64_t> ids;
+
+  template <class Archive>
+  void serialize(Archive & ar)
+  {
+    ar(id, ids, id);
+  }
+};
+
+struct IdsOld
+{
+  std::uint32_t id;
+  std::uint32_t id2;
+
+  template <class Archive>
+  void serialize(Archive & ar)
+  {
+    ar(id, cereal::OmittedFieldTag(), id2);
+  }
+};
+
+BOOST_AUTO_TEST_CASE( extendable_binary_integer_array_skip )
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  std::vector<IdsNew> o_objects(10);
+  for (auto & object : o_objects) {
+    object.id = random_value<std::uint32_t>(gen);
+    object.ids = random_integers<std::uint64_t>(gen, random_value<std::uint8_t>(gen), 0, 1 + object.id % 5000);
+  }
+  const std::string saved = save_compressed(o_objects);
+  std::vector<IdsOld> i_objects;
+  {
+    cereal::ExtendableBinaryInputArchive iar(saved.data(), saved.size());
+    iar(i_objects);
+  }
+  BOOST_REQUIRE_EQUAL(i_objects.size(), o_objects.size());
+  for (std::size_t i = 0; i < i_objects.size(); ++i) {
+    BOOST_CHECK_EQUAL(i_objects[i].id, o_objects[i].id);
+    BOOST_CHECK_EQUAL(i_objects[i].id2, o_objects[i].id);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( extendable_binary_integer_array_delta )
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  // sorted timestamps are saved as deltas
+  auto timestamps = random_integers<std::int64_t>(gen, 1000, 1400000000000000000ll, 1400000000001000000ll);
+  std::sort(timestamps.begin(), timestamps.end());
+  check_round_trip(timestamps);
+  const std::size_t raw = save_compressed(timestamps, false).size();
+  BOOST_CHECK_LE(save_compressed(timestamps).size(), raw - timestamps.size() * sizeof(std::int64_t) + 2 * timestamps.size() + 16);
+
+  // descending values
+  std::reverse(timestamps.begin(), timestamps.end());
+  check_round_trip(timestamps);
+
+  // differences overflow
+  check_round_trip(std::vector<std::int64_t>{std::numeric_limits<std::int64_t>::min(), std::numeric_limits<std::int64_t>::max(),
+                                             0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15});
+  check_round_trip(std::vector<std::uint64_t>{std::numeric_limits<std::uint64_t>::max(), 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12});
+}
+
+namespace
+{
+  cereal::ExtendableBinaryOutputArchive::Options delta_keys(bool littleEndian = true)
+  {
+    auto options = littleEndian ? cereal::ExtendableBinaryOutputArchive::Options().littleEndian()
+                                : cereal::ExtendableBinaryOutputArchive::Options().bigEndian();
+    return options.deltaEncodedKeys(true);
+  }
+
+  template <class T>
+  void check_delta_keys(T const & o_container, std::size_t & size)
+  {
+    for (bool littleEndian : {true, false}) {
+      std::ostringstream os;
+      {
+        cereal::ExtendableBinaryOutputArchive oar(os, delta_keys(littleEndian));
+        oar(o_container);
+      }
+      const std::string saved = os.str();
+      size = saved.size();
+
+      T i_container;
+      {
+        cereal::ExtendableBinaryInputArchive iar(saved.data(), saved.size());
+        iar(i_container);
+      }
+      BOOST_CHECK(i_container == o_container);
+
+      std::istringstream is(saved);
+      T i_container2;
+      {
+        cereal::ExtendableBinaryInputArchive iar(is);
+        iar(i_container2);
+      }
+      BOOST_CHECK(i_container2 == o_container);
+    }
+  }
+
+  template <class T>
+  std::size_t saved_size(T const & t)
+  {
+    std::ostringstream os;
+    {
+      cereal::ExtendableBinaryOutputArchive oar(os);
+      oar(t);
+    }
+    return os.str().size();
+  }
+}
+
+BOOST_AUTO_TEST_CASE( extendable_binary_delta_encoded_keys )
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  const std::int64_t base = 1400000000000000000ll;
+  std::size_t size;
+
+  std::set<std::int64_t> o_set;
+  std::multiset<std::uint16_t> o_multiset;
+  std::map<std::uint64_t, std::string> o_map;
+  std::multimap<std::int32_t, std::vector<std::int32_t>> o_multimap;
+  std::vector<std::chrono::system_clock::time_point> o_timePoints;
+  std::map<std::int64_t, int, std::greater<std::int64_t>> o_reversed;
+
+  check_delta_keys(o_set, size);
+  check_delta_keys(o_map, size);
+  check_delta_keys(o_timePoints, size);
+
+  for (int i = 0; i < 1000; ++i) {
+    o_set.insert(base + random_value<std::uint16_t>(gen) * 1000);
+    o_multiset.insert(random_value<std::uint16_t>(gen) % 100);
+    o_map.emplace(static_cast<std::uint64_t>(base) + random_value<std::uint32_t>(gen), random_basic_string<char>(gen));
+    o_multimap.emplace(random_value<std::int32_t>(gen) % 50, std::vector<std::int32_t>(i % 3, i));
+    o_reversed.emplace(random_value<std::int64_t>(gen), i);
+  }
+  auto now = std::chrono::system_clock::now();
+  for (int i = 0; i < 1000; ++i) {
+    now += std::chrono::microseconds(random_value<std::uint8_t>(gen));
+    o_timePoints.push_back(now);
+  }
+
+  // keys take few bytes instead of eight
+  check_delta_keys(o_set, size);
+  BOOST_CHECK_LE(size, 4 * o_set.size());
+  BOOST_CHECK_LT(size, saved_size(o_set));
+  check_delta_keys(o_multiset, size);
+  BOOST_CHECK_LE(size, 2 * o_multiset.size());
+  check_delta_keys(o_map, size);
+  BOOST_CHECK_LT(size, saved_size(o_map));
+  check_delta_keys(o_multimap, size);
+  BOOST_CHECK_LT(size, saved_size(o_multimap));
+  check_delta_keys(o_timePoints, size);
+  BOOST_CHECK_LE(size, 3 * o_timePoints.size());
+  check_delta_keys(o_reversed, size);
+}
+
+struct TimeSeriesNew
+{
+  std::uint32_t id;
+  std::map<std::int64_t, double> values;
+  std::uint32_t id2;
+
+  template <class Archive>
+  void serialize(Archive & ar)
+  {
+    ar(id, values, id2);
+  }
+};
+
+struct TimeSeriesOld
+{
+  std::uint32_t id;
+  std::uint32_t id2;
+
+  template <class Archive>
+  void serialize(Archive & ar)
+  {
+    ar(id, cereal::OmittedFieldTag(), id2);
+  }
+};
+
+BOOST_AUTO_TEST_CASE( extendable_binary_delta_encoded_keys_skip )
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  std::vector<TimeSeriesNew> o_series(10);
+  for (auto & series : o_series) {
+    series.id = random_value<std::uint32_t>(gen);
+    series.id2 = random_value<std::uint32_t>(gen);
+    const int count = random_value<std::uint8_t>(gen);
+    for (int i = 0; i < count; ++i)
+      series.values.emplace(random_value<std::int64_t>(gen), random_value<double>(gen));
+  }
+  for (bool lengthPrefixed : {false, true}) {
+    std::ostringstream os;
+    {
+      cereal::ExtendableBinaryOutputArchive oar(os, delta_keys().lengthPrefixedObjects(lengthPrefixed));
+      oar(o_series);
+    }
+    std::vector<TimeSeriesOld> i_series;
+    std::istringstream is(os.str());
+    {
+      cereal::ExtendableBinaryInputArchive iar(is);
+      iar(i_series);
+    }
+    BOOST_REQUIRE_EQUAL(i_series.size(), o_series.size());
+    for (std::size_t i = 0; i < i_series.size(); ++i) {
+      BOOST_CHECK_EQUAL(i_series[i].id, o_series[i].id);
+      BOOST_CHECK_EQUAL(i_series[i].id2, o_series[i].id2);
+    }
+  }
+}
@@ -0,0 +1,256 @@
+/*! \file extendable_binary_lazy.cpp
+    \brief Tests for lazily decoded fields of extendable binary archives
+    \ingroup tests */
+/*
+  Copyright (c) 2016, Michal Breiter
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT OR MICHAL BREITER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <cereal/archives/extendable_binary_lazy.hpp>
+#include <boost/test/unit_test.hpp>
+
+struct LazyBase
+{
+  virtual ~LazyBase() {}
+
+  std::int32_t id = 0;
+
+  template <class Archive>
+  void serialize(Archive & ar)
+  {
+    ar(id);
+  }
+};
+
+struct LazyDerived : LazyBase
+{
+  std::string name;
+
+  template <class Archive>
+  void serialize(Archive & ar, std::uint32_t)
+  {
+    ar(cereal::base_class<LazyBase>(this), name);
+  }
+};
+CEREAL_REGISTER_TYPE(LazyDerived)
+CEREAL_CLASS_VERSION(LazyDerived, 2)
+
+struct LazyBody
+{
+  std::vector<double> samples;
+  std::string text;
+  std::shared_ptr<LazyBase> shared;
+  std::shared_ptr<LazyBase> sameShared;
+
+  template <class Archive>
+  void serialize(Archive & ar, std::uint32_t)
+  {
+    ar(samples, text, shared, sameShared);
+  }
+};
+
+struct LazyMessage
+{
+  std::int32_t header = 0;
+  std::shared_ptr<LazyBase> shared;
+  cereal::lazy<LazyBody> body;
+  std::int32_t trailer = 0;
+
+  template <class Archive>
+  void serialize(Archive & ar, std::uint32_t)
+  {
+    ar(header, shared, body, trailer);
+  }
+};
+
+//! Reader which doesn't use body
+struct LazyMessageOmitted
+{
+  std::int32_t header = 0;
+  std::shared_ptr<LazyBase> shared;
+  std::int32_t trailer = 0;
+
+  template <class Archive>
+  void serialize(Archive & ar, std::uint32_t)
+  {
+    ar(header, shared, cereal::OmittedFieldTag(), trailer);
+  }
+};
+
+LazyBody random_lazy_body(std::mt19937 & gen)
+{
+  LazyBody b;
+  b.samples.resize(gen() % 100);
+  for(auto & s : b.samples)
+    s = random_value<double>(gen);
+  b.text = random_basic_string<char>(gen);
+  auto derived = std::make_shared<LazyDerived>();
+  derived->id = random_value<std::int32_t>(gen);
+  derived->name = random_basic_string<char>(gen);
+  b.shared = derived;
+  b.sameShared = derived;
+  return b;
+}
+
+LazyMessage random_lazy_message(std::mt19937 & gen)
+{
+  LazyMessage m;
+  m.header = random_value<std::int32_t>(gen);
+  auto derived = std::make_shared<LazyDerived>();
+  derived->id = random_value<std::int32_t>(gen);
+  m.shared = derived;
+  m.body = random_lazy_body(gen);
+  m.trailer = random_value<std::int32_t>(gen);
+  return m;
+}
+
+void check_lazy_body(LazyBody const & loaded, LazyBody const & saved)
+{
+  BOOST_CHECK(loaded.samples == saved.samples);
+  BOOST_CHECK_EQUAL(loaded.text, saved.text);
+  auto const derived = std::dynamic_pointer_cast<LazyDerived>(loaded.shared);
+  BOOST_REQUIRE(derived != nullptr);
+  BOOST_CHECK(loaded.sameShared == loaded.shared);
+  BOOST_CHECK_EQUAL(derived->id, saved.shared->id);
+  BOOST_CHECK_EQUAL(derived->name, std::static_pointer_cast<LazyDerived>(saved.shared)->name);
+}
+
+void check_lazy_message(LazyMessage const & loaded, LazyMessage const & saved)
+{
+  BOOST_CHECK_EQUAL(loaded.header, saved.header);
+  BOOST_REQUIRE(loaded.shared != nullptr);
+  BOOST_CHECK(std::dynamic_pointer_cast<LazyDerived>(loaded.shared) != nullptr);
+  BOOST_CHECK_EQUAL(loaded.shared->id, saved.shared->id);
+  BOOST_CHECK_EQUAL(loaded.trailer, saved.trailer);
+  check_lazy_body(loaded.body.get(), saved.body.get());
+}
+
+template <class T>
+std::string save_lazy(T const & t, cereal::ExtendableBinaryOutputArchive::Options const & options)
+{
+  std::ostringstream os(std::ios::binary);
+  {
+    cereal::ExtendableBinaryOutputArchive oar(os, options);
+    oar(t);
+  }
+  return os.str();
+}
+
+static_assert(!std::is_convertible<LazyBody, cereal::lazy<LazyBody>>::value,
+              "value is not converted to lazy implicitly");
+
+BOOST_AUTO_TEST_CASE( extendable_binary_lazy )
+{
+  using Options = cereal::ExtendableBinaryOutputArchive::Options;
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  for(auto const & options : {Options(), Options().bigEndian().lengthPrefixedObjects(true)}) {
+    auto const message = random_lazy_message(gen);
+    BOOST_CHECK(message.body.loaded());
+    auto const data = save_lazy(message, options);
+
+    for(bool memoryInput : {false, true}) {
+      LazyMessage loaded;
+      std::istringstream is(data, std::ios::binary);
+      if(memoryInput) {
+        cereal::ExtendableBinaryInputArchive iar(data.data(), data.size());
+        iar(loaded);
+      } else {
+        cereal::ExtendableBinaryInputArchive iar(is);
+        iar(loaded);
+      }
+      BOOST_CHECK(false == loaded.body.loaded());
+
+      // not decoded value is saved with the same bytes
+      BOOST_CHECK(save_lazy(loaded, options) == data);
+      check_lazy_message(loaded, message);
+      BOOST_CHECK(loaded.body.loaded());
+      BOOST_CHECK(save_lazy(loaded, options) == data);
+
+      // changed value is encoded again
+      loaded.body.get().text += "changed";
+      auto const changed = save_lazy(loaded, options);
+      LazyMessage loadedChanged;
+      {
+        cereal::ExtendableBinaryInputArchive iar(changed.data(), changed.size());
+        iar(loadedChanged);
+      }
+      check_lazy_message(loadedChanged, loaded);
+    }
+
+    // older reader skips value
+    std::istringstream is(data, std::ios::binary);
+    cereal::ExtendableBinaryInputArchive iar(is);
+    LazyMessageOmitted omitted;
+    iar(omitted);
+    BOOST_CHECK_EQUAL(omitted.header, message.header);
+    BOOST_CHECK_EQUAL(omitted.trailer, message.trailer);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( extendable_binary_lazy_buffer )
+{
+  using Options = cereal::ExtendableBinaryOutputArchive::Options;
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  auto const message = random_lazy_message(gen);
+  auto const data = save_lazy(message, Options().bigEndian());
+
+  // value saved with other options is copied to archive as it is
+  std::vector<LazyMessage> loaded(2);
+  {
+    std::vector<char> buffer(data.begin(), data.end());
+    cereal::ExtendableBinaryInputArchive iar(buffer.data(), buffer.size());
+    iar(loaded[0]);
+    auto const littleEndian = save_lazy(loaded[0], Options().littleEndian());
+    cereal::ExtendableBinaryInputArchive littleIar(littleEndian.data(), littleEndian.size());
+    littleIar(loaded[1]);
+    for(auto & m : loaded)
+      m.body.detach();
+    std::fill(buffer.begin(), buffer.end(), '\0');
+  }
+  for(auto const & m : loaded)
+    check_lazy_message(m, message);
+
+  // value is decoded only by get(), size of text is bigger than remaining data
+  auto shortMessage = message;
+  shortMessage.body.get().text = "lazy text";
+  auto derived = std::make_shared<LazyDerived>();
+  derived->name = "name";
+  shortMessage.body.get().shared = derived;
+  shortMessage.body.get().sameShared = derived;
+  auto broken = save_lazy(shortMessage, Options());
+  auto const found = broken.find("lazy text");
+  BOOST_REQUIRE(found != std::string::npos);
+  broken[found - 1] = '\x7f';
+  LazyMessage loadedBroken;
+  cereal::ExtendableBinaryInputArchive iar(broken.data(), broken.size());
+  iar(loadedBroken);
+  BOOST_CHECK_EQUAL(loadedBroken.trailer, message.trailer);
+  BOOST_CHECK_THROW(loadedBroken.body.get(), cereal::Exception);
+  BOOST_CHECK(false == loadedBroken.body.loaded());
+}
@@ -0,0 +1,378 @@
+/*! \file extendable_binary_packed_struct.cpp
+    \brief Tests for packed structs in extendable binary archive
+    \ingroup tests */
+/*
+  Copyright (c) 2016, Michal Breiter
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT OR MICHAL BREITER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <boost/test/unit_test.hpp>
+
+struct Point3f
+{
+  float x, y, z;
+
+  template <class Archive>
+  void serialize(Archive & ar)
+  {
+    ar(x, y, z);
+  }
+
+  bool operator==(Point3f const & other) const
+  { return x == other.x && y == other.y && z == other.z; }
+
+  bool operator!=(Point3f const & other) const
+  { return !(*this == other); }
+
+  friend std::ostream & operator<<(std::ostream & os, Point3f const & p)
+  { return os << "(" << p.x << ", " << p.y << ", " << p.z << ")"; }
+};
+CEREAL_EXTENDABLE_BINARY_PACKED_STRUCT(Point3f)
+
+/** fields serialized in different order than in memory, nested struct and std::array */
+struct Segment
+{
+  std::uint16_t id;
+  std::uint16_t flags;
+  Point3f from;
+  Point3f to;
+  std::array<std::int32_t, 2> tags;
+
+  template <class Archive>
+  void serialize(Archive & ar, std::uint32_t)
+  {
+    ar(from, to, tags, flags, id);
+  }
+
+  bool operator==(Segment const & other) const
+  {
+    return id == other.id && flags == other.flags && from == other.from && to == other.to && tags == other.tags;
+  }
+
+  bool operator!=(Segment const & other) const
+  { return !(*this == other); }
+
+  friend std::ostream & operator<<(std::ostream & os, Segment const & s)
+  { return os << s.id << " " << s.from << " " << s.to; }
+};
+CEREAL_EXTENDABLE_BINARY_PACKED_STRUCT(Segment)
+CEREAL_CLASS_VERSION(Segment, 1)
+
+/** same as Point3f, but not packed */
+struct Point3fFields
+{
+  float x, y, z;
+
+  template <class Archive>
+  void serialize(Archive & ar)
+  {
+    ar(x, y, z);
+  }
+};
+
+/** old version of sample */
+struct SampleOld
+{
+  std::int32_t value;
+  std::uint16_t count;
+  std::uint16_t channel;
+
+  template <class Archive>
+  void serialize(Archive & ar)
+  {
+    ar(value, count, channel);
+  }
+};
+CEREAL_EXTENDABLE_BINARY_PACKED_STRUCT(SampleOld)
+
+/** new version of sample - wider fields and new field at the end */
+struct SampleNew
+{
+  std::int64_t value;
+  std::uint32_t count;
+  std::uint16_t channel;
+  std::int16_t gain;
+
+  template <class Archive>
+  void serialize(Archive & ar)
+  {
+    ar(value, count, channel, gain);
+  }
+};
+CEREAL_EXTENDABLE_BINARY_PACKED_STRUCT(SampleNew)
+
+/** struct with padding can't be saved as raw memory */
+struct Padded
+{
+  std::uint8_t a;
+  std::uint32_t b;
+
+  template <class Archive>
+  void serialize(Archive & ar)
+  {
+    ar(a, b);
+  }
+};
+CEREAL_EXTENDABLE_BINARY_PACKED_STRUCT(Padded)
+
+struct PathNew
+{
+  std::int32_t id;
+  std::vector<Point3f> points;
+  Segment segment;
+
+  template <class Archive>
+  void serialize(Archive & ar, std::uint32_t version)
+  {
+    ar(id);
+    ar(points);
+    if(version >= 1)
+      ar(segment);
+  }
+};
+CEREAL_CLASS_VERSION(PathNew, 1)
+
+struct PathOld
+{
+  std::int32_t id;
+
+  template <class Archive>
+  void serialize(Archive & ar, std::uint32_t)
+  {
+    ar(id);
+    ar(cereal::OmittedFieldTag());
+  }
+};
+
+template <class T>
+T random_packed(std::mt19937 & gen);
+
+template <>
+Point3f random_packed<Point3f>(std::mt19937 & gen)
+{
+  return {random_value<float>(gen), random_value<float>(gen), random_value<float>(gen)};
+}
+
+template <>
+Segment random_packed<Segment>(std::mt19937 & gen)
+{
+  return {random_value<std::uint16_t>(gen), random_value<std::uint16_t>(gen),
+          random_packed<Point3f>(gen), random_packed<Point3f>(gen),
+          {{random_value<std::int32_t>(gen), random_value<std::int32_t>(gen)}}};
+}
+
+template <class IArchive, class OArchive>
+void test_packed_struct(typename OArchive::Options const & oOptions)
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  std::vector<Point3f> o_points(1000);
+  for (auto & elem : o_points)
+    elem = random_packed<Point3f>(gen);
+  std::vector<Segment> o_segments(100);
+  for (auto & elem : o_segments)
+    elem = random_packed<Segment>(gen);
+  const Segment o_segment = random_packed<Segment>(gen);
+  const std::vector<Point3f> o_empty;
+
+  std::ostringstream os;
+  {
+    OArchive oar(os, oOptions);
+    oar(o_points, o_segments, o_segment, o_empty);
+  }
+  const std::string saved = os.str();
+
+  for (bool memoryInput : {false, true}) {
+    std::vector<Point3f> i_points;
+    std::vector<Segment> i_segments;
+    Segment i_segment;
+    std::vector<Point3f> i_empty(3);
+    if (memoryInput) {
+      IArchive iar(saved.data(), saved.size());
+      iar(i_points, i_segments, i_segment, i_empty);
+    } else {
+      std::istringstream is(saved);
+      IArchive iar(is);
+      iar(i_points, i_segments, i_segment, i_empty);
+    }
+
+    BOOST_CHECK_EQUAL_COLLECTIONS(i_points.begin(), i_points.end(), o_points.begin(), o_points.end());
+    BOOST_CHECK_EQUAL_COLLECTIONS(i_segments.begin(), i_segments.end(), o_segments.begin(), o_segments.end());
+    BOOST_CHECK_EQUAL(i_segment, o_segment);
+    BOOST_CHECK(i_empty.empty());
+  }
+}
+
+BOOST_AUTO_TEST_CASE( extendable_binary_packed_struct )
+{
+  test_packed_struct<cereal::ExtendableBinaryInputArchive, cereal::ExtendableBinaryOutputArchive>(
+      cereal::ExtendableBinaryOutputArchive::Options().littleEndian());
+  test_packed_struct<cereal::ExtendableBinaryInputArchive, cereal::ExtendableBinaryOutputArchive>(
+      cereal::ExtendableBinaryOutputArchive::Options().bigEndian());
+}
+
+BOOST_AUTO_TEST_CASE( extendable_binary_packed_struct_size )
+{
+  std::vector<Point3f> o_points(100);
+  std::vector<Point3fFields> o_fields(100);
+
+  std::ostringstream packed;
+  {
+    cereal::ExtendableBinaryOutputArchive oar(packed);
+    oar(o_points);
+  }
+  std::ostringstream fields;
+  {
+    cereal::ExtendableBinaryOutputArchive oar(fields);
+    oar(o_fields);
+  }
+  // header, tag, layout (2 + 3) and size
+  BOOST_CHECK_EQUAL(packed.str().size(), 1 + 1 + 5 + 1 + o_points.size() * sizeof(Point3f));
+  BOOST_CHECK_LT(packed.str().size(), fields.str().size());
+}
+
+BOOST_AUTO_TEST_CASE( extendable_binary_packed_struct_other_archives )
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::vector<Segment> o_segments(10);
+  for (auto & elem : o_segments)
+    elem = random_packed<Segment>(gen);
+
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive oar(os);
+    oar(o_segments);
+  }
+  std::vector<Segment> i_segments;
+  std::istringstream is(os.str());
+  {
+    cereal::BinaryInputArchive iar(is);
+    iar(i_segments);
+  }
+  BOOST_CHECK_EQUAL_COLLECTIONS(i_segments.begin(), i_segments.end(), o_segments.begin(), o_segments.end());
+}
+
+BOOST_AUTO_TEST_CASE( extendable_binary_packed_struct_layout_change )
+{
+  std::vector<SampleOld> o_old = {{-5, 3, 1}, {std::numeric_limits<std::int32_t>::min(), 0xffff, 2}};
+  std::vector<SampleNew> o_new = {{-7, 40000, 3, -2}, {1ll << 40, 1, 4, 5}};
+
+  std::ostringstream osOld;
+  {
+    cereal::ExtendableBinaryOutputArchive oar(osOld, cereal::ExtendableBinaryOutputArchive::Options().bigEndian());
+    oar(o_old, o_new.back());
+  }
+  std::ostringstream osNew;
+  {
+    cereal::ExtendableBinaryOutputArchive oar(osNew);
+    oar(o_new);
+  }
+
+  // old data loaded to wider fields, new field is not modified
+  std::vector<SampleNew> i_new;
+  SampleOld i_single;
+  {
+    std::istringstream is(osOld.str());
+    cereal::ExtendableBinaryInputArchive iar(is);
+    iar(i_new);
+    BOOST_CHECK_THROW(iar(i_single), cereal::Exception); // value doesn't fit
+  }
+  BOOST_REQUIRE_EQUAL(i_new.size(), o_old.size());
+  for (std::size_t i = 0; i < i_new.size(); ++i) {
+    BOOST_CHECK_EQUAL(i_new[i].value, o_old[i].value);
+    BOOST_CHECK_EQUAL(i_new[i].count, o_old[i].count);
+    BOOST_CHECK_EQUAL(i_new[i].channel, o_old[i].channel);
+    BOOST_CHECK_EQUAL(i_new[i].gain, 0);
+  }
+
+  // new data loaded to narrower fields, value which doesn't fit results in exception
+  std::vector<SampleOld> i_old;
+  {
+    std::istringstream is(osNew.str());
+    cereal::ExtendableBinaryInputArchive iar(is);
+    BOOST_CHECK_THROW(iar(i_old), cereal::Exception);
+  }
+  o_new = {{-7, 4, 3, -2}, {-(1ll << 30), 1, 4, 5}};
+  std::ostringstream osNewFits;
+  {
+    cereal::ExtendableBinaryOutputArchive oar(osNewFits);
+    oar(o_new);
+  }
+  {
+    std::istringstream is(osNewFits.str());
+    cereal::ExtendableBinaryInputArchive iar(is);
+    iar(i_old);
+  }
+  BOOST_REQUIRE_EQUAL(i_old.size(), o_new.size());
+  for (std::size_t i = 0; i < i_old.size(); ++i) {
+    BOOST_CHECK_EQUAL(i_old[i].value, o_new[i].value);
+    BOOST_CHECK_EQUAL(i_old[i].count, o_new[i].count);
+    BOOST_CHECK_EQUAL(i_old[i].channel, o_new[i].channel);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( extendable_binary_packed_struct_skip )
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  for (bool lengthPrefixed : {false, true}) {
+    std::vector<PathNew> o_paths(10);
+    for (auto & path : o_paths) {
+      path.id = random_value<std::int32_t>(gen);
+      path.points.resize(random_value<std::uint8_t>(gen));
+      for (auto & elem : path.points)
+        elem = random_packed<Point3f>(gen);
+      path.segment = random_packed<Segment>(gen);
+    }
+
+    std::ostringstream os;
+    {
+      cereal::ExtendableBinaryOutputArchive oar(os, cereal::ExtendableBinaryOutputArchive::Options().lengthPrefixedObjects(lengthPrefixed));
+      oar(o_paths, o_paths.back().points);
+    }
+
+    std::vector<PathOld> i_paths;
+    std::vector<Point3f> i_points;
+    std::istringstream is(os.str());
+    {
+      cereal::ExtendableBinaryInputArchive iar(is);
+      iar(i_paths, i_points);
+    }
+    BOOST_REQUIRE_EQUAL(i_paths.size(), o_paths.size());
+    for (std::size_t i = 0; i < i_paths.size(); ++i)
+      BOOST_CHECK_EQUAL(i_paths[i].id, o_paths[i].id);
+    BOOST_CHECK_EQUAL_COLLECTIONS(i_points.begin(), i_points.end(), o_paths.back().points.begin(), o_paths.back().points.end());
+  }
+}
+
+BOOST_AUTO_TEST_CASE( extendable_binary_packed_struct_padding )
+{
+  std::ostringstream os;
+  cereal::ExtendableBinaryOutputArchive oar(os);
+  BOOST_CHECK_THROW(oar(Padded{1, 2}), cereal::Exception);
+}
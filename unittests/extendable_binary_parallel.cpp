@@ -0,0 +1,474 @@
+/*! \file extendable_binary_parallel.cpp
+    \brief Tests for saving containers in chunks encoded in parallel
+    \ingroup tests */
+/*
+  Copyright (c) 2016, Michal Breiter
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT OR MICHAL BREITER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <cereal/archives/extendable_binary_parallel.hpp>
+#include <boost/test/unit_test.hpp>
+
+struct ChunkBase
+{
+  virtual ~ChunkBase() {}
+
+  std::int32_t id = 0;
+
+  template <class Archive>
+  void serialize(Archive & ar)
+  {
+    ar(id);
+  }
+};
+
+struct ChunkDerived : ChunkBase
+{
+  std::string name;
+
+  template <class Archive>
+  void serialize(Archive & ar, std::uint32_t)
+  {
+    ar(cereal::base_class<ChunkBase>(this), name);
+  }
+};
+CEREAL_REGISTER_TYPE(ChunkDerived)
+CEREAL_CLASS_VERSION(ChunkDerived, 4)
+
+struct ChunkRecord
+{
+  std::uint64_t key = 0;
+  std::string text;
+  std::vector<double> samples;
+  std::shared_ptr<ChunkBase> shared;
+  std::shared_ptr<ChunkBase> sameShared;
+
+  template <class Archive>
+  void serialize(Archive & ar, std::uint32_t)
+  {
+    ar(key, text, samples, shared, sameShared);
+  }
+};
+
+//! Older version of ChunkRecord, doesn't know fields added later
+struct ChunkRecordOld
+{
+  std::uint64_t key = 0;
+  std::string text;
+
+  template <class Archive>
+  void serialize(Archive & ar, std::uint32_t)
+  {
+    ar(key, text);
+  }
+};
+
+//! Fails saving of element with given key
+struct ChunkFailing
+{
+  std::uint64_t key = 0;
+
+  template <class Archive>
+  void save(Archive & ar) const
+  {
+    if(key == 13)
+      throw std::runtime_error("failed");
+    ar(key);
+  }
+
+  template <class Archive>
+  void load(Archive & ar)
+  {
+    ar(key);
+  }
+};
+
+//! Fails loading of element with given key
+struct ChunkFailingLoad
+{
+  std::uint64_t key = 0;
+
+  template <class Archive>
+  void save(Archive & ar) const
+  {
+    ar(key);
+  }
+
+  template <class Archive>
+  void load(Archive & ar)
+  {
+    ar(key);
+    if(key == 13)
+      throw std::logic_error("failed");
+  }
+};
+
+//! Versioned types without registered version, saved first time by different chunks at once
+struct ChunkVersionedA
+{
+  std::int32_t value = 0;
+
+  template <class Archive>
+  void serialize(Archive & ar, std::uint32_t version)
+  {
+    ar(value);
+    if(version != 0)
+      throw std::logic_error("wrong version");
+  }
+};
+
+struct ChunkVersionedB
+{
+  std::int32_t value = 0;
+
+  template <class Archive>
+  void serialize(Archive & ar, std::uint32_t version)
+  {
+    ar(value);
+    if(version != 0)
+      throw std::logic_error("wrong version");
+  }
+};
+
+struct ChunkVersioned
+{
+  std::unique_ptr<ChunkVersionedA> a;
+  std::unique_ptr<ChunkVersionedB> b;
+
+  template <class Archive>
+  void serialize(Archive & ar)
+  {
+    ar(a, b);
+  }
+};
+
+//! Element without default constructor, loaded with load_and_construct
+struct ChunkConstructed
+{
+  ChunkConstructed(std::int32_t v) : value(v) {}
+
+  std::int32_t value;
+
+  template <class Archive>
+  void serialize(Archive & ar)
+  {
+    ar(value);
+  }
+
+  template <class Archive>
+  static void load_and_construct(Archive & ar, cereal::construct<ChunkConstructed> & construct)
+  {
+    std::int32_t v;
+    ar(v);
+    construct(v);
+  }
+};
+
+struct ChunkedMessage
+{
+  std::int32_t before = 0;
+  std::vector<ChunkRecord> records;
+  std::int32_t after = 0;
+
+  template <class Archive>
+  void save(Archive & ar) const
+  {
+    ar(before, cereal::make_parallel_chunks(records, 7, 3), after);
+  }
+
+  template <class Archive>
+  void load(Archive & ar)
+  {
+    ar(before, cereal::make_parallel_chunks(records), after);
+  }
+};
+
+//! Reader which doesn't use records
+struct ChunkedMessageOmitted
+{
+  std::int32_t before = 0;
+  std::int32_t after = 0;
+
+  template <class Archive>
+  void serialize(Archive & ar)
+  {
+    ar(before, cereal::OmittedFieldTag(), after);
+  }
+};
+
+std::vector<ChunkRecord> random_chunk_records(std::mt19937 & gen, std::size_t size)
+{
+  std::vector<ChunkRecord> records(size);
+  for(std::size_t ii = 0; ii < size; ++ii) {
+    auto & r = records[ii];
+    r.key = ii;
+    r.text = random_basic_string<char>(gen);
+    r.samples.resize(gen() % 20);
+    for(auto & s : r.samples)
+      s = random_value<double>(gen);
+    auto derived = std::make_shared<ChunkDerived>();
+    derived->id = random_value<std::int32_t>(gen);
+    derived->name = random_basic_string<char>(gen);
+    r.shared = derived;
+    r.sameShared = derived;
+  }
+  return records;
+}
+
+void check_chunk_records(std::vector<ChunkRecord> const & loaded, std::vector<ChunkRecord> const & saved)
+{
+  BOOST_REQUIRE_EQUAL(loaded.size(), saved.size());
+  for(std::size_t ii = 0; ii < saved.size(); ++ii) {
+    BOOST_CHECK_EQUAL(loaded[ii].key, saved[ii].key);
+    BOOST_CHECK_EQUAL(loaded[ii].text, saved[ii].text);
+    BOOST_CHECK(loaded[ii].samples == saved[ii].samples);
+    auto const derived = std::dynamic_pointer_cast<ChunkDerived>(loaded[ii].shared);
+    BOOST_REQUIRE(derived != nullptr);
+    BOOST_CHECK(loaded[ii].sameShared == loaded[ii].shared);
+    BOOST_CHECK_EQUAL(derived->id, saved[ii].shared->id);
+    BOOST_CHECK_EQUAL(derived->name, std::static_pointer_cast<ChunkDerived>(saved[ii].shared)->name);
+  }
+}
+
+template <class T>
+std::string save_chunked(T const & container, cereal::ExtendableBinaryOutputArchive::Options const & options,
+                         std::size_t chunkElements, unsigned threads)
+{
+  std::ostringstream os(std::ios::binary);
+  {
+    cereal::ExtendableBinaryOutputArchive oar(os, options);
+    oar(cereal::make_parallel_chunks(container, chunkElements, threads));
+  }
+  return os.str();
+}
+
+template <class T>
+void load_chunked(std::string const & data, bool memoryInput, T & container)
+{
+  if(memoryInput) {
+    cereal::ExtendableBinaryInputArchive iar(data.data(), data.size());
+    iar(cereal::make_parallel_chunks(container));
+  } else {
+    std::istringstream is(data, std::ios::binary);
+    cereal::ExtendableBinaryInputArchive iar(is);
+    iar(cereal::make_parallel_chunks(container));
+  }
+}
+
+BOOST_AUTO_TEST_CASE( extendable_binary_parallel_chunks )
+{
+  using Options = cereal::ExtendableBinaryOutputArchive::Options;
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  for(auto const & options : {Options(), Options().bigEndian().lengthPrefixedObjects(true)}) {
+    for(std::size_t size : {std::size_t(0), std::size_t(1), std::size_t(100)}) {
+      auto const records = random_chunk_records(gen, size);
+      // saved data doesn't depend on number of threads
+      auto const saved = save_chunked(records, options, 7, 1);
+      BOOST_CHECK(save_chunked(records, options, 7, 8) == saved);
+
+      for(std::size_t chunkElements : {std::size_t(1), std::size_t(7), std::size_t(1000)}) {
+        auto const data = save_chunked(records, options, chunkElements, 4);
+        for(bool memoryInput : {false, true}) {
+          std::vector<ChunkRecord> loaded(3);
+          load_chunked(data, memoryInput, loaded);
+          check_chunk_records(loaded, records);
+
+          // elements are loaded by older version
+          std::vector<ChunkRecordOld> loadedOld;
+          load_chunked(data, memoryInput, loadedOld);
+          BOOST_REQUIRE_EQUAL(loadedOld.size(), records.size());
+          for(std::size_t ii = 0; ii < size; ++ii) {
+            BOOST_CHECK_EQUAL(loadedOld[ii].key, records[ii].key);
+            BOOST_CHECK_EQUAL(loadedOld[ii].text, records[ii].text);
+          }
+        }
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( extendable_binary_parallel_chunks_field )
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  ChunkedMessage message;
+  message.before = random_value<std::int32_t>(gen);
+  message.records = random_chunk_records(gen, 50);
+  message.after = random_value<std::int32_t>(gen);
+
+  std::ostringstream os(std::ios::binary);
+  {
+    cereal::ExtendableBinaryOutputArchive oar(os);
+    oar(message);
+  }
+
+  {
+    std::istringstream is(os.str(), std::ios::binary);
+    cereal::ExtendableBinaryInputArchive iar(is);
+    ChunkedMessage loaded;
+    iar(loaded);
+    BOOST_CHECK_EQUAL(loaded.before, message.before);
+    check_chunk_records(loaded.records, message.records);
+    BOOST_CHECK_EQUAL(loaded.after, message.after);
+  }
+
+  // chunks are skipped as any other object
+  {
+    std::istringstream is(os.str(), std::ios::binary);
+    cereal::ExtendableBinaryInputArchive iar(is);
+    ChunkedMessageOmitted loaded;
+    iar(loaded);
+    BOOST_CHECK_EQUAL(loaded.before, message.before);
+    BOOST_CHECK_EQUAL(loaded.after, message.after);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( extendable_binary_parallel_loader )
+{
+  using Options = cereal::ExtendableBinaryOutputArchive::Options;
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  BOOST_CHECK(cereal::ParallelExtendableBinaryLoader().threads() >= 1u);
+  BOOST_CHECK_EQUAL(cereal::ParallelExtendableBinaryLoader(3).threads(), 3u);
+
+  for(auto const & options : {Options(), Options().bigEndian().lengthPrefixedObjects(true)}) {
+    for(std::size_t size : {std::size_t(0), std::size_t(1), std::size_t(100)}) {
+      auto const records = random_chunk_records(gen, size);
+      for(std::size_t chunkElements : {std::size_t(1), std::size_t(7), std::size_t(1000)}) {
+        auto const data = save_chunked(records, options, chunkElements, 4);
+        // more threads than chunks
+        for(unsigned threads : {1u, 4u, 200u}) {
+          cereal::ParallelExtendableBinaryLoader const loader(threads);
+
+          std::vector<ChunkRecord> loaded(3);
+          cereal::ExtendableBinaryInputArchive iar(data.data(), data.size());
+          loader(iar, loaded);
+          check_chunk_records(loaded, records);
+
+          std::istringstream is(data, std::ios::binary);
+          cereal::ExtendableBinaryInputArchive streamIar(is);
+          std::vector<ChunkRecordOld> loadedOld;
+          loader(streamIar, loadedOld);
+          BOOST_REQUIRE_EQUAL(loadedOld.size(), records.size());
+          for(std::size_t ii = 0; ii < size; ++ii)
+            BOOST_CHECK_EQUAL(loadedOld[ii].key, records[ii].key);
+        }
+      }
+    }
+  }
+
+  // chunks decoded in parallel as field of object
+  ChunkedMessage message;
+  message.records = random_chunk_records(gen, 50);
+  message.after = random_value<std::int32_t>(gen);
+  std::ostringstream os(std::ios::binary);
+  {
+    cereal::ExtendableBinaryOutputArchive oar(os);
+    oar(message);
+  }
+  auto const data = os.str();
+  cereal::ExtendableBinaryInputArchive iar(data.data(), data.size());
+  ChunkedMessage loaded;
+  iar(loaded);
+  check_chunk_records(loaded.records, message.records);
+  BOOST_CHECK_EQUAL(loaded.after, message.after);
+
+  // broken chunk is reported after all threads finish
+  std::vector<ChunkFailing> elements(40);
+  auto broken = save_chunked(elements, Options(), 3, 1);
+  broken.resize(broken.size() - 10);
+  std::vector<ChunkFailing> loadedBroken;
+  cereal::ExtendableBinaryInputArchive brokenIar(broken.data(), broken.size());
+  BOOST_CHECK_THROW(cereal::ParallelExtendableBinaryLoader(4)(brokenIar, loadedBroken), cereal::Exception);
+
+  // element failed loading on worker thread
+  std::vector<ChunkFailingLoad> keys(40);
+  for(std::size_t ii = 0; ii < keys.size(); ++ii)
+    keys[ii].key = ii;
+  auto const failing = save_chunked(keys, Options(), 3, 1);
+  std::vector<ChunkFailingLoad> loadedFailing;
+  cereal::ExtendableBinaryInputArchive failingIar(failing.data(), failing.size());
+  BOOST_CHECK_THROW(cereal::ParallelExtendableBinaryLoader(4)(failingIar, loadedFailing), std::logic_error);
+}
+
+BOOST_AUTO_TEST_CASE( extendable_binary_parallel_chunks_versions )
+{
+  // chunks with elements of different types add versions of their types to registry at once
+  std::vector<ChunkVersioned> elements(64);
+  for(std::size_t ii = 0; ii < elements.size(); ++ii) {
+    if(ii % 2 == 0) {
+      elements[ii].a.reset(new ChunkVersionedA);
+      elements[ii].a->value = static_cast<std::int32_t>(ii);
+    } else {
+      elements[ii].b.reset(new ChunkVersionedB);
+      elements[ii].b->value = static_cast<std::int32_t>(ii);
+    }
+  }
+  auto const data = save_chunked(elements, cereal::ExtendableBinaryOutputArchive::Options(), 1, 8);
+
+  std::vector<ChunkVersioned> loaded;
+  cereal::ExtendableBinaryInputArchive iar(data.data(), data.size());
+  cereal::ParallelExtendableBinaryLoader(8)(iar, loaded);
+  BOOST_REQUIRE_EQUAL(loaded.size(), elements.size());
+  for(std::size_t ii = 0; ii < elements.size(); ++ii) {
+    BOOST_REQUIRE_EQUAL(loaded[ii].a != nullptr, ii % 2 == 0);
+    BOOST_REQUIRE_EQUAL(loaded[ii].b != nullptr, ii % 2 == 1);
+    BOOST_CHECK_EQUAL(ii % 2 == 0 ? loaded[ii].a->value : loaded[ii].b->value, static_cast<std::int32_t>(ii));
+  }
+}
+
+BOOST_AUTO_TEST_CASE( extendable_binary_parallel_chunks_constructed )
+{
+  // elements without default constructor are decoded one chunk after another
+  std::vector<ChunkConstructed> elements;
+  for(std::int32_t ii = 0; ii < 50; ++ii)
+    elements.emplace_back(ii * 3);
+  auto const data = save_chunked(elements, cereal::ExtendableBinaryOutputArchive::Options(), 7, 4);
+
+  for(unsigned threads : {1u, 4u}) {
+    std::vector<ChunkConstructed> loaded(3, ChunkConstructed(-1));
+    cereal::ExtendableBinaryInputArchive iar(data.data(), data.size());
+    cereal::ParallelExtendableBinaryLoader const loader(threads);
+    loader(iar, loaded);
+    BOOST_REQUIRE_EQUAL(loaded.size(), elements.size());
+    for(std::size_t ii = 0; ii < elements.size(); ++ii)
+      BOOST_CHECK_EQUAL(loaded[ii].value, elements[ii].value);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( extendable_binary_parallel_chunks_exception )
+{
+  std::vector<ChunkFailing> failing(40);
+  for(std::size_t ii = 0; ii < failing.size(); ++ii)
+    failing[ii].key = ii;
+
+  std::ostringstream os(std::ios::binary);
+  cereal::ExtendableBinaryOutputArchive oar(os);
+  BOOST_CHECK_THROW(oar(cereal::make_parallel_chunks(failing, 3, 4)), std::runtime_error);
+}
@@ -0,0 +1,241 @@
+/*! \file extendable_binary_records.cpp
+    \brief Tests for files of extendable binary records with index
+    \ingroup tests */
+/*
+  Copyright (c) 2016, Michal Breiter
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT OR MICHAL BREITER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <cereal/archives/extendable_binary_records.hpp>
+#include <boost/test/unit_test.hpp>
+
+struct RecordBase
+{
+  virtual ~RecordBase() {}
+
+  std::int32_t id = 0;
+
+  template <class Archive>
+  void serialize(Archive & ar)
+  {
+    ar(id);
+  }
+};
+
+struct RecordDerived : RecordBase
+{
+  std::vector<std::uint8_t> payload;
+
+  template <class Archive>
+  void serialize(Archive & ar, std::uint32_t)
+  {
+    ar(cereal::base_class<RecordBase>(this), payload);
+  }
+};
+CEREAL_REGISTER_TYPE(RecordDerived)
+CEREAL_CLASS_VERSION(RecordDerived, 3)
+
+struct EventRecord
+{
+  std::uint64_t sequence = 0;
+  std::string text;
+  std::shared_ptr<RecordBase> shared;
+  std::shared_ptr<RecordBase> sameShared;
+
+  template <class Archive>
+  void serialize(Archive & ar, std::uint32_t)
+  {
+    ar(sequence, text, shared, sameShared);
+  }
+};
+
+//! Older version of EventRecord, doesn't know fields added later
+struct EventRecordOld
+{
+  std::uint64_t sequence = 0;
+  std::string text;
+
+  template <class Archive>
+  void serialize(Archive & ar, std::uint32_t)
+  {
+    ar(sequence, text);
+  }
+};
+
+//! Fails saving after data bigger than archive buffer was saved
+struct EventRecordFailing
+{
+  std::vector<std::uint8_t> payload = std::vector<std::uint8_t>(10000);
+
+  template <class Archive>
+  void save(Archive & ar) const
+  {
+    ar(payload);
+    throw std::runtime_error("failed");
+  }
+
+  template <class Archive>
+  void load(Archive &)
+  { }
+};
+
+EventRecord random_event_record(std::mt19937 & gen, std::uint64_t sequence)
+{
+  EventRecord r;
+  r.sequence = sequence;
+  r.text = random_basic_string<char>(gen);
+  auto derived = std::make_shared<RecordDerived>();
+  derived->id = random_value<std::int32_t>(gen);
+  derived->payload.resize(gen() % 100);
+  for(auto & b : derived->payload)
+    b = random_value<std::uint8_t>(gen);
+  r.shared = derived;
+  r.sameShared = derived;
+  return r;
+}
+
+void check_event_record(EventRecord const & loaded, EventRecord const & saved)
+{
+  BOOST_CHECK_EQUAL(loaded.sequence, saved.sequence);
+  BOOST_CHECK_EQUAL(loaded.text, saved.text);
+  auto const derived = std::dynamic_pointer_cast<RecordDerived>(loaded.shared);
+  BOOST_REQUIRE(derived != nullptr);
+  BOOST_CHECK(loaded.sameShared == loaded.shared);
+  BOOST_CHECK_EQUAL(derived->id, saved.shared->id);
+  BOOST_CHECK(derived->payload == std::static_pointer_cast<RecordDerived>(saved.shared)->payload);
+}
+
+std::string record_key(std::size_t index)
+{
+  return index % 3 == 0 ? "key" + std::to_string(index) : std::string();
+}
+
+BOOST_AUTO_TEST_CASE( extendable_binary_records )
+{
+  using Options = cereal::ExtendableBinaryOutputArchive::Options;
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  for(auto const & options : {Options(), Options().bigEndian().lengthPrefixedObjects(true), Options().compressIntegerArrays(true)}) {
+    std::vector<EventRecord> records;
+    for(std::size_t ii = 0; ii < 100; ++ii)
+      records.push_back(random_event_record(gen, ii));
+
+    // records don't have to start at beginning of stream
+    const std::string prefix = "prefix";
+    std::ostringstream os(std::ios::binary);
+    os << prefix;
+    {
+      cereal::ExtendableBinaryRecordWriter writer(os, options);
+      for(std::size_t ii = 0; ii < records.size(); ++ii) {
+        auto const key = record_key(ii);
+        BOOST_CHECK_EQUAL(key.empty() ? writer.write(records[ii]) : writer.write(key, records[ii]), ii);
+      }
+      BOOST_CHECK_EQUAL(writer.size(), records.size());
+      writer.finish();
+      BOOST_CHECK_THROW(writer.write(records[0]), cereal::Exception);
+    }
+    auto const data = os.str();
+
+    // every record is complete archive
+    {
+      cereal::ExtendableBinaryInputArchive iar(data.data() + prefix.size(), data.size() - prefix.size());
+      EventRecord first;
+      iar(first);
+      check_event_record(first, records[0]);
+    }
+
+    std::istringstream is(data, std::ios::binary);
+    is.seekg(static_cast<std::streamoff>(prefix.size()));
+    cereal::ExtendableBinaryRecordReader streamReader(is);
+    cereal::ExtendableBinaryRecordReader memoryReader(data.data() + prefix.size(), data.size() - prefix.size());
+    for(auto * reader : {&streamReader, &memoryReader}) {
+      BOOST_REQUIRE_EQUAL(reader->size(), records.size());
+      // records are read in any order
+      for(std::size_t jj = 0; jj < records.size(); ++jj) {
+        const std::size_t ii = (jj * 37) % records.size();
+        EventRecord loaded;
+        reader->read(ii, loaded);
+        check_event_record(loaded, records[ii]);
+        BOOST_CHECK_EQUAL(reader->key(ii), record_key(ii));
+        if(false == record_key(ii).empty())
+          BOOST_CHECK_EQUAL(reader->find(record_key(ii)), ii);
+
+        EventRecordOld loadedOld;
+        reader->read(ii, loadedOld);
+        BOOST_CHECK_EQUAL(loadedOld.sequence, records[ii].sequence);
+        BOOST_CHECK_EQUAL(loadedOld.text, records[ii].text);
+      }
+      BOOST_CHECK_EQUAL(reader->find("missing"), reader->size());
+      BOOST_CHECK_EQUAL(reader->find(""), reader->size());
+      EventRecord loaded;
+      BOOST_CHECK_THROW(reader->read(records.size(), loaded), cereal::Exception);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( extendable_binary_records_failed )
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  std::vector<EventRecord> records;
+  std::ostringstream os(std::ios::binary);
+  {
+    // index is written when writer is destroyed
+    cereal::ExtendableBinaryRecordWriter writer(os);
+    for(std::size_t ii = 0; ii < 10; ++ii) {
+      if(ii % 4 == 1)
+        BOOST_CHECK_THROW(writer.write(EventRecordFailing()), std::runtime_error);
+      records.push_back(random_event_record(gen, ii));
+      BOOST_CHECK_EQUAL(writer.write(records.back()), ii);
+    }
+  }
+  auto const data = os.str();
+
+  cereal::ExtendableBinaryRecordReader reader(data.data(), data.size());
+  BOOST_REQUIRE_EQUAL(reader.size(), records.size());
+  for(std::size_t ii = 0; ii < records.size(); ++ii) {
+    EventRecord loaded;
+    reader.read(ii, loaded);
+    check_event_record(loaded, records[ii]);
+    BOOST_CHECK(reader.key(ii).empty());
+  }
+
+  // empty file
+  std::ostringstream emptyOs(std::ios::binary);
+  cereal::ExtendableBinaryRecordWriter(emptyOs).finish();
+  auto const empty = emptyOs.str();
+  BOOST_CHECK_EQUAL(cereal::ExtendableBinaryRecordReader(empty.data(), empty.size()).size(), 0u);
+
+  // data without index
+  BOOST_CHECK_THROW(cereal::ExtendableBinaryRecordReader(data.data(), 4), cereal::Exception);
+  BOOST_CHECK_THROW(cereal::ExtendableBinaryRecordReader(data.data(), data.size() - 1), cereal::Exception);
+  std::string broken = data;
+  broken[broken.size() - 10] = '\x7f';
+  BOOST_CHECK_THROW(cereal::ExtendableBinaryRecordReader(broken.data(), broken.size()), cereal::Exception);
+  std::istringstream brokenIs(broken, std::ios::binary);
+  BOOST_CHECK_THROW(cereal::ExtendableBinaryRecordReader brokenReader(brokenIs), cereal::Exception);
+}
@@ -0,0 +1,292 @@
+/*! \file extendable_binary_reset.cpp
+    \brief Tests for reusing extendable binary archives for many messages
+    \ingroup tests */
+/*
+  Copyright (c) 2016, Michal Breiter
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT OR MICHAL BREITER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <boost/test/unit_test.hpp>
+
+struct ResetBase
+{
+  virtual ~ResetBase() {}
+
+  std::int32_t id = 0;
+
+  template <class Archive>
+  void serialize(Archive & ar)
+  {
+    ar(id);
+  }
+};
+
+struct ResetDerived : ResetBase
+{
+  std::vector<std::uint8_t> payload;
+
+  template <class Archive>
+  void serialize(Archive & ar, std::uint32_t)
+  {
+    ar(cereal::base_class<ResetBase>(this), payload);
+  }
+};
+CEREAL_REGISTER_TYPE(ResetDerived)
+CEREAL_CLASS_VERSION(ResetDerived, 2)
+
+struct ResetMessage
+{
+  std::string text;
+  std::shared_ptr<ResetBase> shared;
+  std::shared_ptr<ResetBase> sameShared;
+  std::unique_ptr<ResetBase> unique;
+
+  template <class Archive>
+  void serialize(Archive & ar, std::uint32_t)
+  {
+    ar(text, shared, sameShared, unique);
+  }
+};
+
+//! Message read by older application, shared pointer is skipped and loaded later
+struct ResetMessageOld
+{
+  std::string text;
+  std::shared_ptr<ResetBase> sameShared;
+
+  template <class Archive>
+  void serialize(Archive & ar, std::uint32_t)
+  {
+    ar(text, cereal::OmittedFieldTag(), sameShared);
+  }
+};
+
+//! Fails saving after part of its data was saved
+struct ResetFailing
+{
+  ResetMessage message;
+
+  template <class Archive>
+  void save(Archive & ar) const
+  {
+    ar(message);
+    throw std::runtime_error("failed");
+  }
+
+  template <class Archive>
+  void load(Archive &)
+  { }
+};
+
+ResetMessage random_reset_message(std::mt19937 & gen)
+{
+  ResetMessage m;
+  m.text = random_basic_string<char>(gen);
+  auto derived = std::make_shared<ResetDerived>();
+  derived->id = random_value<std::int32_t>(gen);
+  derived->payload.resize(gen() % 1000);
+  for(auto & b : derived->payload)
+    b = random_value<std::uint8_t>(gen);
+  m.shared = derived;
+  m.sameShared = derived;
+  std::unique_ptr<ResetDerived> unique(new ResetDerived);
+  unique->id = random_value<std::int32_t>(gen);
+  m.unique = std::move(unique);
+  return m;
+}
+
+template <class T>
+std::string save_fresh(T const & t, cereal::ExtendableBinaryOutputArchive::Options const & options)
+{
+  std::ostringstream os(std::ios::binary);
+  {
+    cereal::ExtendableBinaryOutputArchive oar(os, options);
+    oar(t);
+  }
+  return os.str();
+}
+
+void check_reset_message(ResetMessage const & loaded, ResetMessage const & saved)
+{
+  BOOST_CHECK_EQUAL(loaded.text, saved.text);
+  BOOST_REQUIRE(loaded.shared != nullptr);
+  BOOST_CHECK(loaded.shared == loaded.sameShared);
+  BOOST_CHECK_EQUAL(loaded.shared->id, saved.shared->id);
+  auto const loadedDerived = std::dynamic_pointer_cast<ResetDerived>(loaded.shared);
+  BOOST_REQUIRE(loadedDerived != nullptr);
+  BOOST_CHECK(loadedDerived->payload == std::static_pointer_cast<ResetDerived>(saved.shared)->payload);
+  BOOST_REQUIRE(loaded.unique != nullptr);
+  BOOST_CHECK_EQUAL(loaded.unique->id, saved.unique->id);
+}
+
+std::vector<cereal::ExtendableBinaryOutputArchive::Options> reset_options()
+{
+  using Options = cereal::ExtendableBinaryOutputArchive::Options;
+  return {Options(), Options().lengthPrefixedObjects(true), Options().bigEndian(), Options().littleEndian()};
+}
+
+BOOST_AUTO_TEST_CASE( extendable_binary_reset_output )
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  for(auto const & options : reset_options()) {
+    std::ostringstream first(std::ios::binary);
+    cereal::ExtendableBinaryOutputArchive oar(first, options);
+    // nothing refers to tracking of first message
+    oar(random_reset_message(gen));
+
+    for(int ii = 0; ii < 5; ++ii) {
+      auto const message = random_reset_message(gen);
+      std::ostringstream os(std::ios::binary);
+      oar.reset(os);
+      oar(message);
+      oar.flush();
+      BOOST_CHECK(os.str() == save_fresh(message, options));
+      BOOST_CHECK_EQUAL(oar.savedSize(), os.str().size());
+    }
+
+    // saving of previous message failed in the middle of object
+    ResetFailing failing;
+    failing.message = random_reset_message(gen);
+    std::ostringstream failed(std::ios::binary);
+    oar.reset(failed);
+    BOOST_CHECK_THROW(oar(failing), std::runtime_error);
+
+    auto const message = random_reset_message(gen);
+    std::ostringstream os(std::ios::binary);
+    oar.reset(os);
+    oar(message);
+    oar.flush();
+    BOOST_CHECK(os.str() == save_fresh(message, options));
+  }
+
+  cereal::ExtendableBinarySizingArchive sizing;
+  sizing(random_reset_message(gen));
+  auto const message = random_reset_message(gen);
+  sizing.reset();
+  sizing(message);
+  BOOST_CHECK_EQUAL(sizing.savedSize(), save_fresh(message, cereal::ExtendableBinaryOutputArchive::Options()).size());
+}
+
+BOOST_AUTO_TEST_CASE( extendable_binary_reset_input )
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  for(auto const & options : reset_options()) {
+    std::vector<ResetMessage> messages;
+    std::vector<std::string> saved;
+    for(int ii = 0; ii < 5; ++ii) {
+      messages.push_back(random_reset_message(gen));
+      saved.push_back(save_fresh(messages.back(), options));
+    }
+
+    // stream and memory buffer can be mixed
+    std::istringstream firstStream(saved[0], std::ios::binary);
+    cereal::ExtendableBinaryInputArchive iar(firstStream);
+    for(std::size_t ii = 0; ii < messages.size(); ++ii) {
+      std::istringstream is(saved[ii], std::ios::binary);
+      if(ii % 2 == 0)
+        iar.reset(saved[ii].data(), saved[ii].size());
+      else
+        iar.reset(is);
+      ResetMessage loaded;
+      iar(loaded);
+      check_reset_message(loaded, messages[ii]);
+    }
+
+    // loading of previous message failed, skipped shared data was kept
+    iar.reset(saved[0].data(), saved[0].size() / 2);
+    ResetMessageOld old;
+    BOOST_CHECK_THROW(iar(old), cereal::Exception);
+
+    for(std::size_t ii = 0; ii < messages.size(); ++ii) {
+      iar.reset(saved[ii].data(), saved[ii].size());
+      ResetMessageOld loaded;
+      iar(loaded);
+      BOOST_CHECK_EQUAL(loaded.text, messages[ii].text);
+      BOOST_REQUIRE(loaded.sameShared != nullptr);
+      BOOST_CHECK_EQUAL(loaded.sameShared->id, messages[ii].sameShared->id);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( extendable_binary_archive_pool )
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  using OutputPool = cereal::ExtendableBinaryArchivePool<cereal::ExtendableBinaryOutputArchive>;
+  using InputPool = cereal::ExtendableBinaryArchivePool<cereal::ExtendableBinaryInputArchive>;
+  auto const options = cereal::ExtendableBinaryOutputArchive::Options().lengthPrefixedObjects(true);
+  OutputPool outputPool(options);
+  InputPool inputPool;
+
+  std::vector<ResetMessage> messages;
+  std::vector<std::string> saved;
+  for(int ii = 0; ii < 3; ++ii) {
+    messages.push_back(random_reset_message(gen));
+    std::ostringstream os(std::ios::binary);
+    {
+      auto oar = outputPool.acquire(os);
+      oar(messages.back());
+      // nested message uses other archive
+      std::ostringstream nested(std::ios::binary);
+      {
+        auto nestedOar = outputPool.acquire(nested);
+        BOOST_CHECK(&*nestedOar != &*oar);
+        nestedOar(messages.back());
+      }
+      BOOST_CHECK(nested.str() == save_fresh(messages.back(), options));
+    }
+    // data is written when archive is returned
+    saved.push_back(os.str());
+    BOOST_CHECK(saved.back() == save_fresh(messages.back(), options));
+    BOOST_CHECK_EQUAL(outputPool.size(), 2u);
+  }
+
+  for(std::size_t ii = 0; ii < messages.size(); ++ii) {
+    ResetMessage loaded;
+    if(ii % 2 == 0) {
+      inputPool.acquire(saved[ii].data(), saved[ii].size())(loaded);
+    } else {
+      std::istringstream is(saved[ii], std::ios::binary);
+      inputPool.acquire(is)(loaded);
+    }
+    check_reset_message(loaded, messages[ii]);
+    BOOST_CHECK_EQUAL(inputPool.size(), 1u);
+  }
+
+  // archive is kept in pool when header cannot be loaded
+  BOOST_CHECK_THROW(inputPool.acquire(saved[0].data(), 0), cereal::Exception);
+  BOOST_CHECK_EQUAL(inputPool.size(), 1u);
+
+  auto & local = cereal::thread_local_archive_pool<cereal::ExtendableBinaryOutputArchive>();
+  BOOST_CHECK(&local == &cereal::thread_local_archive_pool<cereal::ExtendableBinaryOutputArchive>());
+  std::ostringstream os(std::ios::binary);
+  local.acquire(os)(messages[0]);
+  BOOST_CHECK(os.str() == save_fresh(messages[0], cereal::ExtendableBinaryOutputArchive::Options()));
+}
@@ -0,0 +1,161 @@
+/*! \file extendable_binary_sizing.cpp
+    \brief Tests for computing size of data saved by extendable binary archive
+    \ingroup tests */
+/*
+  Copyright (c) 2016, Michal Breiter
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT OR MICHAL BREITER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "common.hpp"
+#include <boost/test/unit_test.hpp>
+
+struct SizingBase
+{
+  virtual ~SizingBase() {}
+
+  std::string name;
+
+  template <class Archive>
+  void serialize(Archive & ar)
+  {
+    ar(name);
+  }
+};
+
+struct SizingDerived : SizingBase
+{
+  std::vector<std::int16_t> values;
+
+  template <class Archive>
+  void serialize(Archive & ar, std::uint32_t)
+  {
+    ar(cereal::base_class<SizingBase>(this), values);
+  }
+};
+CEREAL_REGISTER_TYPE(SizingDerived)
+CEREAL_CLASS_VERSION(SizingDerived, 3)
+
+struct SizingMessage
+{
+  std::int64_t id;
+  std::string text;
+  std::vector<double> samples;
+  std::vector<std::uint32_t> counters;
+  std::map<std::int32_t, std::string> names;
+  std::vector<bool> flags;
+  std::shared_ptr<SizingBase> shared;
+  std::shared_ptr<SizingBase> sameShared;
+  std::unique_ptr<SizingBase> unique;
+
+  template <class Archive>
+  void serialize(Archive & ar)
+  {
+    ar(id, text, samples, counters, names, flags, shared, sameShared, unique);
+  }
+};
+
+std::unique_ptr<SizingMessage> random_message(std::mt19937 & gen, std::size_t samples)
+{
+  std::unique_ptr<SizingMessage> m(new SizingMessage);
+  m->id = random_value<std::int64_t>(gen);
+  m->text = random_value<std::string>(gen);
+  for (std::size_t i = 0; i < samples; ++i) {
+    m->samples.push_back(random_value<double>(gen));
+    m->counters.push_back(random_value<std::uint32_t>(gen) % 1000);
+    m->flags.push_back(random_value<std::uint8_t>(gen) % 2 == 0);
+  }
+  for (std::int32_t i = 0; i < 20; ++i)
+    m->names[i * 3] = random_value<std::string>(gen);
+  auto derived = std::make_shared<SizingDerived>();
+  derived->name = random_value<std::string>(gen);
+  derived->values.assign(samples % 50, random_value<std::int16_t>(gen));
+  m->shared = derived;
+  m->sameShared = derived;
+  m->unique.reset(new SizingDerived(*derived));
+  return m;
+}
+
+BOOST_AUTO_TEST_CASE( extendable_binary_sizing )
+{
+  using Options = cereal::ExtendableBinaryOutputArchive::Options;
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  const std::vector<Options> options = {
+      Options().littleEndian(), Options().bigEndian(),
+      Options().bigEndian().lengthPrefixedObjects(true),
+      Options().lengthPrefixedObjects(true).compressIntegerArrays(true).deltaEncodedKeys(true).packedBits(true)};
+
+  for (auto const & option : options) {
+    // small message and message with payloads bigger than write buffer
+    for (std::size_t samples : {std::size_t(3), std::size_t(5000)}) {
+      const auto message = random_message(gen, samples);
+
+      std::ostringstream os;
+      {
+        cereal::ExtendableBinaryOutputArchive oar(os, option);
+        oar(*message);
+      }
+      BOOST_CHECK_EQUAL(cereal::encoded_size<cereal::ExtendableBinaryOutputArchive>(*message, option), os.str().size());
+
+      // the same archive used for more objects, shared and polymorphic data is saved once
+      std::ostringstream osMany;
+      cereal::ExtendableBinarySizingArchive sizing(option);
+      {
+        cereal::ExtendableBinaryOutputArchive oar(osMany, option);
+        for (int i = 0; i < 3; ++i) {
+          oar(*message);
+          sizing(*message);
+          BOOST_CHECK_EQUAL(sizing.savedSize(), oar.savedSize());
+        }
+      }
+      BOOST_CHECK_EQUAL(sizing.savedSize(), osMany.str().size());
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( extendable_binary_sizing_varint )
+{
+  namespace ebd = cereal::extendable_binary_detail;
+
+  std::vector<std::uint64_t> values = {0, std::numeric_limits<std::uint64_t>::max()};
+  for (int bits = 1; bits < 64; ++bits) {
+    values.push_back((std::uint64_t(1) << bits) - 1);
+    values.push_back(std::uint64_t(1) << bits);
+  }
+
+  for (auto const value : values) {
+    std::uint8_t data[ebd::maxVarintSize];
+    BOOST_CHECK_EQUAL(ebd::encodedVarintSize(value), ebd::encodeVarint(value, data));
+
+    // counted size of integers saved as varints
+    const auto pair = std::make_pair(value, static_cast<std::int64_t>(value));
+    std::ostringstream os;
+    {
+      cereal::ExtendableBinaryOutputArchive oar(os);
+      oar(pair);
+    }
+    BOOST_CHECK_EQUAL(cereal::encoded_size<cereal::ExtendableBinaryOutputArchive>(pair), os.str().size());
+  }
+}
@@ -279,4 +279,102 @@ BOOST_AUTO_TEST_CASE( json_memory_load_construct )
 BOOST_AUTO_TEST_CASE( extendable_binary_memory_load_construct )
 {
   test_memory_load_construct<cereal::ExtendableBinaryInputArchive, cereal::ExtendableBinaryOutputArchive>();
-}
\ No newline at end of file
+}
+
+template <class IArchive, class OArchive>
+void test_container_load_construct()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  for(int ii=0; ii<100; ++ii)
+  {
+    std::vector<OneLA> o_vector;
+    std::deque<TwoLA> o_deque;
+    std::list<OneLAVersioned> o_list;
+    std::forward_list<TwoLAVersioned> o_forward_list;
+    std::map<int, OneLA> o_map;
+    std::unordered_map<std::string, TwoLAVersioned> o_unordered_map;
+    for( int i = 0; i < 10; ++i )
+    {
+      o_vector.emplace_back( random_value<int>(gen) );
+      o_deque.emplace_back( random_value<int>(gen) );
+      o_list.emplace_back( random_value<int>(gen) );
+      o_forward_list.emplace_front( random_value<int>(gen) );
+      o_map.emplace( random_value<int>(gen), OneLA( random_value<int>(gen) ) );
+      o_unordered_map.emplace( random_basic_string<char>(gen), TwoLAVersioned( random_value<int>(gen) ) );
+    }
+
+    std::ostringstream os;
+    {
+      OArchive oar(os);
+
+      oar( o_vector );
+      oar( o_deque );
+      oar( o_list );
+      oar( o_forward_list );
+      oar( o_map );
+      oar( o_unordered_map );
+    }
+
+    decltype(o_vector) i_vector{ OneLA( 1 ) };
+    decltype(o_deque) i_deque;
+    decltype(o_list) i_list;
+    decltype(o_forward_list) i_forward_list;
+    decltype(o_map) i_map;
+    decltype(o_unordered_map) i_unordered_map;
+
+    std::istringstream is(os.str());
+    {
+      IArchive iar(is);
+
+      iar( i_vector );
+      iar( i_deque );
+      iar( i_list );
+      iar( i_forward_list );
+      iar( i_map );
+      iar( i_unordered_map );
+    }
+
+    BOOST_CHECK( i_vector == o_vector );
+    BOOST_CHECK( i_deque == o_deque );
+    BOOST_CHECK( i_list == o_list );
+    BOOST_CHECK( i_forward_list == o_forward_list );
+    for( auto const & i : i_list )
+      BOOST_CHECK_EQUAL( i.v, 13u );
+    for( auto const & i : i_forward_list )
+      BOOST_CHECK_EQUAL( i.v, 1u );
+
+    BOOST_CHECK_EQUAL( i_map.size(), o_map.size() );
+    for( auto const & o : o_map )
+      BOOST_CHECK_EQUAL( i_map.at( o.first ), o.second );
+    BOOST_CHECK_EQUAL( i_unordered_map.size(), o_unordered_map.size() );
+    for( auto const & o : o_unordered_map )
+      BOOST_CHECK_EQUAL( i_unordered_map.at( o.first ), o.second );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( binary_container_load_construct )
+{
+  test_container_load_construct<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( portable_binary_container_load_construct )
+{
+  test_container_load_construct<cereal::PortableBinaryInputArchive, cereal::PortableBinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( xml_container_load_construct )
+{
+  test_container_load_construct<cereal::XMLInputArchive, cereal::XMLOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( json_container_load_construct )
+{
+  test_container_load_construct<cereal::JSONInputArchive, cereal::JSONOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( extendable_binary_container_load_construct )
+{
+  test_container_load_construct<cereal::ExtendableBinaryInputArchive, cereal::ExtendableBinaryOutputArchive>();
+}
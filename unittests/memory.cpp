@@ -104,6 +104,73 @@ BOOST_AUTO_TEST_CASE( extendable_binary_memory )
   test_memory<cereal::ExtendableBinaryInputArchive, cereal::ExtendableBinaryOutputArchive>();
 }
 
+template <class IArchive, class OArchive>
+void test_memory_reset_tracking()
+{
+  std::vector<std::shared_ptr<int>> o_ptrs;
+  for(int ii=0; ii<2000; ++ii)
+    o_ptrs.push_back(ii % 3 ? o_ptrs.back() : std::make_shared<int>(ii));
+
+  std::ostringstream os;
+  {
+    OArchive oar(os);
+    oar.reserveSharedPointers(o_ptrs.size());
+    oar( o_ptrs );
+    // pointers saved after reset don't refer to ones saved before
+    oar.resetTracking();
+    oar( o_ptrs[0], o_ptrs[1] );
+  }
+
+  std::vector<std::shared_ptr<int>> i_ptrs;
+  std::shared_ptr<int> i_first1;
+  std::shared_ptr<int> i_first2;
+  std::istringstream is(os.str());
+  {
+    IArchive iar(is);
+    iar.reserveSharedPointers(o_ptrs.size());
+    iar( i_ptrs );
+    iar.resetTracking();
+    iar( i_first1, i_first2 );
+  }
+
+  BOOST_REQUIRE_EQUAL(i_ptrs.size(), o_ptrs.size());
+  for(std::size_t ii=0; ii<i_ptrs.size(); ++ii)
+  {
+    BOOST_CHECK_EQUAL(*i_ptrs[ii], *o_ptrs[ii]);
+    if(ii % 3)
+      BOOST_CHECK_EQUAL(i_ptrs[ii].get(), i_ptrs[ii-1].get());
+  }
+
+  BOOST_CHECK_EQUAL(*i_first1, *o_ptrs[0]);
+  BOOST_CHECK_EQUAL(i_first1.get(), i_first2.get());
+  BOOST_CHECK_NE(i_first1.get(), i_ptrs[0].get());
+}
+
+BOOST_AUTO_TEST_CASE( binary_memory_reset_tracking )
+{
+  test_memory_reset_tracking<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( portable_binary_memory_reset_tracking )
+{
+  test_memory_reset_tracking<cereal::PortableBinaryInputArchive, cereal::PortableBinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( memory_registered_null_pointer )
+{
+  std::istringstream is;
+  cereal::BinaryInputArchive iar(is);
+
+  // pointer registered as null is found, id not registered is not
+  for(std::uint32_t id : {1u, 2u, 5000u})
+  {
+    iar.registerSharedPointer(id | cereal::detail::msb_32bit, std::shared_ptr<void>());
+    BOOST_CHECK(iar.getSharedPointer(id) == nullptr);
+  }
+  BOOST_CHECK_THROW(iar.getSharedPointer(3), cereal::Exception);
+  BOOST_CHECK_THROW(iar.getSharedPointer(4999), cereal::Exception);
+}
+
 class TestClass
 {
   public:
@@ -360,6 +360,41 @@ BOOST_AUTO_TEST_CASE( extendable_binary_polymorphic )
   test_polymorphic<cereal::ExtendableBinaryInputArchive, cereal::ExtendableBinaryOutputArchive>();
 }
 
+struct PolyPathBase
+{
+  virtual ~PolyPathBase() = default;
+};
+
+struct PolyPathMiddle : PolyPathBase {};
+struct PolyPathDerived : PolyPathMiddle {};
+
+BOOST_AUTO_TEST_CASE( polymorphic_caster_paths )
+{
+  using cereal::detail::PolymorphicCasters;
+  using cereal::detail::PolymorphicVirtualCaster;
+  auto notFound = [](){ throw cereal::Exception("path not found"); };
+
+  // relations are registered after lookups, casters live until exit as registered ones do
+  static PolymorphicVirtualCaster<PolyPathBase, PolyPathMiddle> baseMiddle;
+  auto const & before = PolymorphicCasters::lookup( typeid(PolyPathBase), typeid(PolyPathMiddle), notFound );
+  BOOST_REQUIRE_EQUAL( before.size(), 1u );
+  auto const first = before.begin();
+
+  // new relation and chained path don't touch paths found before
+  static PolymorphicVirtualCaster<PolyPathMiddle, PolyPathDerived> middleDerived;
+  BOOST_CHECK( *first == &baseMiddle );
+  auto const & after = PolymorphicCasters::lookup( typeid(PolyPathBase), typeid(PolyPathMiddle), notFound );
+  BOOST_CHECK_EQUAL( &after, &before );
+
+  auto const & chained = PolymorphicCasters::lookup( typeid(PolyPathBase), typeid(PolyPathDerived), notFound );
+  BOOST_REQUIRE_EQUAL( chained.size(), 2u );
+  BOOST_CHECK( chained[0] == &baseMiddle );
+  BOOST_CHECK( chained[1] == &middleDerived );
+
+  PolyPathDerived derived;
+  BOOST_CHECK_EQUAL( PolymorphicCasters::upcast( &derived, typeid(PolyPathBase) ), static_cast<PolyPathBase *>( &derived ) );
+}
+
 #if CEREAL_THREAD_SAFE
 template <class IArchive, class OArchive>
 void test_polymorphic_threading()
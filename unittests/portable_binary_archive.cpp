@@ -253,5 +253,58 @@ BOOST_AUTO_TEST_CASE( portable_binary_archive_default_behavior )
   }
 }
 
+template <class T>
+void test_packed_array_swap( std::mt19937 & gen )
+{
+  // lengths not multiple of vector register size check swapping of remaining elements
+  for( std::size_t size : {0, 1, 3, 7, 8, 15, 16, 17, 31, 33, 1000, 3001} )
+  {
+    std::vector<T> o_vector(size);
+    for( auto & elem : o_vector )
+      elem = random_value<T>(gen);
+
+    std::vector<T> swapped(o_vector);
+    cereal::detail::swap_bytes_inplace<sizeof(T)>( swapped.data(), swapped.size() );
+    for( std::size_t i = 0; i < size; ++i )
+    {
+      T expected = o_vector[i];
+      swapBytes(expected);
+      BOOST_CHECK( std::memcmp( &expected, &swapped[i], sizeof(T) ) == 0 );
+    }
+
+    for( auto saveLittle : {true, false} )
+    {
+      std::ostringstream os;
+      {
+        cereal::PortableBinaryOutputArchive oar(os, saveLittle ? cereal::PortableBinaryOutputArchive::Options::LittleEndian()
+                                                               : cereal::PortableBinaryOutputArchive::Options::BigEndian());
+        oar( o_vector );
+      }
+
+      std::vector<T> i_vector;
+      std::istringstream is(os.str());
+      {
+        cereal::PortableBinaryInputArchive iar(is);
+        iar( i_vector );
+      }
+
+      BOOST_REQUIRE_EQUAL( i_vector.size(), o_vector.size() );
+      BOOST_CHECK( std::memcmp( i_vector.data(), o_vector.data(), size * sizeof(T) ) == 0 );
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( portable_binary_archive_packed_array_swap )
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  test_packed_array_swap<std::uint16_t>( gen );
+  test_packed_array_swap<std::int32_t>( gen );
+  test_packed_array_swap<std::uint64_t>( gen );
+  test_packed_array_swap<float>( gen );
+  test_packed_array_swap<double>( gen );
+}
+
 #undef CEREAl_TEST_SWAP_DATA
 #undef CEREAL_TEST_CHECK_EQUAL
@@ -28,6 +28,7 @@
   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 #include <cereal/types/memory.hpp>
+#include <cereal/types/vector.hpp>
 
 #include <cereal/archives/extendable_binary.hpp>
 #include <boost/test/unit_test.hpp>
@@ -66,7 +67,21 @@ struct DerivedPolymorphic : public PolymorphicBase
   }
 };
 
+struct OtherDerivedPolymorphic : public PolymorphicBase
+{
+  OtherDerivedPolymorphic() {}
+  OtherDerivedPolymorphic(int internalX_, int internalY_) :
+      PolymorphicBase(internalX_, internalY_)
+  {}
+
+  template <class Archive>
+  void serialize(Archive& ar) {
+    ar(cereal::base_class<PolymorphicBase>(this));
+  }
+};
+
 CEREAL_REGISTER_TYPE(DerivedPolymorphic)
+CEREAL_REGISTER_TYPE(OtherDerivedPolymorphic)
 
 template <class IArchive, class OArchive>
 void test_unknown_polymorphic_pointers()
@@ -116,3 +131,57 @@ BOOST_AUTO_TEST_CASE( extendable_binary_unknown_polymorpic_pointer )
 {
   test_unknown_polymorphic_pointers<cereal::ExtendableBinaryInputArchive, cereal::ExtendableBinaryOutputArchive>();
 }
+
+template <class IArchive, class OArchive>
+void test_unknown_polymorphic_pointers_repeated()
+{
+  std::vector<std::unique_ptr<PolymorphicBase>> o_ptrs;
+  for(int i = 0; i < 8; ++i)
+  {
+    if(i % 2)
+      o_ptrs.emplace_back(new DerivedPolymorphic(i, i + 1, i + 2));
+    else
+      o_ptrs.emplace_back(new OtherDerivedPolymorphic(i, i + 1));
+  }
+
+  std::ostringstream os(std::ios::binary);
+  {
+    OArchive oar(os);
+    oar(o_ptrs);
+  }
+
+  // name is saved only once, later pointers refer to it by id
+  std::string changed = os.str();
+  std::string typeName = "DerivedPolymorphic";
+  const auto found = changed.find("\x12" + typeName);
+  BOOST_REQUIRE_NE(found, std::string::npos);
+  BOOST_CHECK_EQUAL(changed.find(typeName, found + typeName.size()), std::string::npos);
+  changed.replace(found + 1, typeName.size(), "dERIVEDpOLYMORPHIC");
+
+  std::vector<std::unique_ptr<PolymorphicBase>> i_ptrs;
+  std::istringstream is(changed, std::ios::binary);
+  {
+    IArchive iar(is);
+    iar(i_ptrs);
+  }
+
+  BOOST_REQUIRE_EQUAL(i_ptrs.size(), o_ptrs.size());
+  for(std::size_t i = 0; i < i_ptrs.size(); ++i)
+  {
+    if(i % 2)
+    {
+      BOOST_CHECK(nullptr == i_ptrs[i]);
+    }
+    else
+    {
+      BOOST_REQUIRE(nullptr != dynamic_cast<OtherDerivedPolymorphic*>(i_ptrs[i].get()));
+      BOOST_CHECK_EQUAL(i_ptrs[i]->x, o_ptrs[i]->x);
+      BOOST_CHECK_EQUAL(i_ptrs[i]->y, o_ptrs[i]->y);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( extendable_binary_unknown_polymorpic_pointer_repeated )
+{
+  test_unknown_polymorphic_pointers_repeated<cereal::ExtendableBinaryInputArchive, cereal::ExtendableBinaryOutputArchive>();
+}
@@ -135,3 +135,173 @@ BOOST_AUTO_TEST_CASE( json_user_data_adapters )
   test_user_data_adapters<cereal::JSONInputArchive, cereal::JSONOutputArchive>();
 }
 
+
+#if CEREAL_HAS_PMR
+//! Counts allocations from a memory resource
+class CountingResource : public std::pmr::memory_resource
+{
+  public:
+    std::size_t allocated = 0;
+    std::size_t deallocated = 0;
+
+  private:
+    void * do_allocate( std::size_t bytes, std::size_t alignment ) override
+    {
+      ++allocated;
+      return std::pmr::new_delete_resource()->allocate( bytes, alignment );
+    }
+
+    void do_deallocate( void * p, std::size_t bytes, std::size_t alignment ) override
+    {
+      ++deallocated;
+      std::pmr::new_delete_resource()->deallocate( p, bytes, alignment );
+    }
+
+    bool do_is_equal( std::pmr::memory_resource const & other ) const noexcept override
+    {
+      return this == &other;
+    }
+};
+
+struct ResourceLA
+{
+  ResourceLA( int xx ) : x( xx ) {}
+
+  int x;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( x ); }
+
+  template <class Archive>
+  static void load_and_construct( Archive & ar, cereal::construct<ResourceLA> & construct )
+  {
+    int xx;
+    ar( xx );
+    construct( xx );
+  }
+};
+
+template <class IArchive, class OArchive>
+void test_memory_resource_adapters()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  std::pmr::vector<std::pmr::string> o_vector;
+  std::pmr::map<std::pmr::string, std::pmr::vector<std::pmr::string>> o_map;
+  std::pmr::unordered_set<std::pmr::string> o_set;
+  for( int i = 0; i < 10; ++i )
+  {
+    o_vector.emplace_back( std::string( 64, 'a' ) + random_basic_string<char>(gen) );
+    o_map[std::pmr::string( std::string( 64, 'b' ) + random_basic_string<char>(gen) )].emplace_back( std::string( 64, 'c' ) );
+    o_set.emplace( std::string( 64, 'd' ) + random_basic_string<char>(gen) );
+  }
+  auto o_shared = std::make_shared<StructInternalSerialize>( random_value<int>(gen), random_value<int>(gen) );
+  std::unique_ptr<StructInternalSerialize, cereal::memory_resource_delete<StructInternalSerialize>> o_unique( new StructInternalSerialize( random_value<int>(gen), random_value<int>(gen) ) );
+  auto o_sharedLA = std::make_shared<ResourceLA>( random_value<int>(gen) );
+  std::unique_ptr<ResourceLA, cereal::memory_resource_delete<ResourceLA>> o_uniqueLA( new ResourceLA( random_value<int>(gen) ) );
+
+  std::ostringstream os;
+  {
+    OArchive oar(os);
+    oar( o_vector, o_map, o_set );
+    oar( o_shared, o_unique, o_sharedLA, o_uniqueLA );
+    oar( o_unique, o_uniqueLA );
+    BOOST_CHECK( cereal::get_memory_resource( oar ) == nullptr );
+  }
+
+  CountingResource resource;
+  {
+    std::pmr::vector<std::pmr::string> i_vector( &resource );
+    std::pmr::map<std::pmr::string, std::pmr::vector<std::pmr::string>> i_map( &resource );
+    std::pmr::unordered_set<std::pmr::string> i_set( &resource );
+    std::shared_ptr<StructInternalSerialize> i_shared;
+    decltype(o_unique) i_unique;
+    std::shared_ptr<ResourceLA> i_sharedLA;
+    decltype(o_uniqueLA) i_uniqueLA;
+    decltype(o_unique) i_heapUnique;
+    decltype(o_uniqueLA) i_heapUniqueLA;
+
+    std::istringstream is(os.str());
+    {
+      cereal::MemoryResourceAdapter<IArchive> iar( resource, is );
+      iar( i_vector, i_map, i_set );
+      iar( i_shared, i_unique, i_sharedLA, i_uniqueLA );
+
+      // serialization functions only see the wrapped archive type
+      IArchive & plain = iar;
+      BOOST_CHECK( cereal::get_memory_resource( plain ) == &resource );
+    }
+    {
+      std::istringstream is2(os.str());
+      IArchive iar( is2 );
+      BOOST_CHECK( cereal::get_memory_resource( iar ) == nullptr );
+      decltype(i_vector) skipVector;
+      decltype(i_map) skipMap;
+      decltype(i_set) skipSet;
+      std::shared_ptr<StructInternalSerialize> skipShared;
+      decltype(o_unique) skipUnique;
+      std::shared_ptr<ResourceLA> skipSharedLA;
+      decltype(o_uniqueLA) skipUniqueLA;
+      iar( skipVector, skipMap, skipSet );
+      iar( skipShared, skipUnique, skipSharedLA, skipUniqueLA );
+      iar( i_heapUnique, i_heapUniqueLA );
+    }
+
+    BOOST_CHECK( i_vector == o_vector );
+    BOOST_CHECK( i_map == o_map );
+    BOOST_CHECK( i_set == o_set );
+    for( auto const & s : i_vector )
+      BOOST_CHECK( s.get_allocator().resource() == &resource );
+    for( auto const & i : i_map )
+    {
+      BOOST_CHECK( i.first.get_allocator().resource() == &resource );
+      for( auto const & s : i.second )
+        BOOST_CHECK( s.get_allocator().resource() == &resource );
+    }
+    for( auto const & s : i_set )
+      BOOST_CHECK( s.get_allocator().resource() == &resource );
+
+    BOOST_CHECK_EQUAL( *i_shared, *o_shared );
+    BOOST_CHECK_EQUAL( *i_unique, *o_unique );
+    BOOST_CHECK_EQUAL( i_sharedLA->x, o_sharedLA->x );
+    BOOST_CHECK_EQUAL( i_uniqueLA->x, o_uniqueLA->x );
+    BOOST_CHECK( i_unique.get_deleter().resource == &resource );
+    BOOST_CHECK( i_uniqueLA.get_deleter().resource == &resource );
+
+    BOOST_CHECK_EQUAL( *i_heapUnique, *o_unique );
+    BOOST_CHECK_EQUAL( i_heapUniqueLA->x, o_uniqueLA->x );
+    BOOST_CHECK( i_heapUnique.get_deleter().resource == nullptr );
+    BOOST_CHECK( i_heapUniqueLA.get_deleter().resource == nullptr );
+
+    BOOST_CHECK_GT( resource.allocated, resource.deallocated );
+  }
+  BOOST_CHECK_EQUAL( resource.allocated, resource.deallocated );
+}
+
+BOOST_AUTO_TEST_CASE( binary_memory_resource_adapters )
+{
+  test_memory_resource_adapters<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( portable_binary_memory_resource_adapters )
+{
+  test_memory_resource_adapters<cereal::PortableBinaryInputArchive, cereal::PortableBinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( xml_memory_resource_adapters )
+{
+  test_memory_resource_adapters<cereal::XMLInputArchive, cereal::XMLOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( json_memory_resource_adapters )
+{
+  test_memory_resource_adapters<cereal::JSONInputArchive, cereal::JSONOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( extendable_binary_memory_resource_adapters )
+{
+  test_memory_resource_adapters<cereal::ExtendableBinaryInputArchive, cereal::ExtendableBinaryOutputArchive>();
+}
+#endif // CEREAL_HAS_PMR
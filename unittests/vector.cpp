@@ -130,3 +130,46 @@ BOOST_AUTO_TEST_CASE( extendable_binary_vector )
 {
   test_vector<cereal::ExtendableBinaryInputArchive, cereal::ExtendableBinaryOutputArchive>();
 }
+
+//! Saved in the same way as std::vector, with hostile size followed by one element
+template <class T>
+struct HostileSizeVector
+{
+  template <class Archive>
+  void save(Archive & ar) const
+  {
+    ar( cereal::make_size_tag( static_cast<cereal::size_type>( 1ull << 40 ) ) );
+    ar( T() );
+  }
+};
+
+template <class IArchive, class OArchive, class T>
+void test_hostile_size()
+{
+  std::ostringstream os;
+  {
+    OArchive oar(os);
+    oar( HostileSizeVector<T>() );
+  }
+
+  std::vector<T> i_vector;
+  std::istringstream is(os.str());
+  IArchive iar(is);
+  BOOST_CHECK_THROW( iar( i_vector ), cereal::Exception );
+  BOOST_CHECK_LE( i_vector.capacity() * sizeof(T), std::size_t( CEREAL_RESERVE_LIMIT ) );
+}
+
+BOOST_AUTO_TEST_CASE( binary_vector_hostile_size )
+{
+  test_hostile_size<cereal::BinaryInputArchive, cereal::BinaryOutputArchive, StructInternalSerialize>();
+  test_hostile_size<cereal::BinaryInputArchive, cereal::BinaryOutputArchive, std::string>();
+  test_hostile_size<cereal::BinaryInputArchive, cereal::BinaryOutputArchive, bool>();
+}
+
+BOOST_AUTO_TEST_CASE( extendable_binary_vector_hostile_size )
+{
+  test_hostile_size<cereal::ExtendableBinaryInputArchive, cereal::ExtendableBinaryOutputArchive, StructInternalSerialize>();
+  test_hostile_size<cereal::ExtendableBinaryInputArchive, cereal::ExtendableBinaryOutputArchive, std::string>();
+  test_hostile_size<cereal::ExtendableBinaryInputArchive, cereal::ExtendableBinaryOutputArchive, bool>();
+  test_hostile_size<cereal::ExtendableBinaryInputArchive, cereal::ExtendableBinaryOutputArchive, std::chrono::system_clock::time_point>();
+}
@@ -217,6 +217,107 @@ BOOST_AUTO_TEST_CASE( extendable_binary_versioning )
   test_versioning<cereal::ExtendableBinaryInputArchive, cereal::ExtendableBinaryOutputArchive>();
 }
 
+struct VersionStructCached
+{
+  int x;
+  mutable std::uint32_t savedVersion;
+  std::uint32_t loadedVersion;
+
+  template <class Archive>
+  void save( Archive & ar, std::uint32_t const version ) const
+  {
+    ar( x );
+    savedVersion = version;
+  }
+
+  template <class Archive>
+  void load( Archive & ar, std::uint32_t const version )
+  {
+    ar( x );
+    loadedVersion = version;
+  }
+};
+
+CEREAL_CLASS_VERSION( VersionStructCached, 7 )
+
+template <class IArchive, class OArchive>
+void test_versioning_cached()
+{
+  VersionStructCached o_first{1, 0, 0};
+  VersionStructCached o_repeated{2, 0, 0};
+  VersionStructCached o_next{3, 0, 0};
+
+  std::ostringstream os;
+  std::ostringstream os2;
+  {
+    OArchive oar(os);
+    // version is looked up on first use and then taken from cache
+    oar( o_first );
+    oar( o_repeated );
+  }
+  {
+    OArchive oar(os2);
+    oar( o_next );
+  }
+
+  BOOST_CHECK_EQUAL( o_first.savedVersion, 7u );
+  BOOST_CHECK_EQUAL( o_repeated.savedVersion, 7u );
+  BOOST_CHECK_EQUAL( o_next.savedVersion, 7u );
+
+  // cached version matches the registry
+  auto const & versions = cereal::detail::StaticObject<cereal::detail::Versions>::getInstance();
+  auto const registered = versions.mapping.find( std::type_index(typeid(VersionStructCached)).hash_code() );
+  BOOST_REQUIRE( registered != versions.mapping.end() );
+  BOOST_CHECK_EQUAL( registered->second, 7u );
+
+  VersionStructCached i_first{0, 0, 0};
+  VersionStructCached i_repeated{0, 0, 0};
+  VersionStructCached i_next{0, 0, 0};
+  {
+    std::istringstream is(os.str());
+    IArchive iar(is);
+    iar( i_first );
+    iar( i_repeated );
+  }
+  {
+    std::istringstream is(os2.str());
+    IArchive iar(is);
+    iar( i_next );
+  }
+
+  BOOST_CHECK_EQUAL( i_first.x, o_first.x );
+  BOOST_CHECK_EQUAL( i_repeated.x, o_repeated.x );
+  BOOST_CHECK_EQUAL( i_next.x, o_next.x );
+  BOOST_CHECK_EQUAL( i_first.loadedVersion, 7u );
+  BOOST_CHECK_EQUAL( i_repeated.loadedVersion, 7u );
+  BOOST_CHECK_EQUAL( i_next.loadedVersion, 7u );
+}
+
+BOOST_AUTO_TEST_CASE( binary_versioning_cached )
+{
+  test_versioning_cached<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( portable_binary_versioning_cached )
+{
+  test_versioning_cached<cereal::PortableBinaryInputArchive, cereal::PortableBinaryOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( xml_versioning_cached )
+{
+  test_versioning_cached<cereal::XMLInputArchive, cereal::XMLOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( json_versioning_cached )
+{
+  test_versioning_cached<cereal::JSONInputArchive, cereal::JSONOutputArchive>();
+}
+
+BOOST_AUTO_TEST_CASE( extendable_binary_versioning_cached )
+{
+  test_versioning_cached<cereal::ExtendableBinaryInputArchive, cereal::ExtendableBinaryOutputArchive>();
+}
+
 #if CEREAL_THREAD_SAFE
 template <class IArchive, class OArchive>
 void test_versioning_threading()
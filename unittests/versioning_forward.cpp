@@ -250,7 +250,7 @@ BOOST_AUTO_TEST_CASE( extendable_binary_forward_support )
 }
 
 template <class IArchive, class OArchive, class NewType>
-void test_forward_support_extended()
+void test_forward_support_extended(typename OArchive::Options const & oOptions = typename OArchive::Options())
 {
   std::random_device rd;
   std::mt19937 gen(rd());
@@ -262,7 +262,7 @@ void test_forward_support_extended()
 
     std::ostringstream os;
     {
-      OArchive oar(os);
+      OArchive oar(os, oOptions);
       oar( o_struct );
     }
 
@@ -325,6 +325,17 @@ BOOST_AUTO_TEST_CASE( extendable_binary_forward_support_extended )
   test_forward_support_extended<cereal::ExtendableBinaryInputArchive, cereal::ExtendableBinaryOutputArchive, SkippedEmptyStruct>();
 }
 
+BOOST_AUTO_TEST_CASE( extendable_binary_forward_support_length_prefixed )
+{
+  auto const options = cereal::ExtendableBinaryOutputArchive::Options().lengthPrefixedObjects(true);
+  test_forward_support_extended<cereal::ExtendableBinaryInputArchive, cereal::ExtendableBinaryOutputArchive, int>(options);
+  test_forward_support_extended<cereal::ExtendableBinaryInputArchive, cereal::ExtendableBinaryOutputArchive, double>(options);
+  test_forward_support_extended<cereal::ExtendableBinaryInputArchive, cereal::ExtendableBinaryOutputArchive, std::string>(options);
+  test_forward_support_extended<cereal::ExtendableBinaryInputArchive, cereal::ExtendableBinaryOutputArchive, std::array<std::uint16_t, 4>>(options);
+  test_forward_support_extended<cereal::ExtendableBinaryInputArchive, cereal::ExtendableBinaryOutputArchive, SkippedStruct>(options);
+  test_forward_support_extended<cereal::ExtendableBinaryInputArchive, cereal::ExtendableBinaryOutputArchive, SkippedEmptyStruct>(options);
+}
+
 BOOST_AUTO_TEST_CASE( portable_binary_forward_support_extended )
 {
 //  test_forward_support_extended<cereal::PortableBinaryInputArchive, cereal::PortableBinaryOutputArchive, int>(); // fails
@@ -338,7 +338,8 @@ struct ANew {
   }
 };
 template <class IArchive, class OArchive>
-void test_omited_shared_out_of_order(typename IArchive::Options const & iOptions = typename IArchive::Options() )
+void test_omited_shared_out_of_order(typename IArchive::Options const & iOptions = typename IArchive::Options(),
+                                     typename OArchive::Options const & oOptions = typename OArchive::Options() )
 {
 
   std::random_device rd;
@@ -352,7 +353,7 @@ void test_omited_shared_out_of_order(typename IArchive::Options const & iOptions
 
     std::ostringstream os;
     {
-      OArchive oar(os);
+      OArchive oar(os, oOptions);
       oar( o_struct );
     }
 
@@ -384,6 +385,13 @@ BOOST_AUTO_TEST_CASE( extendable_binary_omited_shared_out_of_order )
   test_omited_shared_out_of_order<cereal::ExtendableBinaryInputArchive, cereal::ExtendableBinaryOutputArchive>();
 }
 
+BOOST_AUTO_TEST_CASE( extendable_binary_omited_shared_out_of_order_length_prefixed )
+{
+  test_omited_shared_out_of_order<cereal::ExtendableBinaryInputArchive, cereal::ExtendableBinaryOutputArchive>(
+      cereal::ExtendableBinaryInputArchive::Options(),
+      cereal::ExtendableBinaryOutputArchive::Options().lengthPrefixedObjects(true));
+}
+
 BOOST_AUTO_TEST_CASE(extendable_binary_omited_shared_out_of_order_limit_size)
 {
   auto funComma = []() {
@@ -847,3 +855,164 @@ BOOST_AUTO_TEST_CASE( extendable_binary_omited_shared_out_of_order_4 )
 {
   test_omited_shared_out_of_order_4<cereal::ExtendableBinaryInputArchive, cereal::ExtendableBinaryOutputArchive>();
 }
+
+struct Blob
+{
+  std::vector<std::uint8_t> data;
+
+  template<class Archive>
+  void serialize(Archive & ar, std::uint32_t)
+  {
+    ar(data);
+  }
+};
+
+/** old application - same blob saved twice */
+struct BlobPairOld
+{
+  std::shared_ptr<Blob> skipped;
+  std::shared_ptr<Blob> used;
+
+  template<class Archive>
+  void serialize(Archive & ar, std::uint32_t)
+  {
+    ar(skipped, used);
+  }
+};
+
+/** new application - first field is not used anymore */
+struct BlobPairNew
+{
+  std::shared_ptr<Blob> used;
+
+  template<class Archive>
+  void serialize(Archive & ar, std::uint32_t)
+  {
+    ar(cereal::OmittedFieldTag(), used);
+  }
+};
+
+template<class IArchive, class OArchive>
+void test_omited_shared_big_objects(bool memoryInput,
+                                    typename OArchive::Options const & oOptions = typename OArchive::Options())
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  // every blob is bigger than chunk of skipped data buffer
+  std::vector<BlobPairOld> o_pairs(8);
+  for (auto & pair : o_pairs) {
+    pair.skipped = std::make_shared<Blob>();
+    for (int ii = 0; ii < 40000; ++ii)
+      pair.skipped->data.push_back(random_value<std::uint8_t>(gen));
+    pair.used = pair.skipped;
+  }
+
+  std::ostringstream os;
+  {
+    OArchive oar(os, oOptions);
+    oar(o_pairs);
+  }
+
+  /* Copied data of blob is released when blob is loaded,
+   * whole archive wouldn't fit into the limit. */
+  auto options = typename IArchive::Options().maxSharedBufferSize(100000);
+  std::vector<BlobPairNew> i_pairs;
+  std::size_t peakShared;
+  std::size_t skipped;
+  const std::string data = os.str();
+  if (memoryInput) {
+    IArchive iar(data.data(), data.size(), options);
+    iar(i_pairs);
+    peakShared = iar.peakSharedBufferSize();
+    skipped = iar.skippedDataSize();
+  } else {
+    std::istringstream is(data);
+    IArchive iar(is, options);
+    iar(i_pairs);
+    peakShared = iar.peakSharedBufferSize();
+    skipped = iar.skippedDataSize();
+  }
+
+  // at least one blob was kept, never more than the limit
+  BOOST_CHECK_GE(peakShared, o_pairs.front().skipped->data.size());
+  BOOST_CHECK_LE(peakShared, 100000u);
+  // every blob was skipped once, fields of pairs are not counted
+  BOOST_CHECK_GE(skipped, o_pairs.size() * o_pairs.front().skipped->data.size());
+  BOOST_CHECK_LT(skipped, data.size());
+
+  BOOST_REQUIRE_EQUAL(i_pairs.size(), o_pairs.size());
+  for (std::size_t ii = 0; ii < i_pairs.size(); ++ii) {
+    BOOST_REQUIRE(i_pairs[ii].used != nullptr);
+    BOOST_CHECK(i_pairs[ii].used->data == o_pairs[ii].used->data);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( extendable_binary_omited_shared_big_objects )
+{
+  test_omited_shared_big_objects<cereal::ExtendableBinaryInputArchive, cereal::ExtendableBinaryOutputArchive>(false);
+  test_omited_shared_big_objects<cereal::ExtendableBinaryInputArchive, cereal::ExtendableBinaryOutputArchive>(true);
+
+  // skipped blobs are copied at once
+  auto const lengthPrefixed = cereal::ExtendableBinaryOutputArchive::Options().lengthPrefixedObjects(true);
+  test_omited_shared_big_objects<cereal::ExtendableBinaryInputArchive, cereal::ExtendableBinaryOutputArchive>(false, lengthPrefixed);
+  test_omited_shared_big_objects<cereal::ExtendableBinaryInputArchive, cereal::ExtendableBinaryOutputArchive>(true, lengthPrefixed);
+}
+
+template<class IArchive, class OArchive>
+void test_omited_shared_small_objects(bool memoryInput, std::size_t blobSize)
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  // many blobs fit in chunk of skipped data buffer, together they are bigger than the limit
+  std::vector<BlobPairOld> o_pairs(2000);
+  for (auto & pair : o_pairs) {
+    pair.skipped = std::make_shared<Blob>();
+    for (std::size_t ii = 0; ii < blobSize; ++ii)
+      pair.skipped->data.push_back(random_value<std::uint8_t>(gen));
+    pair.used = pair.skipped;
+  }
+
+  std::ostringstream os;
+  {
+    OArchive oar(os);
+    oar(o_pairs);
+  }
+
+  /* Blobs are released while their chunk is still appended to,
+   * such chunks are freed when buffer grows past them. */
+  const std::size_t limit = 100000;
+  auto options = typename IArchive::Options().maxSharedBufferSize(limit);
+  std::vector<BlobPairNew> i_pairs;
+  std::size_t peakShared;
+  const std::string data = os.str();
+  BOOST_REQUIRE_GT(data.size(), 2 * limit);
+  if (memoryInput) {
+    IArchive iar(data.data(), data.size(), options);
+    iar(i_pairs);
+    peakShared = iar.peakSharedBufferSize();
+  } else {
+    std::istringstream is(data);
+    IArchive iar(is, options);
+    iar(i_pairs);
+    peakShared = iar.peakSharedBufferSize();
+  }
+
+  BOOST_CHECK_LE(peakShared, limit / 2);
+
+  BOOST_REQUIRE_EQUAL(i_pairs.size(), o_pairs.size());
+  for (std::size_t ii = 0; ii < i_pairs.size(); ++ii) {
+    BOOST_REQUIRE(i_pairs[ii].used != nullptr);
+    BOOST_CHECK(i_pairs[ii].used->data == o_pairs[ii].used->data);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( extendable_binary_omited_shared_small_objects )
+{
+  // some sizes make objects end exactly at the end of chunk
+  for (std::size_t blobSize = 96; blobSize <= 160; ++blobSize) {
+    test_omited_shared_small_objects<cereal::ExtendableBinaryInputArchive, cereal::ExtendableBinaryOutputArchive>(false, blobSize);
+    test_omited_shared_small_objects<cereal::ExtendableBinaryInputArchive, cereal::ExtendableBinaryOutputArchive>(true, blobSize);
+  }
+}